@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "ActionManager.h"
+#include "InputManager.h"
+#include <SDL\SDL.h>
+
+////////////////////////////////////////////////////////////
+// Static Variables
+////////////////////////////////////////////////////////////
+ActionManager ActionManager::_Instance;
+
+////////////////////////////////////////////////////////////
+ActionManager::ActionManager()
+{
+	for (int i = 0; i < ACTION_COUNT; i++) {
+		_Held[i] = false;
+		_Pressed[i] = false;
+		_Released[i] = false;
+		_Value[i] = 0.0f;
+	}
+}
+
+////////////////////////////////////////////////////////////
+ActionManager::~ActionManager() {}
+
+////////////////////////////////////////////////////////////
+void ActionManager::Initialize()
+{
+	for (int i = 0; i < ACTION_COUNT; i++) {
+		_Bindings[i].clear();
+	}
+	Bind(ACTION_STEER_LEFT, SDLK_LEFT);
+	Bind(ACTION_STEER_RIGHT, SDLK_RIGHT);
+	Bind(ACTION_ACCELERATE, SDLK_UP);
+	Bind(ACTION_BRAKE, SDLK_DOWN);
+	Bind(ACTION_PAUSE, SDLK_ESCAPE);
+	Bind(ACTION_RESET_VEHICLE, SDLK_BACKSPACE);
+	Bind(ACTION_TOGGLE_WIREFRAME, SDLK_F8);
+	Bind(ACTION_TOGGLE_STATS, SDLK_F3);
+	Bind(ACTION_TOGGLE_DEPTH_PREPASS, SDLK_F4);
+	Bind(ACTION_TOGGLE_PROFILER, SDLK_F5);
+}
+
+////////////////////////////////////////////////////////////
+void ActionManager::Update()
+{
+	const std::vector<KeyEvent>& events = InputManager::Instance()->GetFrameKeyEvents();
+
+	for (int a = 0; a < ACTION_COUNT; a++) {
+		//how many of the bound keys were down when the frame started.
+		int down = 0;
+		for (int key : _Bindings[a]) {
+			down += InputManager::Instance()->WasKeyHeld(key) ? 1 : 0;
+		}
+		_Pressed[a] = false;
+		_Released[a] = false;
+
+		//walk the events in order adding up the time the action was held.
+		float active = 0.0f;
+		float last = 0.0f;
+		for (const KeyEvent& e : events) {
+			bool bound = false;
+			for (int key : _Bindings[a]) {
+				bound |= (key == e.Keycode);
+			}
+			if (!bound) {
+				continue;
+			}
+			if (down > 0) {
+				active += e.FrameTime - last;
+			}
+			last = e.FrameTime;
+
+			if (e.State == SDL_PRESSED) {
+				_Pressed[a] |= (down == 0);
+				down++;
+			}
+			else if (down > 0) {
+				down--;
+				_Released[a] |= (down == 0);
+			}
+		}
+		if (down > 0) {
+			active += 1.0f - last;
+		}
+
+		_Held[a] = down > 0;
+		_Value[a] = active;
+	}
+}
+
+////////////////////////////////////////////////////////////
+void ActionManager::Bind(Action ActionID, int Key)
+{
+	_Bindings[ActionID].push_back(Key);
+}
+
+////////////////////////////////////////////////////////////
+void ActionManager::Unbind(Action ActionID)
+{
+	_Bindings[ActionID].clear();
+}
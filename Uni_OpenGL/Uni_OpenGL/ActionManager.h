@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////
+//
+// Action Manager
+//
+////////////////////////////////////////////////////////////
+#ifndef ACTION_MANAGER_H
+#define ACTION_MANAGER_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// Game actions that keys can be bound to.
+////////////////////////////////////////////////////////////
+enum Action {
+	ACTION_STEER_LEFT = 0,
+	ACTION_STEER_RIGHT,
+	ACTION_ACCELERATE,
+	ACTION_BRAKE,
+	ACTION_PAUSE,
+	ACTION_RESET_VEHICLE,
+	ACTION_TOGGLE_WIREFRAME,
+	ACTION_TOGGLE_STATS,
+	ACTION_TOGGLE_DEPTH_PREPASS,
+	ACTION_TOGGLE_PROFILER,
+	ACTION_COUNT
+};
+
+////////////////////////////////////////////////////////////
+/// Maps keys to game actions.
+/// --Reads the timestamped key events the InputManager
+/// --collected over the frame, so a press and release that
+/// --both happen inside one frame still count, and each
+/// --action knows how much of the frame it was held for.
+////////////////////////////////////////////////////////////
+class ActionManager
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// Sets up the default key bindings.
+	////////////////////////////////////////////////////////////
+	void Initialize();
+
+	////////////////////////////////////////////////////////////
+	/// Updates every action from this frames key events.
+	/// Called by the InputManager at the end of its update.
+	////////////////////////////////////////////////////////////
+	void Update();
+
+	////////////////////////////////////////////////////////////
+	/// Adds a key to an action, an action can have many keys.
+	/// --ActionID-- The action to bind to.
+	/// --Key-- The SDL keycode.
+	////////////////////////////////////////////////////////////
+	void Bind(Action ActionID, int Key);
+
+	////////////////////////////////////////////////////////////
+	/// Removes all keys from an action.
+	/// --ActionID-- The action to clear.
+	////////////////////////////////////////////////////////////
+	void Unbind(Action ActionID);
+
+	////////////////////////////////////////////////////////////
+	/// Checks to see if an action is held at the end of the frame.
+	////////////////////////////////////////////////////////////
+	bool IsActionHeld(Action ActionID) const { return _Held[ActionID]; }
+
+	////////////////////////////////////////////////////////////
+	/// Checks to see if an action started at any point this frame.
+	////////////////////////////////////////////////////////////
+	bool IsActionPressed(Action ActionID) const { return _Pressed[ActionID]; }
+
+	////////////////////////////////////////////////////////////
+	/// Checks to see if an action stopped at any point this frame.
+	////////////////////////////////////////////////////////////
+	bool IsActionReleased(Action ActionID) const { return _Released[ActionID]; }
+
+	////////////////////////////////////////////////////////////
+	/// Gets how much of the frame the action was held for,
+	/// 0 to 1. A quick tap at a low framerate gives a small
+	/// value rather than a full frame of input.
+	////////////////////////////////////////////////////////////
+	float GetActionValue(Action ActionID) const { return _Value[ActionID]; }
+
+	////////////////////////////////////////////////////////////
+	/// Provides access to the only instance of the action
+	/// manager.
+	////////////////////////////////////////////////////////////
+	static ActionManager* Instance() {
+		return &_Instance;
+	};
+
+private:
+	ActionManager();
+	~ActionManager();
+	ActionManager(const ActionManager&) {}
+
+	////////////////////////////////////////////////////////////
+	// Member Data
+	////////////////////////////////////////////////////////////
+	static ActionManager _Instance; // Static Instance of ActionManager
+
+	std::vector<int> _Bindings[ACTION_COUNT];	// Keycodes bound to each action.
+
+	bool _Held[ACTION_COUNT];		// Action held at the end of the frame.
+	bool _Pressed[ACTION_COUNT];	// Action started this frame.
+	bool _Released[ACTION_COUNT];	// Action stopped this frame.
+	float _Value[ACTION_COUNT];		// Fraction of the frame the action was held.
+};
+
+#endif
@@ -13,14 +13,14 @@ public:
 	{
 		_Shader = ShaderName;
 		_AxisLength = length;
-		xPos = new Cuboid(_AxisLength, 0.05, 0.05, _Shader, glm::vec3(1.0, 0.0, 0.0));
-		xNeg = new Cuboid(_AxisLength, 0.05, 0.05, _Shader, glm::vec3(0.5, 0.0, 0.0));
+		xPos = new Cuboid(_AxisLength, 0.05, 0.05, ShaderName, glm::vec3(1.0, 0.0, 0.0));
+		xNeg = new Cuboid(_AxisLength, 0.05, 0.05, ShaderName, glm::vec3(0.5, 0.0, 0.0));
 
-		yPos = new Cuboid(0.05, _AxisLength, 0.05, _Shader, glm::vec3(0.0, 1.0, 0.0));
-		yNeg = new Cuboid(0.05, _AxisLength, 0.05, _Shader, glm::vec3(0.0, 0.5, 0.0));
+		yPos = new Cuboid(0.05, _AxisLength, 0.05, ShaderName, glm::vec3(0.0, 1.0, 0.0));
+		yNeg = new Cuboid(0.05, _AxisLength, 0.05, ShaderName, glm::vec3(0.0, 0.5, 0.0));
 
-		zPos = new Cuboid(0.05, 0.05, _AxisLength, _Shader, glm::vec3(0.0, 0.0, 1.0));
-		zNeg = new Cuboid(0.05, 0.05, _AxisLength, _Shader, glm::vec3(0.0, 0.0, 0.5));
+		zPos = new Cuboid(0.05, 0.05, _AxisLength, ShaderName, glm::vec3(0.0, 0.0, 1.0));
+		zNeg = new Cuboid(0.05, 0.05, _AxisLength, ShaderName, glm::vec3(0.0, 0.0, 0.5));
 	}
 
 	~Axis()
@@ -35,34 +35,35 @@ public:
 
 	void Render()
 	{
+		Shader* shader = ShaderManager::Instance()->BindShader(_Shader);
 		glm::mat4 model;
 		model = glm::translate(model, glm::vec3(_AxisLength / 2, 0.0, 0.0));
-		ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+		shader->SetMat4("model", model);
 		xPos->Render();
 
 		model = glm::mat4();
 		model = glm::translate(model, glm::vec3(-_AxisLength / 2, 0.0, 0.0));
-		ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+		shader->SetMat4("model", model);
 		xNeg->Render();
 
 		model = glm::mat4();
 		model = glm::translate(model, glm::vec3(0.0, _AxisLength / 2, 0.0));
-		ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+		shader->SetMat4("model", model);
 		yPos->Render();
 
 		model = glm::mat4();
 		model = glm::translate(model, glm::vec3(0.0, -_AxisLength / 2, 0.0));
-		ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+		shader->SetMat4("model", model);
 		yNeg->Render();
 
 		model = glm::mat4();
 		model = glm::translate(model, glm::vec3(0.0, 0.0, _AxisLength / 2));
-		ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+		shader->SetMat4("model", model);
 		zPos->Render();
 
 		model = glm::mat4();
 		model = glm::translate(model, glm::vec3(0.0, 0.0, -_AxisLength / 2));
-		ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+		shader->SetMat4("model", model);
 		zNeg->Render();
 	}
 
@@ -70,7 +71,7 @@ private:
 	Cuboid* xPos;	Cuboid* xNeg;
 	Cuboid* yPos;	Cuboid* yNeg;
 	Cuboid* zPos;	Cuboid* zNeg;
-	std::string _Shader;
+	ShaderID _Shader;
 	float _AxisLength;
 
 };
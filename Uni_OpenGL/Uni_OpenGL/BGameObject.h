@@ -9,7 +9,10 @@
 #include <BULLET\btBulletDynamicsCommon.h>
 
 #include "Model.h"
+#include "RenderQueue.h"
+#include "Shaders\Shader.h"
 #include "OpenGLMotionState.h"
+#include "CollisionGroups.h"
 
 #include "MathUtil.h"
 
@@ -37,6 +40,58 @@ public:
     virtual void Update(float delta) = 0;
     virtual void Render(std::string shader = "") = 0;
 
+    //the model drawn for this object, if it has one.
+    virtual Model* GetModel() { return nullptr; }
+
+    //world space bounds for culling. objects with a model use its bounds,
+    //anything else falls back to the physics aabb.
+    void GetWorldSphere(glm::vec3& center, float& radius) {
+        Model* model = GetModel();
+        if (model == nullptr) {
+            glm::vec3 extents;
+            GetWorldBox(center, extents);
+            radius = glm::length(extents);
+            return;
+        }
+        glm::mat4 world = GetModelMatrix();
+        center = glm::vec3(world * glm::vec4(model->GetBoundsCenter(), 1.0f));
+        //scale the radius by the largest axis scale.
+        float scale = glm::max(glm::length(glm::vec3(world[0])), glm::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+        radius = model->GetBoundsRadius() * scale;
+    }
+
+    void GetWorldBox(glm::vec3& center, glm::vec3& extents) {
+        Model* model = GetModel();
+        if (model == nullptr) {
+            btVector3 min, max;
+            _ObjectBody->getAabb(min, max);
+            center = bulletVecToGLM((min + max) * 0.5f);
+            extents = bulletVecToGLM((max - min) * 0.5f);
+            return;
+        }
+        //rotated box extents are the local extents run through the absolute rotation.
+        glm::mat4 world = GetModelMatrix();
+        glm::vec3 localExtents = model->GetBoundsExtents();
+        center = glm::vec3(world * glm::vec4(model->GetBoundsCenter(), 1.0f));
+        for (int i = 0; i < 3; i++) {
+            extents[i] = glm::abs(world[0][i]) * localExtents.x + glm::abs(world[1][i]) * localExtents.y + glm::abs(world[2][i]) * localExtents.z;
+        }
+    }
+
+    //draws positions only into the shadow map, the depth shader must already be bound.
+    void RenderDepth(Shader* shader) {
+        Model* model = GetModel();
+        if (model != nullptr) {
+            shader->SetMat4("model", GetModelMatrix());
+            model->RenderDepth();
+        }
+    }
+
+    //queues the object for drawing. objects without a model draw themselves through Render.
+    virtual void Submit(RenderQueue* queue) {
+        queue->Submit([this]() { Render(); }, GetModelMatrix(), _Shader, PASS_OPAQUE);
+    }
+
     virtual void Initialize(btDynamicsWorld* world, std::set<btCollisionShape*>* collisionShapes) {
         //create the motion state
         _MotionState = new OpenGLMotionState(_Transform);
@@ -52,7 +107,7 @@ public:
         _ObjectBody = new btRigidBody(bodyInfo);
 
 		collisionShapes->emplace(_ObjectShape);
-        world->addRigidBody(_ObjectBody);
+        AddBodyToWorld(world);
     }
 
 	btCollisionShape* GetShape() { return _ObjectShape; }
@@ -126,6 +181,19 @@ public:
         _Scale = scale;
     }
 
+    //sets which broadphase group the body is in and what groups it can collide with.
+    //must be called before the object is added to the simulation.
+    void SetCollisionFilter(short group, short mask) {
+        _CollisionGroup = group;
+        _CollisionMask = mask;
+    }
+
+    //puts the body to sleep so it is skipped by the solver and its aabb is not
+    //recalculated until something wakes it up.
+    void Sleep() {
+        _ObjectBody->setActivationState(ISLAND_SLEEPING);
+    }
+
     void SetActivationState(bool alwaysActive = false) {
         if (alwaysActive) {
             _ObjectBody->setActivationState(DISABLE_DEACTIVATION);
@@ -136,6 +204,16 @@ public:
     }
 
 protected:
+    void AddBodyToWorld(btDynamicsWorld* world) {
+        //bodies without a filter fall back to bullets own static/dynamic split
+        if (_CollisionGroup != COL_NONE) {
+            world->addRigidBody(_ObjectBody, _CollisionGroup, _CollisionMask);
+        }
+        else {
+            world->addRigidBody(_ObjectBody);
+        }
+    }
+
 	btCollisionShape*	_ObjectShape;
 	btRigidBody*		_ObjectBody;
 	OpenGLMotionState*	_MotionState;
@@ -144,5 +222,8 @@ protected:
 
     float _Mass;
 
+    short _CollisionGroup = COL_NONE;
+    short _CollisionMask = COL_ALL;
+
     std::string _Shader;
 };
\ No newline at end of file
@@ -29,6 +29,11 @@ void BModel::Render(std::string shader)
     _Model->Render(shader);
 }
 
+void BModel::Submit(RenderQueue* queue)
+{
+    queue->Submit(_Model, GetModelMatrix(), _Shader);
+}
+
 void BModel::Scale(glm::vec3 scale)
 {
     BGameObject::Scale(scale);
@@ -15,6 +15,8 @@ public:
     virtual void Input() override;
     virtual void Update(float delta) override;
     virtual void Render(std::string shader = "") override;
+    virtual void Submit(RenderQueue* queue) override;
+    virtual Model* GetModel() override { return _Model; }
 
     void Scale(glm::vec3 scale);
 
@@ -6,6 +6,8 @@
 BTriggerVolume::BTriggerVolume(glm::vec3 position, glm::vec3 rotation, btCollisionShape* shape, std::string shader) :
 	BGameObject(position, rotation, 0.0f, shape, shader)
 {
+	//triggers only need to know about vehicles passing through them
+	SetCollisionFilter(COL_TRIGGER, COL_MASK_TRIGGER);
 }
 
 
@@ -31,7 +33,7 @@ void BTriggerVolume::Initialize(btDynamicsWorld * world, std::set<btCollisionSha
 	_ObjectBody->setCollisionFlags(btCollisionObject::CF_NO_CONTACT_RESPONSE);
 
 	collisionShapes->emplace(_ObjectShape);
-	world->addRigidBody(_ObjectBody);
+	AddBodyToWorld(world);
 }
 
 void BTriggerVolume::SetTrackDirecion(glm::vec3 direction)
@@ -29,6 +29,8 @@ private:
 	virtual void Input() override;
 	virtual void Update(float delta) override;
 	virtual void Render(std::string shader = "") override;
+	//trigger volumes are never drawn.
+	virtual void Submit(RenderQueue* queue) override {}
 
 	glm::vec3 _DirectionOfTrack;
 	float _AngleFromZ;
@@ -1,7 +1,5 @@
 #include "BVehicle.h"
 #include "RigidBodyFromOBJ.h"
-#include <SDL/sdl.h>
-#include "InputManager.h"
 #include "PhysicsManager.h"
 
 #include <iostream>
@@ -10,6 +8,7 @@ BVehicle::BVehicle(glm::vec3 position, glm::vec3 rotation, float mass, Model* mo
     BGameObject(position, rotation, mass, new btBoxShape(btVector3(1.7272f, 1.2192f, 3.3528f) * 0.5f), shader)
 {
     _Model = model;
+    SetCollisionFilter(COL_VEHICLE, COL_MASK_VEHICLE);
 }
 
 BVehicle::~BVehicle()
@@ -43,9 +42,9 @@ void BVehicle::Initialize(btDynamicsWorld * world, std::set<btCollisionShape*>*
 
 	collisionShapes->emplace(compound);
 	collisionShapes->emplace(_ObjectShape);
-    world->addRigidBody(_ObjectBody);
+    AddBodyToWorld(world);
 
-    _VehicleRayCaster = new btDefaultVehicleRaycaster(world);
+    _VehicleRayCaster = PhysicsManager::Instance()->GetVehicleRaycaster()->AddVehicle(_ObjectBody);
     btRaycastVehicle::btVehicleTuning _VehicleTuning;
     _Vehicle = new btRaycastVehicle(_VehicleTuning, _ObjectBody, _VehicleRayCaster);
     _ObjectBody->setActivationState(DISABLE_DEACTIVATION);
@@ -100,81 +99,29 @@ void BVehicle::AddWheels(btVector3* halfSize, btRaycastVehicle * vehicle, btRayc
 
 void BVehicle::Input()
 {
-    if (InputManager::Instance()->IsKeyHeld(SDLK_LEFT)) {
-        _Steering += 0.03f;
-        if (_Steering > _MaxSteering) {
-            _Steering = _MaxSteering;
-        }
-    }
-    if (InputManager::Instance()->IsKeyHeld(SDLK_RIGHT)) {
-        _Steering -= 0.03f;
-        if (_Steering < -_MaxSteering) {
-            _Steering = -_MaxSteering;
-        }
-    }
-
-    if (!InputManager::Instance()->IsKeyHeld(SDLK_LEFT) && !InputManager::Instance()->IsKeyHeld(SDLK_RIGHT)) {
-        _Steering = 0.0f;
-    }
-
-    if (InputManager::Instance()->IsKeyHeld(SDLK_UP) && !InputManager::Instance()->IsKeyHeld(SDLK_DOWN)) {
-		if (GetCurrentSpeedKmHour() < _MaxSpeed) {
-			_EngineForce += _AccelerationRate;
-		}
-        if (_EngineForce > _MaxEngineForce) {
-            _EngineForce = _MaxEngineForce;
-        }
-        _BrakeForce = 0.0f;
-		_Reversing = false;
-    }
-
-	if(!InputManager::Instance()->IsKeyHeld(SDLK_UP) && !InputManager::Instance()->IsKeyHeld(SDLK_DOWN)) {
-		_EngineForce = 0.0f;
-		_BrakeForce = 1.0f;
-		_Reversing = false;
-	}
-
-    if (InputManager::Instance()->IsKeyHeld(SDLK_DOWN)) {
-		if (abs(_Vehicle->getCurrentSpeedKmHour()) <=1 &&  !_Reversing) {
-			_Reversing = true;
-		}
-		if (!_Reversing) {
-			_BrakeForce = _MaxBrakeForce;
-			if (_BrakeForce > _MaxBrakeForce) {
-				_BrakeForce = _MaxBrakeForce;
-			}
-			_EngineForce = 0.0f;
-		}
-		else{
-			_BrakeForce = 0.0f;
-			if (GetCurrentSpeedKmHour() < _MaxSpeed) {
-				_EngineForce -= _AccelerationRate;
-			}
-			if (_EngineForce < -_MaxReverseEngineForce) {
-				_EngineForce = -_MaxReverseEngineForce;
-			}
-		}
-    }
+    //controls come from the VehicleSystem, see ApplyControls.
 }
 
 void BVehicle::Update(float delta)
 {
-    _Vehicle->setSteeringValue(_Steering, 0);
-    _Vehicle->setSteeringValue(_Steering, 1);
+}
+
+void BVehicle::ApplyControls(float steering, float engineForce, float brakeForce)
+{
+    _Vehicle->setSteeringValue(steering, 0);
+    _Vehicle->setSteeringValue(steering, 1);
 
 	//testing better steering -- give better steering qwhen under power
 	//but otherwise makes the vehicle very unstable
-	//_Vehicle->setSteeringValue(-_Steering, 2);
-	//_Vehicle->setSteeringValue(-_Steering, 3);
-
-    _Vehicle->applyEngineForce(_EngineForce, 2);
-    _Vehicle->applyEngineForce(_EngineForce, 3);
-	_Vehicle->setBrake(_BrakeForce, 0);
-	_Vehicle->setBrake(_BrakeForce, 1);
-    _Vehicle->setBrake(_BrakeForce, 2);
-    _Vehicle->setBrake(_BrakeForce, 3);
-
-	//std::cout << "Car Speed Km/H: " << abs(_Vehicle->getCurrentSpeedKmHour()) << std::endl;
+	//_Vehicle->setSteeringValue(-steering, 2);
+	//_Vehicle->setSteeringValue(-steering, 3);
+
+    _Vehicle->applyEngineForce(engineForce, 2);
+    _Vehicle->applyEngineForce(engineForce, 3);
+	_Vehicle->setBrake(brakeForce, 0);
+	_Vehicle->setBrake(brakeForce, 1);
+    _Vehicle->setBrake(brakeForce, 2);
+    _Vehicle->setBrake(brakeForce, 3);
 }
 
 void BVehicle::Render(std::string shader)
@@ -182,6 +129,11 @@ void BVehicle::Render(std::string shader)
     _Model->Render(shader);
 }
 
+void BVehicle::Submit(RenderQueue* queue)
+{
+    queue->Submit(_Model, GetModelMatrix(), _Shader);
+}
+
 void BVehicle::Scale(glm::vec3 scale)
 {
     BGameObject::Scale(scale);
@@ -18,6 +18,11 @@ public:
     virtual void Input() override;
     virtual void Update(float delta) override;
     virtual void Render(std::string shader = "") override;
+    virtual void Submit(RenderQueue* queue) override;
+    virtual Model* GetModel() override { return _Model; }
+
+    //set by the VehicleSystem every step.
+    void ApplyControls(float steering, float engineForce, float brakeForce);
 
     void Scale(glm::vec3 scale);
 
@@ -27,21 +32,6 @@ private:
     btVehicleRaycaster * _VehicleRayCaster;
     btRaycastVehicle*   _Vehicle;
 
-    float _Steering = 0.0f;
-    float _SteeringIncrement = 0.03f;
-    float _MaxSteering = 0.3f;
-
-    float _EngineForce = 0.0f;
-    float _AccelerationRate = 200.0f;
-    float _MaxEngineForce = 3000.0f;
-	float _MaxReverseEngineForce = 1500.0f;
-	float _MaxSpeed = 180.0f;
-
-    float _BrakeForce = 0.0f;
-    float _MaxBrakeForce = 100.0f;
-
-	bool _Reversing = false;
-
     void AddWheels(btVector3* halfSize, btRaycastVehicle* vehicle, btRaycastVehicle::btVehicleTuning tuning);
 };
 
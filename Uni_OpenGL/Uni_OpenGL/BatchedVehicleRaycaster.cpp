@@ -0,0 +1,161 @@
+#include "BatchedVehicleRaycaster.h"
+#include "Terrain.h"
+#include "MathUtil.h"
+
+#include <algorithm>
+
+namespace {
+	//collects every broadphase proxy inside the query box.
+	struct CandidateCallback : public btBroadphaseAabbCallback {
+		std::vector<btCollisionObject*> _Objects;
+
+		virtual bool process(const btBroadphaseProxy* proxy) override {
+			_Objects.push_back(static_cast<btCollisionObject*>(proxy->m_clientObject));
+			return true;
+		}
+	};
+}
+
+BatchedVehicleRaycaster::BatchedVehicleRaycaster(btDynamicsWorld * world)
+{
+	_World = world;
+}
+
+BatchedVehicleRaycaster::~BatchedVehicleRaycaster()
+{
+	for (auto v : _Vehicles) {
+		delete v;
+	}
+	_Vehicles.clear();
+}
+
+btVehicleRaycaster * BatchedVehicleRaycaster::AddVehicle(btRigidBody * chassis)
+{
+	WheelRaycaster* raycaster = new WheelRaycaster(this, chassis);
+	_Vehicles.push_back(raycaster);
+	return raycaster;
+}
+
+void BatchedVehicleRaycaster::RemoveVehicle(btRigidBody * chassis)
+{
+	for (unsigned int i = 0; i < _Vehicles.size(); i++) {
+		if (_Vehicles[i]->_Chassis == chassis) {
+			delete _Vehicles[i];
+			_Vehicles.erase(_Vehicles.begin() + i);
+			return;
+		}
+	}
+}
+
+void BatchedVehicleRaycaster::PrepareStep()
+{
+	_Candidates.clear();
+	if (_Vehicles.empty()) {
+		return;
+	}
+
+	//grow each chassis box by how far the wheels can reach and join them all into one query box.
+	btVector3 reach(WHEEL_REACH, WHEEL_REACH, WHEEL_REACH);
+	btVector3 queryMin(BT_LARGE_FLOAT, BT_LARGE_FLOAT, BT_LARGE_FLOAT);
+	btVector3 queryMax(-BT_LARGE_FLOAT, -BT_LARGE_FLOAT, -BT_LARGE_FLOAT);
+	for (auto v : _Vehicles) {
+		v->_Chassis->getAabb(v->_AabbMin, v->_AabbMax);
+		v->_AabbMin -= reach;
+		v->_AabbMax += reach;
+		queryMin.setMin(v->_AabbMin);
+		queryMax.setMax(v->_AabbMax);
+		v->_Candidates.clear();
+	}
+
+	//the one broadphase traversal for this step.
+	CandidateCallback callback;
+	_World->getBroadphase()->aabbTest(queryMin, queryMax, callback);
+
+	btCollisionObject* terrainBody = _Terrain ? _Terrain->GetRigidBody() : nullptr;
+	for (auto object : callback._Objects) {
+		//triggers and the heightfield never go through the generic ray test.
+		if (object == terrainBody || !object->hasContactResponse()) {
+			continue;
+		}
+		Candidate candidate;
+		candidate._Object = object;
+		candidate._AabbMin = object->getBroadphaseHandle()->m_aabbMin;
+		candidate._AabbMax = object->getBroadphaseHandle()->m_aabbMax;
+
+		int index = (int)_Candidates.size();
+		_Candidates.push_back(candidate);
+
+		//bucket each candidate under the vehicles it is actually near, a car never hits its own chassis.
+		for (auto v : _Vehicles) {
+			if (object != v->_Chassis && TestAabbAgainstAabb2(v->_AabbMin, v->_AabbMax, candidate._AabbMin, candidate._AabbMax)) {
+				v->_Candidates.push_back(index);
+			}
+		}
+	}
+}
+
+void * BatchedVehicleRaycaster::CastRay(WheelRaycaster* vehicle, const btVector3 & from, const btVector3 & to, btVehicleRaycaster::btVehicleRaycasterResult & result)
+{
+	float closestFraction = 1.0f;
+	btVector3 hitNormal(0, 1, 0);
+	const btCollisionObject* hitObject = nullptr;
+
+	//heightfield fast path, only the couple of cells under the ray are tested.
+	if (_Terrain) {
+		float fraction;
+		glm::vec3 normal;
+		if (_Terrain->RayCast(bulletVecToGLM(from), bulletVecToGLM(to), fraction, normal) && fraction < closestFraction) {
+			closestFraction = fraction;
+			hitNormal = glmVecToBullet(normal);
+			hitObject = _Terrain->GetRigidBody();
+		}
+	}
+
+	if (!vehicle->_Candidates.empty()) {
+		btVector3 rayMin = from;
+		btVector3 rayMax = from;
+		rayMin.setMin(to);
+		rayMax.setMax(to);
+
+		btTransform rayFrom;
+		btTransform rayTo;
+		rayFrom.setIdentity();
+		rayFrom.setOrigin(from);
+		rayTo.setIdentity();
+		rayTo.setOrigin(to);
+
+		//the callback only accepts hits closer than the terrain hit, or closer than any earlier prop.
+		btCollisionWorld::ClosestRayResultCallback rayCallback(from, to);
+		rayCallback.m_closestHitFraction = closestFraction;
+
+		for (int index : vehicle->_Candidates) {
+			const Candidate& candidate = _Candidates[index];
+			if (!TestAabbAgainstAabb2(rayMin, rayMax, candidate._AabbMin, candidate._AabbMax)) {
+				continue;
+			}
+			btCollisionWorld::rayTestSingle(rayFrom, rayTo, candidate._Object, candidate._Object->getCollisionShape(),
+				candidate._Object->getWorldTransform(), rayCallback);
+		}
+
+		if (rayCallback.hasHit()) {
+			closestFraction = rayCallback.m_closestHitFraction;
+			hitNormal = rayCallback.m_hitNormalWorld;
+			hitObject = rayCallback.m_collisionObject;
+		}
+	}
+
+	const btRigidBody* body = btRigidBody::upcast(hitObject);
+	if (!body) {
+		return 0;
+	}
+
+	result.m_hitPointInWorld = from.lerp(to, closestFraction);
+	result.m_hitNormalInWorld = hitNormal.normalized();
+	result.m_distFraction = closestFraction;
+	return (void*)body;
+}
+
+void * BatchedVehicleRaycaster::WheelRaycaster::castRay(const btVector3 & from, const btVector3 & to, btVehicleRaycasterResult & result)
+{
+	return _Owner->CastRay(this, from, to, result);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <BULLET\btBulletCollisionCommon.h>
+#include <BULLET\btBulletDynamicsCommon.h>
+
+#include <vector>
+
+class Terrain;
+
+////////////////////////////////////////////////////////////
+/// Shared wheel raycaster for every vehicle in the world.
+/// --btDefaultVehicleRaycaster walks the whole broadphase
+/// --for each wheel. This does one broadphase query per
+/// --internal step around all the vehicles, then casts the
+/// --wheel rays against that short candidate list and the
+/// --terrain heightfield.
+////////////////////////////////////////////////////////////
+class BatchedVehicleRaycaster
+{
+public:
+	BatchedVehicleRaycaster(btDynamicsWorld* world);
+	~BatchedVehicleRaycaster();
+
+	////////////////////////////////////////////////////////////
+	/// Registers a vehicle chassis and returns the raycaster
+	/// --to hand to its btRaycastVehicle. Owned by this class.
+	////////////////////////////////////////////////////////////
+	btVehicleRaycaster* AddVehicle(btRigidBody* chassis);
+	void RemoveVehicle(btRigidBody* chassis);
+
+	////////////////////////////////////////////////////////////
+	/// Terrain rays are solved on the heightfield directly
+	/// --rather than through the triangle mesh bvh.
+	////////////////////////////////////////////////////////////
+	void SetTerrain(Terrain* terrain) { _Terrain = terrain; }
+
+	////////////////////////////////////////////////////////////
+	/// Gathers the candidate bodies for this step.
+	/// --Called from the physics pre tick callback.
+	////////////////////////////////////////////////////////////
+	void PrepareStep();
+
+	int GetCandidateCount() { return (int)_Candidates.size(); }
+
+private:
+	class WheelRaycaster : public btVehicleRaycaster
+	{
+	public:
+		WheelRaycaster(BatchedVehicleRaycaster* owner, btRigidBody* chassis) : _Owner(owner), _Chassis(chassis) {}
+
+		virtual void* castRay(const btVector3& from, const btVector3& to, btVehicleRaycasterResult& result) override;
+
+		BatchedVehicleRaycaster* _Owner;
+		btRigidBody* _Chassis;
+		btVector3 _AabbMin;
+		btVector3 _AabbMax;
+		std::vector<int> _Candidates;
+	};
+
+	struct Candidate {
+		btCollisionObject* _Object;
+		btVector3 _AabbMin;
+		btVector3 _AabbMax;
+	};
+
+	//how far past the chassis aabb a wheel ray can reach.
+	const float WHEEL_REACH = 2.0f;
+
+	btDynamicsWorld* _World;
+	Terrain* _Terrain = nullptr;
+
+	std::vector<WheelRaycaster*> _Vehicles;
+	std::vector<Candidate> _Candidates;
+
+	void* CastRay(WheelRaycaster* vehicle, const btVector3& from, const btVector3& to, btVehicleRaycaster::btVehicleRaycasterResult& result);
+};
@@ -1,5 +1,9 @@
 #include "Buffer.h"
 #include "LogManager.h"
+#include "RenderState.h"
+#include "StatsManager.h"
+
+#include <cstring>
 
 Buffer::Buffer() : _ID(0)
 {
@@ -27,26 +31,20 @@ void Buffer::Create(BufferType Type)
 void Buffer::Bind()
 {
 	if (_Type == VAO) {
-		glBindVertexArray(_ID);
-	}
-	else if (_Type == EBO){
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ID);
+		RenderState::Instance()->BindVertexArray(_ID);
 	}
 	else {
-		glBindBuffer(GL_ARRAY_BUFFER, _ID);
+		glBindBuffer(GetTarget(), _ID);
 	}
 }
 
 void Buffer::Unbind()
 {
 	if (_Type == VAO) {
-		glBindVertexArray(0);
-	}
-	else if (_Type == EBO) {
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		RenderState::Instance()->BindVertexArray(0);
 	}
 	else {
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GetTarget(), 0);
 	}
 }
 
@@ -54,14 +52,9 @@ void Buffer::Fill(int DataSize, const void * Data, DrawType Type)
 {
 	if (_Type != VAO) {
 		Bind();
-		if (_Type == EBO) {
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, DataSize, Data, Type);
-            _DataSize = DataSize;
-		}
-		else {
-			glBufferData(GL_ARRAY_BUFFER, DataSize, Data, Type);
-            _DataSize = DataSize;
-		}
+		STATS_ADD(STAT_BUFFER_BYTES, DataSize);
+		glBufferData(GetTarget(), DataSize, Data, Type);
+		_DataSize = DataSize;
 	}
 	else {
 		LogManager::Instance()->LogWarning("You cant fill a Vertex Array Object With Data!...");
@@ -72,6 +65,7 @@ void Buffer::AddTo(int DataSize, const void * Data, DrawType type)
 {
     if (_Type != VAO) {
         Bind();
+        STATS_ADD(STAT_BUFFER_BYTES, DataSize);
         if (_Type == EBO) {
             if (_DataSize == 0) {
                 //glBufferData(GL_ELEMENT_ARRAY_BUFFER, DataSize, 0, type);
@@ -102,10 +96,104 @@ void Buffer::Destroy()
 {
 	if (_Type == VAO) {
 		glDeleteVertexArrays(1, &_ID);
+		//gl can hand the name out again so drop the cached binding.
+		RenderState::Instance()->Invalidate();
 	}
 	else {
+		//deleting the buffer unmaps it too.
 		glDeleteBuffers(1, &_ID);
+		for (int i = 0; i < RING_SEGMENTS; i++) {
+			if (_Fences[i] != nullptr) {
+				glDeleteSync(_Fences[i]);
+				_Fences[i] = nullptr;
+			}
+		}
+		_Mapped = nullptr;
+		_SegmentSize = 0;
+	}
+}
+
+void Buffer::CreateRing(BufferType Type, int SegmentSize)
+{
+	Create(Type);
+	Bind();
+	_SegmentSize = SegmentSize;
+	_Segment = 0;
+	_Head = 0;
+	int size = SegmentSize * RING_SEGMENTS;
+	if (GLEW_ARB_buffer_storage) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GetTarget(), size, nullptr, flags);
+		_Mapped = (char*)glMapBufferRange(GetTarget(), 0, size, flags);
+	}
+	if (_Mapped == nullptr) {
+		glBufferData(GetTarget(), size, nullptr, GL_STREAM_DRAW);
+	}
+}
+
+void* Buffer::MapRing(int DataSize, int Alignment, int& Offset)
+{
+	if (DataSize + Alignment > _SegmentSize) {
+		return nullptr;
+	}
+	int start = (_Head + Alignment - 1) / Alignment * Alignment;
+	if (start + DataSize > (_Segment + 1) * _SegmentSize) {
+		//everything drawn from this segment has been sent, the fence passes once the gpu is done with it.
+		_Fences[_Segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		_Segment = (_Segment + 1) % RING_SEGMENTS;
+		WaitForSegment(_Segment);
+		start = (_Segment * _SegmentSize + Alignment - 1) / Alignment * Alignment;
+	}
+	_Head = start + DataSize;
+	Offset = start;
+	STATS_ADD(STAT_BUFFER_BYTES, DataSize);
+
+	if (_Mapped != nullptr) {
+		return _Mapped + start;
+	}
+	Bind();
+	_MapOpen = true;
+	return glMapBufferRange(GetTarget(), start, DataSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void Buffer::UnmapRing()
+{
+	//coherent persistent writes are seen by the next draw without anything else.
+	if (_MapOpen) {
+		Bind();
+		glUnmapBuffer(GetTarget());
+		_MapOpen = false;
+	}
+}
+
+int Buffer::Stream(int DataSize, const void* Data, int Alignment)
+{
+	int offset = -1;
+	void* memory = MapRing(DataSize, Alignment, offset);
+	if (memory == nullptr) {
+		return -1;
 	}
+	std::memcpy(memory, Data, DataSize);
+	UnmapRing();
+	return offset;
+}
+
+void Buffer::WaitForSegment(int Segment)
+{
+	GLsync fence = _Fences[Segment];
+	if (fence == nullptr) {
+		return;
+	}
+	//nearly always passed already, the other segments were written since it was placed.
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED) {
+		STATS_ADD(STAT_BUFFER_STALLS, 1);
+		do {
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(fence);
+	_Fences[Segment] = nullptr;
 }
 
 void Buffer::Reset()
@@ -113,6 +201,30 @@ void Buffer::Reset()
     _DataSize = 0;
 }
 
+void Buffer::BindBase(unsigned int BindingPoint)
+{
+	if (_Type == UBO) {
+		glBindBufferBase(GL_UNIFORM_BUFFER, BindingPoint, _ID);
+	}
+	else {
+		LogManager::Instance()->LogWarning("Only uniform buffers can be bound to a block binding point!...");
+	}
+}
+
+GLenum Buffer::GetTarget() const
+{
+	if (_Type == EBO) {
+		return GL_ELEMENT_ARRAY_BUFFER;
+	}
+	if (_Type == UBO) {
+		return GL_UNIFORM_BUFFER;
+	}
+	if (_Type == TBO) {
+		return GL_TEXTURE_BUFFER;
+	}
+	return GL_ARRAY_BUFFER;
+}
+
 void Buffer::AddAttribPointer(unsigned int ShaderID, const std::string & name, int size, VariableType Type, int stride, int offset) 
 {
 	if (_Type != VAO) {
@@ -125,6 +237,26 @@ void Buffer::AddAttribPointer(unsigned int ShaderID, const std::string & name, i
 	}
 }
 
+void Buffer::AddInstancedMatrixPointer(unsigned int ShaderID, const std::string & name, int stride, int offset)
+{
+	if (_Type != VAO) {
+		//a mat4 attribute takes four locations, one per column.
+		GLint AttribLoc = glGetAttribLocation(ShaderID, name.c_str());
+		if (AttribLoc < 0) {
+			LogManager::Instance()->LogWarning("Instanced attribute " + name + " not found in shader!...");
+			return;
+		}
+		for (int i = 0; i < 4; i++) {
+			glVertexAttribPointer(AttribLoc + i, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + i * 4 * sizeof(float)));
+			glEnableVertexAttribArray(AttribLoc + i);
+			glVertexAttribDivisor(AttribLoc + i, 1);
+		}
+	}
+	else {
+		LogManager::Instance()->LogWarning("You cant assign an attribute pointer to a Vertex Array Object!...");
+	}
+}
+
 unsigned int Buffer::GetID() const
 {
 	return _ID;
@@ -7,12 +7,15 @@
 enum BufferType {
 	VAO,
 	VBO,
-	EBO
+	EBO,
+	UBO,
+	TBO
 };
 
 enum DrawType {
 	STATIC = GL_STATIC_DRAW,
 	DYNAMIC = GL_DYNAMIC_DRAW,
+	STREAM = GL_STREAM_DRAW,
 };
 
 enum VariableType {
@@ -36,16 +39,46 @@ public:
     void AddTo(int DataSize, const void* Data, DrawType type);
 	void Destroy();
     void Reset();
+	//ties a uniform buffer to a block binding point, stays bound across Fill.
+	void BindBase(unsigned int BindingPoint);
+
+	//streaming ring for data rewritten every frame, in place of a Fill per draw. The storage is
+	//split into RING_SEGMENTS parts, each fenced when writing moves past it and only written again
+	//once the gpu has finished with it. Mapped persistently with ARB_buffer_storage, otherwise each
+	//write maps its range unsynchronized, the fences make that safe.
+	void CreateRing(BufferType Type, int SegmentSize);
+	//reserves DataSize bytes starting on a multiple of Alignment and returns where to write them,
+	//null if it is bigger than a segment. Draw from the reservation before mapping again.
+	//--Offset-- Byte offset of the reservation, divide by the stride for the first vertex.
+	void* MapRing(int DataSize, int Alignment, int& Offset);
+	void UnmapRing();
+	//copies Data into the ring, returns its byte offset or -1 if it does not fit.
+	int Stream(int DataSize, const void* Data, int Alignment);
+	int GetSegmentSize() const { return _SegmentSize; }
 
 	void AddAttribPointer(unsigned int ShaderID, const std::string & name, int size, VariableType Type, int stride = 0, int offset = 0);
+	//points a mat4 attribute at this buffer, advancing once per instance rather than per vertex.
+	void AddInstancedMatrixPointer(unsigned int ShaderID, const std::string & name, int stride = 16 * sizeof(float), int offset = 0);
 
 	unsigned int GetID() const;
 
 private:
+	GLenum GetTarget() const;
+
 	unsigned int _ID;
 	BufferType _Type;
 
     int _DataSize = 0;
+
+	static const int RING_SEGMENTS = 3;
+	int _SegmentSize = 0;
+	int _Segment = 0;
+	int _Head = 0;
+	char* _Mapped = nullptr;	// Persistent mapping, null without buffer storage.
+	bool _MapOpen = false;
+	GLsync _Fences[RING_SEGMENTS] = {};
+
+	void WaitForSegment(int Segment);
 };
 
 #endif
\ No newline at end of file
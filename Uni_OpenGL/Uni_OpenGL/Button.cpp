@@ -10,7 +10,7 @@ Button::Button(glm::vec2 position, glm::vec2 size, Texture* texture, std::string
 	_Shader = shader;
 	_Position = position;
 	_Size = size;
-	_ButtonBack = new Sprite(size, 1, 1, texture, _Shader);
+	_ButtonBack = new Sprite(size, 1, 1, texture, shader);
 	_ButtonBack->SetSpriteSheetLocation();
 }
 
@@ -25,11 +25,12 @@ void Button::Update(float delta)
 
 void Button::Render()
 {
-	ShaderManager::Instance()->GetShader(_Shader)->SetVec3("color", glm::vec3(1.0, 1.0, 1.0));
-	ShaderManager::Instance()->GetShader(_Shader)->SetBool("RenderingText", false);
+	Shader* shader = ShaderManager::Instance()->BindShader(_Shader);
+	shader->SetVec3("color", glm::vec3(1.0, 1.0, 1.0));
+	shader->SetBool("RenderingText", false);
 	glm::mat4 model(1.0f);
 	model = glm::translate(model, glm::vec3(_Position, 0));
-	ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+	shader->SetMat4("model", model);
 	_ButtonBack->Render();
 }
 
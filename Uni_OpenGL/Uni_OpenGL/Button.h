@@ -31,7 +31,7 @@ protected:
 	glm::vec3 _Color;
 	std::string _ButtonText;
 
-	std::string _Shader;
+	ShaderID _Shader;
 	glm::vec2 _Position;
 	glm::vec2 _Size;
 	Sprite * _ButtonBack;
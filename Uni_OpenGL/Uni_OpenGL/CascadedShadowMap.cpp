@@ -0,0 +1,139 @@
+#include "CascadedShadowMap.h"
+#include "ShaderManager.h"
+#include "RenderState.h"
+
+#include <GLEW\glew.h>
+#include <GLM\gtc\matrix_transform.hpp>
+#include <cmath>
+#include <string>
+
+CascadedShadowMap::CascadedShadowMap() :
+	_Resolution(0),
+	_CascadeCount(0)
+{
+	for (int i = 0; i < MAX_CASCADES; i++) {
+		_LightViewProjection[i] = glm::mat4(1.0f);
+		_SplitDepths[i] = 0.0f;
+	}
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+}
+
+void CascadedShadowMap::Create(int resolution, int cascadeCount)
+{
+	_Resolution = resolution;
+	_CascadeCount = glm::clamp(cascadeCount, 0, MAX_CASCADES);
+	if (_CascadeCount > 0) {
+		_Buffer.Create(_Resolution, _Resolution, _CascadeCount);
+	}
+}
+
+void CascadedShadowMap::Update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDirection)
+{
+	if (_CascadeCount == 0) {
+		return;
+	}
+
+	//near and far straight out of the perspective matrix.
+	float cameraNear = projection[3][2] / (projection[2][2] - 1.0f);
+	float cameraFar = projection[3][2] / (projection[2][2] + 1.0f);
+	float shadowFar = glm::min(cameraFar, MAX_SHADOW_DISTANCE);
+
+	//world space corners of the whole camera frustum.
+	glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+	glm::vec3 nearCorners[4];
+	glm::vec3 farCorners[4];
+	for (int i = 0; i < 4; i++) {
+		glm::vec2 ndc((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f);
+		glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+		nearCorners[i] = glm::vec3(nearPoint) / nearPoint.w;
+		farCorners[i] = glm::vec3(farPoint) / farPoint.w;
+	}
+
+	glm::vec3 direction = glm::normalize(lightDirection);
+	glm::vec3 up = (std::fabs(direction.y) > 0.99f) ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+
+	float sliceNear = cameraNear;
+	for (int c = 0; c < _CascadeCount; c++) {
+		//practical split scheme.
+		float p = (float)(c + 1) / (float)_CascadeCount;
+		float logSplit = cameraNear * std::pow(shadowFar / cameraNear, p);
+		float evenSplit = cameraNear + (shadowFar - cameraNear) * p;
+		float sliceFar = SPLIT_LAMBDA * logSplit + (1.0f - SPLIT_LAMBDA) * evenSplit;
+
+		//view depth changes linearly along the frustum edges, so the slice corners are a lerp.
+		float t0 = (sliceNear - cameraNear) / (cameraFar - cameraNear);
+		float t1 = (sliceFar - cameraNear) / (cameraFar - cameraNear);
+		glm::vec3 corners[8];
+		glm::vec3 center(0.0f);
+		for (int i = 0; i < 4; i++) {
+			corners[i] = glm::mix(nearCorners[i], farCorners[i], t0);
+			corners[i + 4] = glm::mix(nearCorners[i], farCorners[i], t1);
+			center += corners[i] + corners[i + 4];
+		}
+		center /= 8.0f;
+
+		//a sphere doesnt change size as the camera turns, which keeps the texel size steady.
+		float radius = 0.0f;
+		for (int i = 0; i < 8; i++) {
+			radius = glm::max(radius, glm::length(corners[i] - center));
+		}
+		radius = std::ceil(radius * 16.0f) / 16.0f;
+
+		glm::mat4 lightView = glm::lookAt(center - direction * (radius + CASTER_DISTANCE), center, up);
+		glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius + CASTER_DISTANCE);
+
+		//snap the origin to a whole texel so the shadows dont crawl as the camera moves.
+		glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		origin *= _Resolution * 0.5f;
+		glm::vec4 offset = (glm::round(origin) - origin) * (2.0f / _Resolution);
+		lightProjection[3][0] += offset.x;
+		lightProjection[3][1] += offset.y;
+
+		_LightViewProjection[c] = lightProjection * lightView;
+		_Frustums[c].Extract(_LightViewProjection[c]);
+		_SplitDepths[c] = sliceFar;
+		sliceNear = sliceFar;
+	}
+}
+
+void CascadedShadowMap::BeginCascade(int cascade)
+{
+	_Buffer.Bind(cascade);
+	_Buffer.Clear();
+	//slope scaled offset keeps lit surfaces from shadowing themselves.
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(2.0f, 4.0f);
+
+	ShaderManager::Instance()->BindShader(SHADER_ID("shadowInstanced"))->SetMat4("depthMVP", _LightViewProjection[cascade]);
+	ShaderManager::Instance()->BindShader(SHADER_ID("shadow"))->SetMat4("depthMVP", _LightViewProjection[cascade]);
+}
+
+void CascadedShadowMap::End()
+{
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	_Buffer.Unbind();
+}
+
+void CascadedShadowMap::SendToShader(Shader* shader)
+{
+	//the sampler always needs its own unit, even with shadows off, or it
+	//clashes with the sampler2Ds on unit 0.
+	shader->SetInt("shadowMap", SHADOW_TEXTURE_UNIT);
+	if (_CascadeCount == 0) {
+		return;
+	}
+	RenderState::Instance()->BindTexture(SHADOW_TEXTURE_UNIT, _Buffer.GetDepthMapID(), GL_TEXTURE_2D_ARRAY);
+}
+
+void CascadedShadowMap::Fill(LightsBlock& block) const
+{
+	block.CascadeCount = _CascadeCount;
+	for (int c = 0; c < _CascadeCount; c++) {
+		block.LightSpaceMatrices[c] = _LightViewProjection[c];
+		block.CascadeSplits[c] = _SplitDepths[c];
+	}
+}
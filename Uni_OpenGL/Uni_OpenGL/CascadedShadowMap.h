@@ -0,0 +1,81 @@
+#pragma once
+
+#include <GLM\glm.hpp>
+
+#include "ShadowMapBuffer.h"
+#include "Frustum.h"
+#include "FrameUniforms.h"
+
+class Shader;
+
+////////////////////////////////////////////////////////////
+/// Directional light shadows split into cascades.
+/// --The camera frustum is cut into slices along its depth,
+/// --closer slices covering less ground so they get more
+/// --shadow map texels per metre. Each slice gets its own
+/// --orthographic light camera fitted around it and its own
+/// --layer of a depth texture array.
+////////////////////////////////////////////////////////////
+class CascadedShadowMap
+{
+public:
+	static const int MAX_CASCADES = 4;
+
+	CascadedShadowMap();
+	~CascadedShadowMap();
+
+	////////////////////////////////////////////////////////////
+	/// Creates the depth array. A cascade count of 0 turns
+	/// --shadows off but lit shaders still get valid uniforms.
+	/// --Resolution-- Width and height of each cascade.
+	/// --CascadeCount-- Clamped to MAX_CASCADES.
+	////////////////////////////////////////////////////////////
+	void Create(int resolution, int cascadeCount);
+
+	////////////////////////////////////////////////////////////
+	/// Fits every cascade to its slice of the camera frustum.
+	////////////////////////////////////////////////////////////
+	void Update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& lightDirection);
+
+	////////////////////////////////////////////////////////////
+	/// Binds and clears a cascades layer and sets depthMVP on
+	/// --the depth programs. End restores the screen target.
+	////////////////////////////////////////////////////////////
+	void BeginCascade(int cascade);
+	void End();
+
+	////////////////////////////////////////////////////////////
+	/// Binds the shadow map and points the shadowMap sampler
+	/// --at it. Must be called for every program that declares
+	/// --the sampler.
+	////////////////////////////////////////////////////////////
+	void SendToShader(Shader* shader);
+
+	////////////////////////////////////////////////////////////
+	/// Writes the light matrices and split depths into the per
+	/// --frame lights block.
+	////////////////////////////////////////////////////////////
+	void Fill(LightsBlock& block) const;
+
+	//culls casters for a cascade, the near plane is pulled back towards the light.
+	const Frustum& GetCascadeFrustum(int cascade) { return _Frustums[cascade]; }
+	int GetCascadeCount() { return _CascadeCount; }
+
+private:
+	//texture unit kept free for the shadow map, past any material textures.
+	const int SHADOW_TEXTURE_UNIT = 8;
+	//shadows stop at this view depth even if the camera sees further.
+	const float MAX_SHADOW_DISTANCE = 250.0f;
+	//blend between logarithmic (1) and even (0) cascade splits.
+	const float SPLIT_LAMBDA = 0.75f;
+	//how far behind a cascade casters are still caught, for tall things between it and the sun.
+	const float CASTER_DISTANCE = 100.0f;
+
+	ShadowMapBuffer _Buffer;
+	int _Resolution;
+	int _CascadeCount;
+
+	glm::mat4 _LightViewProjection[MAX_CASCADES];
+	float _SplitDepths[MAX_CASCADES];
+	Frustum _Frustums[MAX_CASCADES];
+};
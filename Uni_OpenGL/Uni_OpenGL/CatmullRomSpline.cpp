@@ -2,6 +2,7 @@
 #include <math.h>
 
 #include "ShaderManager.h"
+#include "RenderState.h"
 
 //https://en.wikipedia.org/wiki/Centripetal_Catmull%E2%80%93Rom_spline
 
@@ -91,8 +92,8 @@ void CatmullRomSpline::AddToBuffer()
 	_VertexArray.Bind();
 	_VertexBuffer.Fill(sizeof(float) * points.size(), &points[0], STATIC);
 
-	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("basic")->GetID(), "aPos", 3, VT_FLOAT, 6 * sizeof(float));
-	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("basic")->GetID(), "aNormal", 3, VT_FLOAT, 6 * sizeof(float), 3 * sizeof(float));
+	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("basic"))->GetID(), "aPos", 3, VT_FLOAT, 6 * sizeof(float));
+	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("basic"))->GetID(), "aNormal", 3, VT_FLOAT, 6 * sizeof(float), 3 * sizeof(float));
 	_VertexArray.Unbind();
 }
 
@@ -113,17 +114,17 @@ void CatmullRomSpline::AddToBuffer2D()
 	_VertexArray.Bind();
 	_VertexBuffer.Fill(sizeof(float) * points.size(), &points[0], STATIC);
 
-	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("basic")->GetID(), "aPos", 3, VT_FLOAT, 6 * sizeof(float));
-	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("basic")->GetID(), "aNormal", 3, VT_FLOAT, 6 * sizeof(float), 3 * sizeof(float));
+	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("basic"))->GetID(), "aPos", 3, VT_FLOAT, 6 * sizeof(float));
+	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("basic"))->GetID(), "aNormal", 3, VT_FLOAT, 6 * sizeof(float), 3 * sizeof(float));
 	_VertexArray.Unbind();
 }
 
 void CatmullRomSpline::Render(std::string shader)
 {
 	glLineWidth(3.0f); //increase line width so its visible easier.
-	ShaderManager::Instance()->GetShader("basic")->SetVec3("aColor", glm::vec3(1.0, 0.0, 0.0));
+	ShaderManager::Instance()->BindShader(SHADER_ID("basic"))->SetVec3("aColor", glm::vec3(1.0, 0.0, 0.0));
 	_VertexArray.Bind();
-	glDrawArrays(GL_LINE_STRIP, 0, _SplinePoints.size());
+	RenderState::Instance()->DrawArrays(GL_LINE_STRIP, 0, _SplinePoints.size());
 	_VertexArray.Unbind();
 	glLineWidth(1.0f);
 }
@@ -0,0 +1,271 @@
+#include "ClusteredLights.h"
+#include "Light.h"
+#include "RenderState.h"
+#include "LogManager.h"
+#include "Profiler.h"
+#include "Shaders\Shader.h"
+
+#include <GLEW\glew.h>
+#include <algorithm>
+#include <cmath>
+
+ClusteredLights::ClusteredLights() :
+	_Grid(CLUSTER_COUNT, glm::uvec2(0)),
+	_SliceIndices(GRID_Z),
+	_Scale(0.0f),
+	_GridTexture(0),
+	_IndexTexture(0),
+	_LightTexture(0),
+	_Generation(0),
+	_Busy(0),
+	_Quit(false),
+	_NextSlice(0)
+{
+}
+
+ClusteredLights::~ClusteredLights()
+{
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+		_Quit = true;
+	}
+	_WorkReady.notify_all();
+	for (auto& worker : _Workers) {
+		worker.join();
+	}
+
+	if (_GridTexture != 0) {
+		glDeleteTextures(1, &_GridTexture);
+		glDeleteTextures(1, &_IndexTexture);
+		glDeleteTextures(1, &_LightTexture);
+		RenderState::Instance()->Invalidate();
+		_GridBuffer.Destroy();
+		_IndexBuffer.Destroy();
+		_LightBuffer.Destroy();
+	}
+}
+
+void ClusteredLights::Create()
+{
+	//a buffer needs storage before a texture can be pointed at it.
+	_GridBuffer.Create(TBO);
+	_GridBuffer.Fill(CLUSTER_COUNT * sizeof(glm::uvec2), _Grid.data(), STREAM);
+	_IndexBuffer.Create(TBO);
+	_IndexBuffer.Fill(sizeof(uint16_t), nullptr, STREAM);
+	_LightBuffer.Create(TBO);
+	_LightBuffer.Fill(sizeof(PointLightBlock), nullptr, STREAM);
+
+	glGenTextures(1, &_GridTexture);
+	RenderState::Instance()->BindTexture(GRID_TEXTURE_UNIT, _GridTexture, GL_TEXTURE_BUFFER);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, _GridBuffer.GetID());
+	glGenTextures(1, &_IndexTexture);
+	RenderState::Instance()->BindTexture(INDEX_TEXTURE_UNIT, _IndexTexture, GL_TEXTURE_BUFFER);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, _IndexBuffer.GetID());
+	glGenTextures(1, &_LightTexture);
+	RenderState::Instance()->BindTexture(LIGHT_TEXTURE_UNIT, _LightTexture, GL_TEXTURE_BUFFER);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, _LightBuffer.GetID());
+	_GridBuffer.Unbind();
+
+	unsigned int hardware = std::thread::hardware_concurrency();
+	unsigned int workers = std::min(hardware > 1 ? hardware - 1 : 0, MAX_WORKERS);
+	for (unsigned int i = 0; i < workers; i++) {
+		_Workers.push_back(std::thread(&ClusteredLights::WorkerLoop, this));
+	}
+	LogManager::Instance()->LogInfo("Clustered lights binning on " + std::to_string(workers + 1) + " threads.");
+}
+
+void ClusteredLights::Clear()
+{
+	_Lights.clear();
+}
+
+void ClusteredLights::Add(const PointLight& light)
+{
+	if ((int)_Lights.size() >= MAX_LIGHTS) {
+		return;
+	}
+	PointLightBlock block;
+	light.Fill(block);
+	block.Padding = light.GetRange();
+	_Lights.push_back(block);
+}
+
+void ClusteredLights::Build(const glm::mat4& view, const glm::mat4& projection, const glm::vec2& screenSize)
+{
+	PROFILE_SCOPE("ClusteredLights::Build");
+	//planes back out of a gl perspective matrix.
+	float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+	float farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+	float logRatio = std::log(farPlane / nearPlane);
+	_Scale.x = GRID_X / std::max(screenSize.x, 1.0f);
+	_Scale.y = GRID_Y / std::max(screenSize.y, 1.0f);
+	_Scale.z = GRID_Z / logRatio;
+	_Scale.w = -GRID_Z * std::log(nearPlane) / logRatio;
+
+	FindBounds(view, projection, nearPlane, farPlane);
+
+	//every thread takes the next slice until they run out, the main thread included.
+	_NextSlice.store(0);
+	{
+		std::lock_guard<std::mutex> lock(_Mutex);
+		_Generation++;
+		_Busy = (int)_Workers.size();
+	}
+	_WorkReady.notify_all();
+	BinSlices(_Counts);
+	{
+		std::unique_lock<std::mutex> lock(_Mutex);
+		_WorkDone.wait(lock, [this]() { return _Busy == 0; });
+	}
+
+	//join the slices, their offsets were relative to the slice.
+	_Indices.clear();
+	for (int s = 0; s < GRID_Z; s++) {
+		unsigned int base = (unsigned int)_Indices.size();
+		glm::uvec2* cells = &_Grid[s * GRID_X * GRID_Y];
+		for (int c = 0; c < GRID_X * GRID_Y; c++) {
+			cells[c].x += base;
+		}
+		_Indices.insert(_Indices.end(), _SliceIndices[s].begin(), _SliceIndices[s].end());
+	}
+
+	//filling the whole buffer orphans the old storage, so last frames draws are not waited on.
+	_GridBuffer.Fill(CLUSTER_COUNT * sizeof(glm::uvec2), _Grid.data(), STREAM);
+	_IndexBuffer.Fill((int)std::max<size_t>(_Indices.size(), 1) * sizeof(uint16_t), _Indices.empty() ? nullptr : _Indices.data(), STREAM);
+	_LightBuffer.Fill((int)std::max<size_t>(_Lights.size(), 1) * sizeof(PointLightBlock), _Lights.empty() ? nullptr : _Lights.data(), STREAM);
+	_LightBuffer.Unbind();
+}
+
+void ClusteredLights::SendToShader(Shader* shader)
+{
+	shader->SetInt("clusterGrid", GRID_TEXTURE_UNIT);
+	shader->SetInt("clusterLights", INDEX_TEXTURE_UNIT);
+	shader->SetInt("lightData", LIGHT_TEXTURE_UNIT);
+	RenderState::Instance()->BindTexture(GRID_TEXTURE_UNIT, _GridTexture, GL_TEXTURE_BUFFER);
+	RenderState::Instance()->BindTexture(INDEX_TEXTURE_UNIT, _IndexTexture, GL_TEXTURE_BUFFER);
+	RenderState::Instance()->BindTexture(LIGHT_TEXTURE_UNIT, _LightTexture, GL_TEXTURE_BUFFER);
+}
+
+void ClusteredLights::Fill(LightsBlock& block) const
+{
+	block.ClusterScale = _Scale;
+}
+
+void ClusteredLights::FindBounds(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane)
+{
+	_Bounds.resize(_Lights.size());
+	for (size_t i = 0; i < _Lights.size(); i++) {
+		LightBounds& bounds = _Bounds[i];
+		bounds.Slice0 = 1;
+		bounds.Slice1 = 0;
+
+		glm::vec3 center = glm::vec3(view * glm::vec4(_Lights[i].Position, 1.0f));
+		float range = _Lights[i].Padding;
+		float closest = -center.z - range;
+		float furthest = -center.z + range;
+		if (furthest < nearPlane || closest > farPlane) {
+			continue;
+		}
+
+		bounds.MinX = 0;
+		bounds.MaxX = GRID_X - 1;
+		bounds.MinY = 0;
+		bounds.MaxY = GRID_Y - 1;
+		//a range that crosses the near plane can cover any tile.
+		if (closest > nearPlane) {
+			//the corners of the box around the range are all in front, so their projection bounds it.
+			glm::vec2 low(1.0f);
+			glm::vec2 high(-1.0f);
+			for (int c = 0; c < 8; c++) {
+				glm::vec3 corner = center + glm::vec3(c & 1 ? range : -range, c & 2 ? range : -range, c & 4 ? range : -range);
+				glm::vec4 clip = projection * glm::vec4(corner, 1.0f);
+				glm::vec2 ndc = glm::vec2(clip) / clip.w;
+				low = glm::min(low, ndc);
+				high = glm::max(high, ndc);
+			}
+			if (high.x < -1.0f || high.y < -1.0f || low.x > 1.0f || low.y > 1.0f) {
+				continue;
+			}
+			bounds.MinX = glm::clamp((int)std::floor((low.x * 0.5f + 0.5f) * GRID_X), 0, GRID_X - 1);
+			bounds.MaxX = glm::clamp((int)std::floor((high.x * 0.5f + 0.5f) * GRID_X), 0, GRID_X - 1);
+			bounds.MinY = glm::clamp((int)std::floor((low.y * 0.5f + 0.5f) * GRID_Y), 0, GRID_Y - 1);
+			bounds.MaxY = glm::clamp((int)std::floor((high.y * 0.5f + 0.5f) * GRID_Y), 0, GRID_Y - 1);
+		}
+		bounds.Slice0 = GetSlice(std::max(closest, nearPlane));
+		bounds.Slice1 = GetSlice(std::min(furthest, farPlane));
+	}
+}
+
+int ClusteredLights::GetSlice(float depth) const
+{
+	//the same sum the fragment shader does, so both agree on the slice.
+	return glm::clamp((int)std::floor(std::log(depth) * _Scale.z + _Scale.w), 0, GRID_Z - 1);
+}
+
+void ClusteredLights::BinSlices(std::vector<unsigned int>& counts)
+{
+	for (int s = _NextSlice.fetch_add(1); s < GRID_Z; s = _NextSlice.fetch_add(1)) {
+		BinSlice(s, counts);
+	}
+}
+
+void ClusteredLights::BinSlice(int slice, std::vector<unsigned int>& counts)
+{
+	//count first so each cells list can be written in place.
+	counts.assign(GRID_X * GRID_Y, 0);
+	for (auto& bounds : _Bounds) {
+		if (slice < bounds.Slice0 || slice > bounds.Slice1) {
+			continue;
+		}
+		for (int y = bounds.MinY; y <= bounds.MaxY; y++) {
+			for (int x = bounds.MinX; x <= bounds.MaxX; x++) {
+				counts[y * GRID_X + x]++;
+			}
+		}
+	}
+
+	glm::uvec2* cells = &_Grid[slice * GRID_X * GRID_Y];
+	unsigned int offset = 0;
+	for (int c = 0; c < GRID_X * GRID_Y; c++) {
+		cells[c] = glm::uvec2(offset, counts[c]);
+		//reused as the write position below.
+		counts[c] = offset;
+		offset += cells[c].y;
+	}
+
+	std::vector<uint16_t>& indices = _SliceIndices[slice];
+	indices.resize(offset);
+	for (size_t i = 0; i < _Bounds.size(); i++) {
+		const LightBounds& bounds = _Bounds[i];
+		if (slice < bounds.Slice0 || slice > bounds.Slice1) {
+			continue;
+		}
+		for (int y = bounds.MinY; y <= bounds.MaxY; y++) {
+			for (int x = bounds.MinX; x <= bounds.MaxX; x++) {
+				indices[counts[y * GRID_X + x]++] = (uint16_t)i;
+			}
+		}
+	}
+}
+
+void ClusteredLights::WorkerLoop()
+{
+	unsigned int generation = 0;
+	std::vector<unsigned int> counts;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_Mutex);
+			_WorkReady.wait(lock, [this, generation]() { return _Quit || _Generation != generation; });
+			if (_Quit) {
+				return;
+			}
+			generation = _Generation;
+		}
+		BinSlices(counts);
+		{
+			std::lock_guard<std::mutex> lock(_Mutex);
+			_Busy--;
+		}
+		_WorkDone.notify_one();
+	}
+}
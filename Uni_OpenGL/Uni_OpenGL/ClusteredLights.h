@@ -0,0 +1,122 @@
+#pragma once
+
+#include <GLM\glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Buffer.h"
+#include "FrameUniforms.h"
+
+class Shader;
+class PointLight;
+
+////////////////////////////////////////////////////////////
+/// Point lights binned into a grid of view frustum cells.
+/// --The screen is split into GRID_X by GRID_Y tiles and the
+/// --view depth into GRID_Z slices, thinner near the camera.
+/// --Each frame every light is added to the cells its range
+/// --touches and the cell ranges, light index lists and light
+/// --data go up as texture buffers, so a fragment only loops
+/// --over the lights in its own cell. Slices are binned in
+/// --parallel on worker threads.
+////////////////////////////////////////////////////////////
+class ClusteredLights
+{
+public:
+	//must match CLUSTER_X, CLUSTER_Y and CLUSTER_Z in lights.glsl.
+	static const int GRID_X = 16;
+	static const int GRID_Y = 9;
+	static const int GRID_Z = 24;
+	static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+	//indices are 16 bit.
+	static const int MAX_LIGHTS = 4096;
+
+	ClusteredLights();
+	~ClusteredLights();
+
+	////////////////////////////////////////////////////////////
+	/// Creates the buffers and starts the binning threads.
+	////////////////////////////////////////////////////////////
+	void Create();
+
+	////////////////////////////////////////////////////////////
+	/// Starts a new frames light list.
+	////////////////////////////////////////////////////////////
+	void Clear();
+	void Add(const PointLight& light);
+	int GetLightCount() const { return (int)_Lights.size(); }
+
+	////////////////////////////////////////////////////////////
+	/// Bins the lights added since Clear and uploads the result.
+	/// --The depth slices run from the projections near to far
+	/// --plane.
+	/// --ScreenSize-- Viewport size in pixels, for the tiles.
+	////////////////////////////////////////////////////////////
+	void Build(const glm::mat4& view, const glm::mat4& projection, const glm::vec2& screenSize);
+
+	////////////////////////////////////////////////////////////
+	/// Binds the texture buffers and points the samplers at
+	/// --them. Must be called for every program built with
+	/// --CLUSTERED_LIGHTS.
+	////////////////////////////////////////////////////////////
+	void SendToShader(Shader* shader);
+
+	////////////////////////////////////////////////////////////
+	/// Writes the tile and slice scales into the lights block.
+	////////////////////////////////////////////////////////////
+	void Fill(LightsBlock& block) const;
+
+	//light references over every cell last frame, for the stats text.
+	int GetIndexCount() const { return (int)_Indices.size(); }
+
+private:
+	//texture units after the shadow map.
+	const int GRID_TEXTURE_UNIT = 9;
+	const int INDEX_TEXTURE_UNIT = 10;
+	const int LIGHT_TEXTURE_UNIT = 11;
+	//most threads used to bin, the main thread bins as well.
+	const unsigned int MAX_WORKERS = 3;
+
+	//cells a light touches, empty when Slice0 > Slice1.
+	struct LightBounds {
+		int MinX, MaxX;
+		int MinY, MaxY;
+		int Slice0, Slice1;
+	};
+
+	std::vector<PointLightBlock> _Lights;		// Padding holds the range.
+	std::vector<LightBounds> _Bounds;
+	std::vector<glm::uvec2> _Grid;				// Offset into _Indices and count for each cell.
+	std::vector<uint16_t> _Indices;
+	std::vector<std::vector<uint16_t>> _SliceIndices;	// Each slices lists before they are joined.
+	std::vector<unsigned int> _Counts;			// The main threads scratch while binning.
+	glm::vec4 _Scale;
+
+	Buffer _GridBuffer;
+	Buffer _IndexBuffer;
+	Buffer _LightBuffer;
+	unsigned int _GridTexture;
+	unsigned int _IndexTexture;
+	unsigned int _LightTexture;
+
+	std::vector<std::thread> _Workers;
+	std::mutex _Mutex;
+	std::condition_variable _WorkReady;
+	std::condition_variable _WorkDone;
+	unsigned int _Generation;
+	int _Busy;
+	bool _Quit;
+	std::atomic<int> _NextSlice;
+
+	void FindBounds(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane);
+	int GetSlice(float depth) const;
+	//bins slices until there are none left, run by every thread.
+	void BinSlices(std::vector<unsigned int>& counts);
+	void BinSlice(int slice, std::vector<unsigned int>& counts);
+	void WorkerLoop();
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <BULLET\btBulletCollisionCommon.h>
+
+////////////////////////////////////////////////////////////
+/// Broadphase collision filter groups.
+/// --Bodies only become a pair in the broadphase if each
+/// --ones group is in the others mask. Keeping level props
+/// --and triggers in their own groups stops them pairing
+/// --with the terrain and each other every step.
+////////////////////////////////////////////////////////////
+enum CollisionGroup {
+	COL_NONE = 0,
+	COL_DYNAMIC = btBroadphaseProxy::DefaultFilter,
+	COL_STATIC = btBroadphaseProxy::StaticFilter,
+	COL_KINEMATIC = btBroadphaseProxy::KinematicFilter,
+	COL_TRIGGER = btBroadphaseProxy::SensorTrigger,
+	COL_PROP = 1 << 6,
+	COL_VEHICLE = 1 << 7,
+	COL_ALL = btBroadphaseProxy::AllFilter
+};
+
+////////////////////////////////////////////////////////////
+/// What each group is allowed to collide with.
+////////////////////////////////////////////////////////////
+const short COL_MASK_STATIC = COL_DYNAMIC | COL_KINEMATIC | COL_VEHICLE;
+const short COL_MASK_PROP = COL_DYNAMIC | COL_VEHICLE;
+const short COL_MASK_TRIGGER = COL_VEHICLE;
+const short COL_MASK_VEHICLE = COL_ALL;
@@ -1,5 +1,6 @@
 #include "CubeMap.h"
 #include "LogManager.h"
+#include "RenderState.h"
 #include <SDL\SDL_image.h>
 #include <GLEW\glew.h>
 
@@ -23,6 +24,7 @@ CubeMap::CubeMap(std::string FileName, std::string cubeMapName)
 CubeMap::~CubeMap()
 {
 	glDeleteTextures(1, &_ID);
+	RenderState::Instance()->Invalidate();
 }
 
 bool CubeMap::Load(std::string FileName, std::string cubeMapName)
@@ -30,7 +32,7 @@ bool CubeMap::Load(std::string FileName, std::string cubeMapName)
     //create the texture
     glGenTextures(1, &_ID);
     //bind texture
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _ID);
+    RenderState::Instance()->BindTexture(0, _ID, GL_TEXTURE_CUBE_MAP);
 
     SDL_Surface* image;
     for (int i = 0; i < (int)_FaceNames.size(); i++) {
@@ -2,6 +2,7 @@
 
 #include "PrimitiveShape.h"
 #include "ShaderManager.h"
+#include "RenderState.h"
 
 #include <vector>
 
@@ -82,16 +83,16 @@ public:
 	void Render(std::string shader = "" )
 	{
 		if (shader == "") {
-			ShaderManager::Instance()->GetShader(_Shader)->SetVec3("aColor", _Color);
+			ShaderManager::Instance()->BindShader(_Shader)->SetVec3("aColor", _Color);
 		}
 		else {
-			ShaderManager::Instance()->GetShader(shader)->SetVec3("aColor", _Color);
+			ShaderManager::Instance()->BindShader(shader)->SetVec3("aColor", _Color);
 			_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aPos", 3, VT_FLOAT, 8 * sizeof(float));
 			_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aNormal", 3, VT_FLOAT, 8 * sizeof(float), 3 * sizeof(float));
 			_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aTexCoords", 2, VT_FLOAT, 8 * sizeof(float), 6 * sizeof(float));
 		}
 		_VertexArray.Bind();
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+		RenderState::Instance()->DrawArrays(GL_TRIANGLES, 0, 36);
 		_VertexArray.Unbind();
 	}
 
@@ -0,0 +1,101 @@
+#include "DistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float FAR_AWAY = 1e20f;
+
+//squared distance along one line to the nearest zero of f, in place.
+//the lower envelope of parabolas from Felzenszwalb and Huttenlocher, linear in the line length.
+static void transformLine(float* f, int count, int stride, std::vector<float>& d, std::vector<int>& v, std::vector<float>& z)
+{
+	int k = 0;
+	v[0] = 0;
+	z[0] = -FAR_AWAY;
+	z[1] = FAR_AWAY;
+	for (int q = 1; q < count; q++) {
+		float s;
+		while (true) {
+			int p = v[k];
+			s = ((f[q * stride] + q * q) - (f[p * stride] + p * p)) / (2.0f * q - 2.0f * p);
+			if (s > z[k]) {
+				break;
+			}
+			k--;
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = FAR_AWAY;
+	}
+	k = 0;
+	for (int q = 0; q < count; q++) {
+		while (z[k + 1] < q) {
+			k++;
+		}
+		float offset = (float)(q - v[k]);
+		d[q] = offset * offset + f[v[k] * stride];
+	}
+	for (int q = 0; q < count; q++) {
+		f[q * stride] = d[q];
+	}
+}
+
+//columns then rows gives the exact squared euclidean distance.
+static void transformGrid(std::vector<float>& grid, int width, int height)
+{
+	int longest = std::max(width, height);
+	std::vector<float> d(longest);
+	std::vector<int> v(longest);
+	std::vector<float> z(longest + 1);
+	for (int x = 0; x < width; x++) {
+		transformLine(&grid[x], height, width, d, v, z);
+	}
+	for (int y = 0; y < height; y++) {
+		transformLine(&grid[y * width], width, 1, d, v, z);
+	}
+}
+
+std::vector<unsigned char> buildDistanceField(const unsigned char* bitmap, int width, int height, int pitch,
+	int oversample, int spread, int& fieldWidth, int& fieldHeight)
+{
+	fieldWidth = (width + oversample - 1) / oversample + 2 * spread;
+	fieldHeight = (height + oversample - 1) / oversample + 2 * spread;
+	int gridWidth = fieldWidth * oversample;
+	int gridHeight = fieldHeight * oversample;
+	int border = spread * oversample;
+
+	//distance to the nearest inside texel for outside ones and the other way around.
+	std::vector<float> toInside(gridWidth * gridHeight, FAR_AWAY);
+	std::vector<float> toOutside(gridWidth * gridHeight, 0.0f);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			if (bitmap[y * pitch + x] >= 128) {
+				int i = (y + border) * gridWidth + x + border;
+				toInside[i] = 0.0f;
+				toOutside[i] = FAR_AWAY;
+			}
+		}
+	}
+	transformGrid(toInside, gridWidth, gridHeight);
+	transformGrid(toOutside, gridWidth, gridHeight);
+
+	//each field texel averages the block of bitmap texels it covers, the edge sits half a texel out from either side.
+	std::vector<unsigned char> field(fieldWidth * fieldHeight);
+	float scale = 1.0f / (oversample * oversample);
+	for (int fy = 0; fy < fieldHeight; fy++) {
+		for (int fx = 0; fx < fieldWidth; fx++) {
+			float sum = 0.0f;
+			for (int y = fy * oversample; y < (fy + 1) * oversample; y++) {
+				for (int x = fx * oversample; x < (fx + 1) * oversample; x++) {
+					int i = y * gridWidth + x;
+					sum += toInside[i] == 0.0f ? std::sqrt(toOutside[i]) - 0.5f : 0.5f - std::sqrt(toInside[i]);
+				}
+			}
+			float distance = sum * scale / oversample;
+			float value = std::min(std::max(0.5f + distance / (2.0f * spread), 0.0f), 1.0f);
+			field[fy * fieldWidth + fx] = (unsigned char)(value * 255.0f + 0.5f);
+		}
+	}
+	return field;
+}
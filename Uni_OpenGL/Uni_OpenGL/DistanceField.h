@@ -0,0 +1,9 @@
+#pragma once
+
+#include <vector>
+
+//signed distance field of a coverage bitmap, values above 128 are inside.
+//the field is oversample times smaller than the bitmap with spread texels of border on each side,
+//each texel maps distances from -spread to spread, in field texels, onto 0 to 255 with the edge at 128.
+std::vector<unsigned char> buildDistanceField(const unsigned char* bitmap, int width, int height, int pitch,
+	int oversample, int spread, int& fieldWidth, int& fieldHeight);
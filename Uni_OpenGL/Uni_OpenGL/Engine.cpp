@@ -7,9 +7,16 @@
 #include "StateManager.h"
 #include "InputManager.h"
 #include "ScreenManager.h"
+#include "PhysicsManager.h"
+#include "RenderState.h"
+#include "Profiler.h"
+#include "StatsManager.h"
+#include "ShaderManager.h"
 
 #include "Timer.h"
 
+#include <algorithm>
+
 
 
 Engine::Engine()
@@ -28,6 +35,7 @@ bool Engine::Initialize(int Width, int Height, std::string Title)
         LogManager::Instance()->LogError("Screen Manager Failed To Initialize!");
         return false;
     }
+    InputManager::Instance()->Initialize();
 
     if (!StateManager::Instance()->AddState("[STATE]Load", new LoadState())) {
         return false;
@@ -36,25 +44,53 @@ bool Engine::Initialize(int Width, int Height, std::string Title)
         return false;
     }
 
+    if (!_ReplayFile.empty() && !InputManager::Instance()->StartPlayback(_ReplayFile)) {
+        return false;
+    }
+    if (!_RecordFile.empty()) {
+        InputManager::Instance()->StartRecording(_RecordFile);
+    }
+    if (!_TraceFile.empty()) {
+        Profiler::Instance()->StartTrace(_TraceFile);
+    }
+    if (!_StatsFile.empty()) {
+        StatsManager::Instance()->StartCsv(_StatsFile);
+    }
+    if (_WatchShaders) {
+        ShaderManager::Instance()->SetHotReload(true);
+    }
+    if (_Benchmark && _ReplayFile.empty()) {
+        LogManager::Instance()->LogWarning("Benchmark mode needs a replay file, running normally.");
+        _Benchmark = false;
+    }
+
     return true;
 }
 
 void Engine::Input()
 {
+    PROFILE_SCOPE("Engine::Input");
     InputManager::Instance()->Update();
     StateManager::Instance()->Input();
 }
 
 void Engine::Update(float delta)
 {
+    PROFILE_SCOPE("Engine::Update");
+    ShaderManager::Instance()->Update();
     StateManager::Instance()->Update(delta);
 }
 
 void Engine::Render()
 {
+    PROFILE_SCOPE("Engine::Render");
     ScreenManager::Instance()->Clear();
     StateManager::Instance()->Render();
-    ScreenManager::Instance()->SwapBuffers();
+    {
+        //mostly waiting on vsync or the gpu.
+        PROFILE_SCOPE("SwapBuffers");
+        ScreenManager::Instance()->SwapBuffers();
+    }
 }
 
 int Engine::Run()
@@ -62,18 +98,49 @@ int Engine::Run()
     Timer* _Timer = new Timer();
     _Timer->Start();
 
+    StopWatch _RunTime;
+    _RunTime.Start();
+    int frames = 0;
+
     while (!InputManager::Instance()->HasQuit()) {
+        Profiler::Instance()->BeginFrame();
         Input();
-        Update(_Timer->GetDelta());
-        Render();
+        float delta = _Timer->GetDelta();
+        if (_FixedTimeStep > 0.0f) {
+            delta = _FixedTimeStep;
+        }
+        //recorded deltas replace the measured one during playback.
+        Update(InputManager::Instance()->GetFrameDelta(delta));
+        frames++;
+        //collect key events between the slow parts of the frame so their timestamps are closer to real.
+        InputManager::Instance()->PumpEvents();
+
+        if (_Benchmark) {
+            if (InputManager::Instance()->HasPlaybackFinished()) {
+                Profiler::Instance()->EndFrame();
+                StatsManager::Instance()->EndFrame();
+                break;
+            }
+        }
+        else {
+            Render();
+            InputManager::Instance()->PumpEvents();
+        }
+        Profiler::Instance()->EndFrame();
+        StatsManager::Instance()->EndFrame();
     }
+
+    if (_Benchmark) {
+        _RunTime.Update();
+        LogBenchmark(frames, _RunTime.GetElapsedTime());
+    }
+
+    delete _Timer;
+
     if (!Shutdown()) {
         return 0;
     }
     return 1;
-
-    delete _Timer;
-    
 }
 
 bool Engine::Shutdown()
@@ -83,6 +150,30 @@ bool Engine::Shutdown()
         return false;
     }
 
+    InputManager::Instance()->Shutdown();
+    Profiler::Instance()->StopTrace();
+    StatsManager::Instance()->StopCsv();
+    Profiler::Instance()->Shutdown();
+    ShaderManager::Instance()->Shutdown();
     ScreenManager::Instance()->Close();
     return true;
 }
+
+void Engine::LogBenchmark(int Frames, float Seconds)
+{
+    const PhysicsTimingTotals& totals = PhysicsManager::Instance()->GetTimingTotals();
+    LogManager::Instance()->LogInfo("Benchmark finished: " + std::to_string(Frames) + " frames in " + std::to_string(Seconds) + "s");
+    if (totals.Updates > 0) {
+        LogManager::Instance()->LogInfo("Physics updates: " + std::to_string(totals.Updates) +
+            ", sub steps: " + std::to_string(totals.SubSteps) +
+            ", average update: " + std::to_string(totals.TotalTime / totals.Updates) + "ms" +
+            ", worst update: " + std::to_string(totals.WorstTime) + "ms");
+    }
+    //counts are deterministic under replay, so runs can be compared on these too.
+    StatsManager* stats = StatsManager::Instance();
+    for (int i = 0; i < STAT_COUNT; i++) {
+        StatCounter counter = (StatCounter)i;
+        LogManager::Instance()->LogInfo(std::string(StatsManager::GetName(counter)) + ": " + std::to_string(stats->GetTotal(counter)) +
+            " total, " + std::to_string(stats->GetTotal(counter) / std::max(stats->GetFrameCount(), 1)) + " per frame");
+    }
+}
@@ -59,5 +59,64 @@ public:
     /// Calls shutdown from state manager, then releases any
     /// resources from the game engine.
     ////////////////////////////////////////////////////////////
-    bool Shutdown();    
+    bool Shutdown();
+
+    ////////////////////////////////////////////////////////////
+    /// Records all input to a file while the game runs.
+    /// --FilePath-- The file to record to.
+    ////////////////////////////////////////////////////////////
+    void SetRecordFile(std::string FilePath) { _RecordFile = FilePath; }
+
+    ////////////////////////////////////////////////////////////
+    /// Plays back a recorded input file instead of live input.
+    /// --FilePath-- The file to play back.
+    ////////////////////////////////////////////////////////////
+    void SetReplayFile(std::string FilePath) { _ReplayFile = FilePath; }
+
+    ////////////////////////////////////////////////////////////
+    /// Updates with a constant delta instead of the timer.
+    /// --TimeStep-- The delta in seconds, 0 uses the timer.
+    ////////////////////////////////////////////////////////////
+    void SetFixedTimeStep(float TimeStep) { _FixedTimeStep = TimeStep; }
+
+    ////////////////////////////////////////////////////////////
+    /// Benchmark mode skips rendering, quits when the replay
+    /// ends and logs the physics timings.
+    ////////////////////////////////////////////////////////////
+    void SetBenchmark(bool Benchmark) { _Benchmark = Benchmark; }
+
+    ////////////////////////////////////////////////////////////
+    /// Records every profiler scope over the run and writes
+    /// them as a Chrome trace on shutdown.
+    /// --FilePath-- The json file to write.
+    ////////////////////////////////////////////////////////////
+    void SetTraceFile(std::string FilePath) { _TraceFile = FilePath; }
+
+    ////////////////////////////////////////////////////////////
+    /// Writes every stats counter to a csv file, one row per
+    /// frame.
+    /// --FilePath-- The csv file to write.
+    ////////////////////////////////////////////////////////////
+    void SetStatsFile(std::string FilePath) { _StatsFile = FilePath; }
+
+    ////////////////////////////////////////////////////////////
+    /// Rebuilds shaders when their files change on disk and
+    /// swaps them in once they link.
+    ////////////////////////////////////////////////////////////
+    void SetWatchShaders(bool Watch) { _WatchShaders = Watch; }
+
+private:
+    std::string _RecordFile;
+    std::string _ReplayFile;
+    std::string _TraceFile;
+    std::string _StatsFile;
+    float _FixedTimeStep = 0.0f;
+    bool _Benchmark = false;
+    bool _WatchShaders = false;
+
+    ////////////////////////////////////////////////////////////
+    /// Writes the physics timings collected over the run to
+    /// the log.
+    ////////////////////////////////////////////////////////////
+    void LogBenchmark(int Frames, float Seconds);
 };
\ No newline at end of file
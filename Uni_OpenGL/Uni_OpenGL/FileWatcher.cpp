@@ -0,0 +1,67 @@
+#include "FileWatcher.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+void FileWatcher::Watch(const std::string& filePath)
+{
+	for (auto& file : _Files) {
+		if (file.Path == filePath) {
+			return;
+		}
+	}
+	WatchedFile file;
+	file.Path = filePath;
+	file.Modified = 0;
+	file.Size = 0;
+	file.Changing = false;
+	ReadInfo(filePath, file.Modified, file.Size);
+	_Files.push_back(file);
+}
+
+void FileWatcher::Clear()
+{
+	_Files.clear();
+}
+
+std::vector<std::string> FileWatcher::Poll()
+{
+	std::vector<std::string> changed;
+	for (auto& file : _Files) {
+		long long modified = 0;
+		long long size = 0;
+		//a file mid-save can be missing for a moment, treat that as still changing.
+		if (!ReadInfo(file.Path, modified, size)) {
+			file.Changing = true;
+			continue;
+		}
+		if (modified != file.Modified || size != file.Size) {
+			file.Modified = modified;
+			file.Size = size;
+			file.Changing = true;
+		}
+		else if (file.Changing) {
+			file.Changing = false;
+			changed.push_back(file.Path);
+		}
+	}
+	return changed;
+}
+
+bool FileWatcher::ReadInfo(const std::string& filePath, long long& modified, long long& size)
+{
+#ifdef _WIN32
+	struct _stat64 info;
+	if (_stat64(filePath.c_str(), &info) != 0) {
+		return false;
+	}
+#else
+	struct stat info;
+	if (stat(filePath.c_str(), &info) != 0) {
+		return false;
+	}
+#endif
+	modified = (long long)info.st_mtime;
+	size = (long long)info.st_size;
+	return true;
+}
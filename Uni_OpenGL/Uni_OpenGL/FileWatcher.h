@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// Reports files that have changed on disk by polling their
+/// --modified time and size. A change is only reported once
+/// --the file has stayed the same for a whole poll, so an
+/// --editor that saves in several writes is not caught half
+/// --way through.
+////////////////////////////////////////////////////////////
+class FileWatcher
+{
+public:
+	//starts watching a file, watching it twice does nothing.
+	void Watch(const std::string& filePath);
+	void Clear();
+
+	//files that changed and have settled since the last call.
+	std::vector<std::string> Poll();
+
+private:
+	struct WatchedFile {
+		std::string Path;
+		long long Modified;
+		long long Size;
+		bool Changing;
+	};
+
+	static bool ReadInfo(const std::string& filePath, long long& modified, long long& size);
+
+	std::vector<WatchedFile> _Files;
+};
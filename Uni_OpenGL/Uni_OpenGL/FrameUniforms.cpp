@@ -0,0 +1,41 @@
+#include "FrameUniforms.h"
+
+FrameUniforms::FrameUniforms()
+{
+	_CameraBuffer.Create(UBO);
+	_CameraBuffer.Fill(sizeof(CameraBlock), nullptr, STREAM);
+	_CameraBuffer.BindBase(BLOCK_CAMERA);
+
+	_LightsBuffer.Create(UBO);
+	_LightsBuffer.Fill(sizeof(LightsBlock), nullptr, STREAM);
+	_LightsBuffer.BindBase(BLOCK_LIGHTS);
+}
+
+FrameUniforms::~FrameUniforms()
+{
+	_CameraBuffer.Destroy();
+	_LightsBuffer.Destroy();
+}
+
+void FrameUniforms::UpdateCamera(const CameraBlock& camera)
+{
+	//filling the whole buffer orphans the old storage.
+	_CameraBuffer.Fill(sizeof(CameraBlock), &camera, STREAM);
+}
+
+void FrameUniforms::UpdateLights(const LightsBlock& lights)
+{
+	_LightsBuffer.Fill(sizeof(LightsBlock), &lights, STREAM);
+}
+
+int FrameUniforms::GetBlockSize(UniformBlock block)
+{
+	switch (block) {
+	case BLOCK_CAMERA:
+		return sizeof(CameraBlock);
+	case BLOCK_LIGHTS:
+		return sizeof(LightsBlock);
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Buffer.h"
+
+#include <GLM\glm.hpp>
+
+////////////////////////////////////////////////////////////
+/// Uniform block binding points, every program has its
+/// --blocks with these names bound to these points when it
+/// --is linked.
+////////////////////////////////////////////////////////////
+enum UniformBlock {
+	BLOCK_CAMERA = 0,
+	BLOCK_LIGHTS,
+	BLOCK_COUNT
+};
+
+const char* const UNIFORM_BLOCK_NAMES[BLOCK_COUNT] = { "Camera", "Lights" };
+
+////////////////////////////////////////////////////////////
+/// std140 mirrors of the blocks in the shaders. A vec3 is
+/// --16 byte aligned there, so each one is followed by a
+/// --float, either a real member or padding.
+////////////////////////////////////////////////////////////
+struct CameraBlock {
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::vec3 ViewPosition;
+	float Padding;
+};
+
+struct DirLightBlock {
+	glm::vec3 Direction;
+	float Padding0;
+	glm::vec3 Ambient;
+	float Padding1;
+	glm::vec3 Diffuse;
+	float Padding2;
+	glm::vec3 Specular;
+	float Padding3;
+};
+
+struct PointLightBlock {
+	glm::vec3 Position;
+	float Constant;
+	glm::vec3 Ambient;
+	float Linear;
+	glm::vec3 Diffuse;
+	float Quadratic;
+	glm::vec3 Specular;
+	float Padding;		// Unused by the block, clustered lights keep the range here.
+};
+
+struct LightsBlock {
+	static const int MAX_POINT_LIGHTS = 10;
+	static const int MAX_CASCADES = 4;
+
+	DirLightBlock DirLight;
+	PointLightBlock PointLights[MAX_POINT_LIGHTS];
+	int HasDirLight;
+	int HasPointLight;
+	int PointLightCount;
+	int CascadeCount;
+	glm::mat4 LightSpaceMatrices[MAX_CASCADES];
+	glm::vec4 CascadeSplits;	// A float array would have a 16 byte stride, so the splits share one vec4.
+	glm::vec4 ClusterScale;		// Tiles per pixel in x and y, log depth to slice scale and bias in z and w.
+};
+
+////////////////////////////////////////////////////////////
+/// Per frame data every program reads from uniform buffers
+/// --instead of each program getting its own copy. Each
+/// --block is uploaded once a frame and reallocated on
+/// --upload, so the driver can hand back fresh memory rather
+/// --than wait on draws still reading last frames data.
+////////////////////////////////////////////////////////////
+class FrameUniforms
+{
+public:
+	FrameUniforms();
+	~FrameUniforms();
+
+	void UpdateCamera(const CameraBlock& camera);
+	void UpdateLights(const LightsBlock& lights);
+
+	////////////////////////////////////////////////////////////
+	/// Size the shaders should report for each block, checked
+	/// --when programs are linked.
+	////////////////////////////////////////////////////////////
+	static int GetBlockSize(UniformBlock block);
+
+private:
+	Buffer _CameraBuffer;
+	Buffer _LightsBuffer;
+};
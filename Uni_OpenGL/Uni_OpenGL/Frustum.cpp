@@ -0,0 +1,134 @@
+#include "Frustum.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+void BoundsList::Clear()
+{
+	X.clear();
+	Y.clear();
+	Z.clear();
+	ExtentX.clear();
+	ExtentY.clear();
+	ExtentZ.clear();
+}
+
+void BoundsList::AddSphere(const glm::vec3& center, float radius)
+{
+	AddBox(center, glm::vec3(radius));
+}
+
+void BoundsList::AddBox(const glm::vec3& center, const glm::vec3& extents)
+{
+	X.push_back(center.x);
+	Y.push_back(center.y);
+	Z.push_back(center.z);
+	ExtentX.push_back(extents.x);
+	ExtentY.push_back(extents.y);
+	ExtentZ.push_back(extents.z);
+}
+
+void Frustum::Extract(const glm::mat4& viewProjection)
+{
+	//gribb/hartmann, each plane is the fourth row plus or minus one of the others.
+	//glm is column major so m[col][row].
+	const glm::mat4& m = viewProjection;
+	for (int i = 0; i < PLANE_COUNT; i++) {
+		int row = i / 2;
+		float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+		glm::vec4 plane(
+			m[0][3] + sign * m[0][row],
+			m[1][3] + sign * m[1][row],
+			m[2][3] + sign * m[2][row],
+			m[3][3] + sign * m[3][row]);
+		float length = glm::length(glm::vec3(plane));
+		plane /= length;
+		_PlaneX[i] = plane.x;
+		_PlaneY[i] = plane.y;
+		_PlaneZ[i] = plane.z;
+		_PlaneW[i] = plane.w;
+	}
+}
+
+void Frustum::CullSpheres(const BoundsList& spheres, std::vector<unsigned char>& visible, CullStats& stats) const
+{
+	Cull(spheres, true, visible, stats);
+}
+
+void Frustum::CullBoxes(const BoundsList& boxes, std::vector<unsigned char>& visible, CullStats& stats) const
+{
+	Cull(boxes, false, visible, stats);
+}
+
+void Frustum::Cull(const BoundsList& bounds, bool sphere, std::vector<unsigned char>& visible, CullStats& stats) const
+{
+	int count = bounds.Size();
+	visible.resize(count);
+
+	int i = 0;
+#ifdef FRUSTUM_USE_SSE
+	//four bounds against one plane at a time. a bound is outside if it is
+	//fully behind any plane: distance < -radius, where a box radius is its
+	//extents projected onto the plane normal.
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	for (; i + 4 <= count; i += 4) {
+		__m128 cx = _mm_loadu_ps(&bounds.X[i]);
+		__m128 cy = _mm_loadu_ps(&bounds.Y[i]);
+		__m128 cz = _mm_loadu_ps(&bounds.Z[i]);
+		__m128 ex = _mm_loadu_ps(&bounds.ExtentX[i]);
+		__m128 ey = _mm_loadu_ps(&bounds.ExtentY[i]);
+		__m128 ez = _mm_loadu_ps(&bounds.ExtentZ[i]);
+
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < PLANE_COUNT; p++) {
+			__m128 px = _mm_set1_ps(_PlaneX[p]);
+			__m128 py = _mm_set1_ps(_PlaneY[p]);
+			__m128 pz = _mm_set1_ps(_PlaneZ[p]);
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)), _mm_add_ps(_mm_mul_ps(pz, cz), _mm_set1_ps(_PlaneW[p])));
+			__m128 radius;
+			if (sphere) {
+				radius = ex;
+			}
+			else {
+				radius = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_andnot_ps(signMask, px), ex),
+					_mm_mul_ps(_mm_andnot_ps(signMask, py), ey)),
+					_mm_mul_ps(_mm_andnot_ps(signMask, pz), ez));
+			}
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+		}
+
+		int mask = _mm_movemask_ps(outside);
+		for (int j = 0; j < 4; j++) {
+			visible[i + j] = (mask & (1 << j)) ? 0 : 1;
+		}
+	}
+#endif
+	//whatever doesnt fill a group of four, or everything without sse.
+	for (; i < count; i++) {
+		bool inside = true;
+		for (int p = 0; p < PLANE_COUNT && inside; p++) {
+			float distance = _PlaneX[p] * bounds.X[i] + _PlaneY[p] * bounds.Y[i] + _PlaneZ[p] * bounds.Z[i] + _PlaneW[p];
+			float radius = bounds.ExtentX[i];
+			if (!sphere) {
+				radius = std::fabs(_PlaneX[p]) * bounds.ExtentX[i] + std::fabs(_PlaneY[p]) * bounds.ExtentY[i] + std::fabs(_PlaneZ[p]) * bounds.ExtentZ[i];
+			}
+			inside = distance >= -radius;
+		}
+		visible[i] = inside ? 1 : 0;
+	}
+
+	for (int j = 0; j < count; j++) {
+		if (visible[j]) {
+			stats.Visible++;
+		}
+		else {
+			stats.Culled++;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <GLM\glm.hpp>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// Bounds to cull, kept as separate arrays so four of them
+/// --can be loaded into one sse register at a time.
+/// --Spheres use Extents.x as the radius.
+////////////////////////////////////////////////////////////
+struct BoundsList {
+	std::vector<float> X, Y, Z;
+	std::vector<float> ExtentX, ExtentY, ExtentZ;
+
+	void Clear();
+	void AddSphere(const glm::vec3& center, float radius);
+	void AddBox(const glm::vec3& center, const glm::vec3& extents);
+	int Size() const { return (int)X.size(); }
+};
+
+struct CullStats {
+	int Visible = 0;
+	int Culled = 0;
+};
+
+////////////////////////////////////////////////////////////
+/// Camera frustum planes for culling bounds in bulk.
+/// --Bounds that are partly inside count as visible, so the
+/// --test is conservative near the corners of the frustum.
+////////////////////////////////////////////////////////////
+class Frustum
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// Pulls the six planes out of a projection * view matrix.
+	////////////////////////////////////////////////////////////
+	void Extract(const glm::mat4& viewProjection);
+
+	////////////////////////////////////////////////////////////
+	/// Fills visible with one entry per bound, 1 if it is at
+	/// --least partly inside the frustum. Adds to stats.
+	////////////////////////////////////////////////////////////
+	void CullSpheres(const BoundsList& spheres, std::vector<unsigned char>& visible, CullStats& stats) const;
+	void CullBoxes(const BoundsList& boxes, std::vector<unsigned char>& visible, CullStats& stats) const;
+
+private:
+	static const int PLANE_COUNT = 6;
+
+	//plane normals and distances split by component, normalised.
+	float _PlaneX[PLANE_COUNT];
+	float _PlaneY[PLANE_COUNT];
+	float _PlaneZ[PLANE_COUNT];
+	float _PlaneW[PLANE_COUNT];
+
+	//shared by both tests, spheres keep their radius in ExtentX.
+	void Cull(const BoundsList& bounds, bool sphere, std::vector<unsigned char>& visible, CullStats& stats) const;
+};
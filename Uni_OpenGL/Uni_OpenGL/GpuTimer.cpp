@@ -0,0 +1,68 @@
+#include "GpuTimer.h"
+
+#include <GLEW\glew.h>
+
+GpuTimer::GpuTimer() :
+	_Index(0),
+	_Running(false),
+	_Created(false),
+	_LastTime(0.0f)
+{
+	for (int i = 0; i < RING_SIZE; i++) {
+		_Queries[i] = 0;
+		_Pending[i] = false;
+	}
+}
+
+GpuTimer::~GpuTimer()
+{
+	if (_Created) {
+		glDeleteQueries(RING_SIZE, _Queries);
+	}
+}
+
+void GpuTimer::Begin()
+{
+	//created on first use so timers can be members of things built before the context.
+	if (!_Created) {
+		glGenQueries(RING_SIZE, _Queries);
+		_Created = true;
+	}
+	CollectResults();
+	if (_Pending[_Index]) {
+		return;
+	}
+	glBeginQuery(GL_TIME_ELAPSED, _Queries[_Index]);
+	_Running = true;
+}
+
+void GpuTimer::End()
+{
+	if (!_Running) {
+		return;
+	}
+	glEndQuery(GL_TIME_ELAPSED);
+	_Pending[_Index] = true;
+	_Index = (_Index + 1) % RING_SIZE;
+	_Running = false;
+}
+
+void GpuTimer::CollectResults()
+{
+	//oldest first so the newest finished result wins.
+	for (int i = 1; i <= RING_SIZE; i++) {
+		int query = (_Index + i) % RING_SIZE;
+		if (!_Pending[query]) {
+			continue;
+		}
+		GLint available = 0;
+		glGetQueryObjectiv(_Queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			continue;
+		}
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(_Queries[query], GL_QUERY_RESULT, &nanoseconds);
+		_LastTime = (float)(nanoseconds / 1000000.0);
+		_Pending[query] = false;
+	}
+}
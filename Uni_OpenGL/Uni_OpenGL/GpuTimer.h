@@ -0,0 +1,33 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+/// Times a span of gpu work with GL_TIME_ELAPSED queries.
+/// --Results are read back a few frames later from a ring of
+/// --queries so reading them never waits on the gpu. If the
+/// --gpu falls further behind than the ring, that frame is
+/// --not measured instead of stalling.
+////////////////////////////////////////////////////////////
+class GpuTimer
+{
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	void Begin();
+	void End();
+
+	//time of the newest query that has finished.
+	float GetMilliseconds() { return _LastTime; }
+
+private:
+	static const int RING_SIZE = 4;
+
+	unsigned int _Queries[RING_SIZE];
+	bool _Pending[RING_SIZE];
+	int _Index;
+	bool _Running;
+	bool _Created;
+	float _LastTime;
+
+	void CollectResults();
+};
@@ -2,6 +2,7 @@
 
 #include "PrimitiveShape.h"
 #include "ShaderManager.h"
+#include "RenderState.h"
 
 #include <vector>
 
@@ -43,9 +44,9 @@ public:
 
 	void Render(std::string shader = "")
 	{
-		ShaderManager::Instance()->GetShader(_Shader)->SetVec3("aColor", _Color);
+		ShaderManager::Instance()->BindShader(_Shader)->SetVec3("aColor", _Color);
 		_VertexArray.Bind();
-		glDrawArrays(GL_LINES, 0, _DrawCount);
+		RenderState::Instance()->DrawArrays(GL_LINES, 0, _DrawCount);
 		_VertexArray.Unbind();
 	}
 
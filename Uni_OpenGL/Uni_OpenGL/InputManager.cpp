@@ -4,6 +4,7 @@
 #include "InputManager.h"
 #include "ScreenManager.h"
 #include "LogManager.h"
+#include "ActionManager.h"
 #include <SDL\SDL.h>
 
 ////////////////////////////////////////////////////////////
@@ -12,23 +13,72 @@
 InputManager InputManager::_Instance;
 
 ////////////////////////////////////////////////////////////
-InputManager::InputManager() : _CapturedMouse(true){}
+InputManager::InputManager() : _CapturedMouse(true), _LastUpdateTime(0), _KeyQueueFull(false),
+	_Recorder(nullptr), _Playback(nullptr), _PlaybackDelta(0.0f), _PlaybackFinished(false){}
 
 ////////////////////////////////////////////////////////////
-InputManager::~InputManager(){}
+InputManager::~InputManager()
+{
+	StopRecording();
+	delete _Playback;
+}
+
+////////////////////////////////////////////////////////////
+void InputManager::Initialize()
+{
+	SDL_AddEventWatch(KeyEventWatch, this);
+	_LastUpdateTime = SDL_GetPerformanceCounter();
+	ActionManager::Instance()->Initialize();
+}
+
+////////////////////////////////////////////////////////////
+void InputManager::Shutdown()
+{
+	SDL_DelEventWatch(KeyEventWatch, this);
+	StopRecording();
+}
+
+////////////////////////////////////////////////////////////
+void InputManager::PumpEvents()
+{
+	SDL_PumpEvents();
+}
+
+////////////////////////////////////////////////////////////
+int InputManager::KeyEventWatch(void * UserData, SDL_Event * Event)
+{
+	//runs on whichever thread pushed the event, so only touch the queue here.
+	if ((Event->type == SDL_KEYDOWN || Event->type == SDL_KEYUP) && Event->key.repeat == 0) {
+		InputManager* input = static_cast<InputManager*>(UserData);
+		KeyEvent kEvent;
+		kEvent.Keycode = Event->key.keysym.sym;
+		kEvent.State = Event->key.state;
+		kEvent.Mod = Event->key.keysym.mod;
+		kEvent.Timestamp = SDL_GetPerformanceCounter();
+		kEvent.FrameTime = 0.0f;
+		if (!input->_KeyQueue.Push(kEvent)) {
+			input->_KeyQueueFull = true;
+		}
+	}
+	return 0;
+}
 
 ////////////////////////////////////////////////////////////
 void InputManager::Update()
 {
+	_KeysPrevious = _KeysCurrent;
+	_KeysPressed.reset();
+	_KeysReleased.reset();
+	_FrameKeyEvents.clear();
+
 	SDL_Event e;
 	while (SDL_PollEvent(&e)) {
+		//during playback only the window and quit events come from SDL.
+		if (_Playback && e.type != SDL_WINDOWEVENT && e.type != SDL_QUIT) {
+			continue;
+		}
+		//key events come in through the KeyEventWatch queue instead.
 		switch (e.type) {
-		case SDL_KEYDOWN:
-			AddKeyboardEvent(e.key.keysym.sym, e.key.state, e.key.keysym.mod);
-			break;
-		case SDL_KEYUP:
-			AddKeyboardEvent(e.key.keysym.sym, e.key.state, e.key.keysym.mod);
-			break;
 		case SDL_WINDOWEVENT:
 			AddWindowEvent(e.window.windowID, e.window.event, e.window.data1, e.window.data2);
 			break;
@@ -49,46 +99,42 @@ void InputManager::Update()
 			break;
 		}
 	}
-}
 
-////////////////////////////////////////////////////////////
-bool InputManager::IsKeyPressed(int Key)
-{
-	auto search = KeyboardEvents.find(Key);
-	if (search != KeyboardEvents.end()) {
-		if (KeyboardEvents.at(Key).State == SDL_PRESSED && KeyPressed.at(Key) != true) {
-			KeyPressed.at(Key) = true;
-			return true;
-		}
+	uint64_t now = SDL_GetPerformanceCounter();
+	DrainKeyQueue(now);
+	_LastUpdateTime = now;
+
+	if (_Playback) {
+		PlaybackFrame();
 	}
-	return false;
+
+	ActionManager::Instance()->Update();
 }
 
 ////////////////////////////////////////////////////////////
-bool InputManager::IsKeyReleased(int Key)
+void InputManager::DrainKeyQueue(uint64_t Now)
 {
-	auto search = KeyboardEvents.find(Key);
-	if (search != KeyboardEvents.end()) {
-		if (KeyboardEvents.at(Key).State == SDL_RELEASED) {
-			return true;
-		}
+	if (_KeyQueueFull) {
+		LogManager::Instance()->LogWarning("Key event queue overflowed, some key events were lost.");
+		_KeyQueueFull = false;
 	}
-	return false;
-}
 
-////////////////////////////////////////////////////////////
-bool InputManager::IsKeyHeld(int Key)
-{
-	auto search = KeyboardEvents.find(Key);
-	if (search != KeyboardEvents.end()) {
-		if (KeyboardEvents.at(Key).State == SDL_PRESSED && KeyPressed.at(Key) == true) {
-			return true;
+	double frameLength = (double)(Now - _LastUpdateTime);
+	KeyEvent kEvent;
+	while (_KeyQueue.Pop(kEvent)) {
+		//live keys are ignored during playback but still need draining.
+		if (_Playback) {
+			continue;
 		}
-		else if (KeyboardEvents.at(Key).State == SDL_PRESSED) {
-			return true;
+		float frameTime = 1.0f;
+		if (frameLength > 0.0 && kEvent.Timestamp > _LastUpdateTime) {
+			frameTime = (float)((double)(kEvent.Timestamp - _LastUpdateTime) / frameLength);
 		}
+		else if (kEvent.Timestamp <= _LastUpdateTime) {
+			frameTime = 0.0f;
+		}
+		AddKeyboardEvent(kEvent.Keycode, kEvent.State, kEvent.Mod, frameTime > 1.0f ? 1.0f : frameTime, kEvent.Timestamp);
 	}
-	return false;
 }
 
 ////////////////////////////////////////////////////////////
@@ -206,24 +252,127 @@ void InputManager::ResetMouseEvents()
 }
 
 ////////////////////////////////////////////////////////////
-void InputManager::AddKeyboardEvent(int Keycode, int State, int Mod)
+bool InputManager::StartRecording(const std::string & FilePath)
 {
-	KeyEvent kEvent;
-	kEvent.Keycode = Keycode;
-	kEvent.State = State;
-	kEvent.Mod = Mod;
+	StopRecording();
+	_Recorder = new InputRecorder();
+	if (!_Recorder->Open(FilePath)) {
+		delete _Recorder;
+		_Recorder = nullptr;
+		return false;
+	}
+	return true;
+}
 
-	auto search = KeyboardEvents.find(Keycode);
-	if (search != KeyboardEvents.end()) {
-		KeyboardEvents.at(Keycode) = kEvent;
-		if (State == SDL_RELEASED) {
-			KeyPressed.at(Keycode) = false;
+////////////////////////////////////////////////////////////
+void InputManager::StopRecording()
+{
+	if (_Recorder) {
+		_Recorder->Close();
+		delete _Recorder;
+		_Recorder = nullptr;
+	}
+}
+
+////////////////////////////////////////////////////////////
+bool InputManager::StartPlayback(const std::string & FilePath)
+{
+	delete _Playback;
+	_Playback = new InputPlayback();
+	_PlaybackFinished = false;
+	if (!_Playback->Open(FilePath)) {
+		delete _Playback;
+		_Playback = nullptr;
+		return false;
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+bool InputManager::IsPlayingBack()
+{
+	return _Playback != nullptr;
+}
+
+////////////////////////////////////////////////////////////
+bool InputManager::HasPlaybackFinished()
+{
+	return _PlaybackFinished;
+}
+
+////////////////////////////////////////////////////////////
+float InputManager::GetFrameDelta(float MeasuredDelta)
+{
+	if (_Playback) {
+		return _PlaybackDelta;
+	}
+	if (_Recorder) {
+		_Recorder->EndFrame(MeasuredDelta);
+	}
+	return MeasuredDelta;
+}
+
+////////////////////////////////////////////////////////////
+void InputManager::PlaybackFrame()
+{
+	if (!_Playback->NextFrame(_PlaybackDelta, _PlaybackEvents)) {
+		LogManager::Instance()->LogInfo("Input playback finished after " + std::to_string(_Playback->GetFrame()) + " frames.");
+		delete _Playback;
+		_Playback = nullptr;
+		_PlaybackDelta = 0.0f;
+		_PlaybackFinished = true;
+		return;
+	}
+	for (auto& r : _PlaybackEvents) {
+		switch (r.Type) {
+		case REC_KEYBOARD:
+			AddKeyboardEvent(r.Data[0], r.Data[1], r.Data[2], (float)r.Data[3] / 65535.0f);
+			break;
+		case REC_MOUSE_BUTTON:
+			AddMouseButtonEvent(r.Data[0], r.Data[1], r.Data[2]);
+			break;
+		case REC_MOUSE_MOVE:
+			AddMouseMoveEvent(r.Data[0], r.Data[1], r.Data[2], r.Data[3]);
+			break;
+		case REC_MOUSE_SCROLL:
+			AddMouseScrollEvent(r.Data[0], r.Data[1], r.Data[2]);
+			break;
 		}
 	}
+}
+
+////////////////////////////////////////////////////////////
+void InputManager::AddKeyboardEvent(int Keycode, int State, int Mod, float FrameTime, uint64_t Timestamp)
+{
+	int index = KeyIndex(Keycode);
+	if (index == KEY_IGNORED) {
+		return;
+	}
+	bool down = (State == SDL_PRESSED);
+	//only changes are kept, so a press and release in the same frame both count.
+	if (_KeysCurrent[index] == down) {
+		return;
+	}
+
+	if (_Recorder) {
+		_Recorder->AddEvent(REC_KEYBOARD, Keycode, State, Mod, (int32_t)(FrameTime * 65535.0f));
+	}
+
+	_KeysCurrent[index] = down;
+	if (down) {
+		_KeysPressed[index] = true;
+	}
 	else {
-		KeyboardEvents.emplace(std::make_pair(Keycode, kEvent));
-		KeyPressed.emplace(std::make_pair(Keycode, false));
+		_KeysReleased[index] = true;
 	}
+
+	KeyEvent kEvent;
+	kEvent.Keycode = Keycode;
+	kEvent.State = State;
+	kEvent.Mod = Mod;
+	kEvent.Timestamp = Timestamp;
+	kEvent.FrameTime = FrameTime;
+	_FrameKeyEvents.push_back(kEvent);
 }
 
 ////////////////////////////////////////////////////////////
@@ -247,6 +396,9 @@ void InputManager::AddWindowEvent(int WindowID, int Type, int Data1, int Data2)
 ////////////////////////////////////////////////////////////
 void InputManager::AddMouseScrollEvent(int X, int Y, int Direction)
 {
+	if (_Recorder) {
+		_Recorder->AddEvent(REC_MOUSE_SCROLL, X, Y, Direction);
+	}
 	MouseScrollEvt.X = X;
 	MouseScrollEvt.Y = Y;
 	MouseScrollEvt.Direction = Direction;
@@ -260,6 +412,9 @@ void InputManager::AddMouseScrollEvent(int X, int Y, int Direction)
 ////////////////////////////////////////////////////////////
 void InputManager::AddMouseMoveEvent(int xPos, int yPos, int xRel, int yRel)
 {
+	if (_Recorder) {
+		_Recorder->AddEvent(REC_MOUSE_MOVE, xPos, yPos, xRel, yRel);
+	}
 	MouseMoveEvt.xPos = xPos;
 	MouseMoveEvt.yPos = yPos;
 	MouseMoveEvt.xRel = xRel;
@@ -275,6 +430,10 @@ void InputManager::AddMouseButtonEvent(int Button, int State, int Clicks)
 	mEvent.State = State;
 	mEvent.Clicks = Clicks;
 
+	if (_Recorder) {
+		_Recorder->AddEvent(REC_MOUSE_BUTTON, Button, State, Clicks);
+	}
+
 	auto search = MouseButtonEvents.find(Button);
 	if (search != MouseButtonEvents.end()) {
 		MouseButtonEvents.at(Button) = mEvent;
@@ -12,17 +12,28 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <map>
+#include <bitset>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "InputRecorder.h"
+#include "SPSCQueue.h"
 
 ////////////////////////////////////////////////////////////
 /// KeyEvent Struct
 /// --Keycode-- The integer number representing the key.
 /// --State-- The current state of key, eg. Pressed or Released.
 /// --Mod-- The key modifier if applicable, eg.Shift
+/// --Timestamp-- Performance counter time SDL received the event.
+/// --FrameTime-- Where in the frame the event happened, 0 to 1.
 ////////////////////////////////////////////////////////////
 struct KeyEvent {
 	int Keycode;
 	int State;
 	int Mod;
+	uint64_t Timestamp;
+	float FrameTime;
 };
 
 ////////////////////////////////////////////////////////////
@@ -100,28 +111,58 @@ class InputManager
 public:
 	
 
+	////////////////////////////////////////////////////////////
+	/// Hooks the InputManager into SDL, must be called after
+	/// SDL has been initialized.
+	////////////////////////////////////////////////////////////
+	void Initialize();
+
+	////////////////////////////////////////////////////////////
+	/// Unhooks from SDL and closes any recording.
+	////////////////////////////////////////////////////////////
+	void Shutdown();
+
 	////////////////////////////////////////////////////////////
 	/// Updates the InputManager and polls for all events.
 	////////////////////////////////////////////////////////////
 	void Update();
 
 	////////////////////////////////////////////////////////////
-	/// Checks to see if a key has been pressed once.
+	/// Lets SDL collect OS events mid frame. Key events are
+	/// timestamped as they arrive and queued for the next
+	/// Update, so calling this more often gives finer timing.
+	////////////////////////////////////////////////////////////
+	void PumpEvents();
+
+	////////////////////////////////////////////////////////////
+	/// Checks to see if a key went down this frame.
 	/// --Key-- The key to check.
 	////////////////////////////////////////////////////////////
-	bool IsKeyPressed(int Key);
+	bool IsKeyPressed(int Key) const { return _KeysPressed[KeyIndex(Key)]; }
 
 	////////////////////////////////////////////////////////////
-	/// Checks to see if a key has been released.
+	/// Checks to see if a key went up this frame.
 	/// --Key-- The key to check.
 	////////////////////////////////////////////////////////////
-	bool IsKeyReleased(int Key);
+	bool IsKeyReleased(int Key) const { return _KeysReleased[KeyIndex(Key)]; }
 
 	////////////////////////////////////////////////////////////
 	/// Checks to see if a key is being held.
 	/// --Key-- The key to check.
 	////////////////////////////////////////////////////////////
-	bool IsKeyHeld(int Key);
+	bool IsKeyHeld(int Key) const { return _KeysCurrent[KeyIndex(Key)]; }
+
+	////////////////////////////////////////////////////////////
+	/// Checks to see if a key was held when the frame started.
+	/// --Key-- The key to check.
+	////////////////////////////////////////////////////////////
+	bool WasKeyHeld(int Key) const { return _KeysPrevious[KeyIndex(Key)]; }
+
+	////////////////////////////////////////////////////////////
+	/// Gets every key change from this frame in the order they
+	/// happened.
+	////////////////////////////////////////////////////////////
+	const std::vector<KeyEvent>& GetFrameKeyEvents() const { return _FrameKeyEvents; }
 
 	////////////////////////////////////////////////////////////
 	/// Checks to see if a mouse button has been pressed.
@@ -190,6 +231,43 @@ public:
 	void RequestQuit();
 	void ResetMouseEvents();
 
+	////////////////////////////////////////////////////////////
+	/// Starts writing every input event and frame delta to a
+	/// binary log.
+	/// --FilePath-- The file to record to.
+	////////////////////////////////////////////////////////////
+	bool StartRecording(const std::string& FilePath);
+
+	////////////////////////////////////////////////////////////
+	/// Stops recording and closes the log.
+	////////////////////////////////////////////////////////////
+	void StopRecording();
+
+	////////////////////////////////////////////////////////////
+	/// Feeds input from a recorded log instead of SDL. Window
+	/// and quit events still come from SDL.
+	/// --FilePath-- The file to play back.
+	////////////////////////////////////////////////////////////
+	bool StartPlayback(const std::string& FilePath);
+
+	////////////////////////////////////////////////////////////
+	/// Checks to see if input is coming from a recording.
+	////////////////////////////////////////////////////////////
+	bool IsPlayingBack();
+
+	////////////////////////////////////////////////////////////
+	/// Checks to see if a playback has run out of frames.
+	////////////////////////////////////////////////////////////
+	bool HasPlaybackFinished();
+
+	////////////////////////////////////////////////////////////
+	/// Gets the delta to update the game with this frame.
+	/// While recording the delta is written to the log, while
+	/// playing back the recorded delta is returned instead.
+	/// --MeasuredDelta-- The delta measured by the engine timer.
+	////////////////////////////////////////////////////////////
+	float GetFrameDelta(float MeasuredDelta);
+
 	////////////////////////////////////////////////////////////
 	/// Provides access to the only instance of the screen
 	/// manager.
@@ -208,8 +286,22 @@ private:
 	/// --Keycode-- The integer number representing the key.
 	/// --State-- The current state of key, eg. Pressed or Released.
 	/// --Mod-- The key modifier if applicable, eg.Shift
+	/// --FrameTime-- Where in the frame the event happened, 0 to 1.
+	/// --Timestamp-- Performance counter time, 0 for played back events.
+	////////////////////////////////////////////////////////////
+	void AddKeyboardEvent(int Keycode, int State, int Mod, float FrameTime, uint64_t Timestamp = 0);
+
+	////////////////////////////////////////////////////////////
+	/// Moves the queued key events into this frame.
+	/// --Now-- Performance counter time of this update.
 	////////////////////////////////////////////////////////////
-	void AddKeyboardEvent(int Keycode, int State, int Mod);
+	void DrainKeyQueue(uint64_t Now);
+
+	////////////////////////////////////////////////////////////
+	/// SDL event watch, called as SDL receives each event.
+	/// Only pushes key events into the queue.
+	////////////////////////////////////////////////////////////
+	static int KeyEventWatch(void* UserData, union SDL_Event* Event);
 
 	////////////////////////////////////////////////////////////
 	/// Adds a window event to the InputManager
@@ -245,21 +337,53 @@ private:
 	////////////////////////////////////////////////////////////
 	void AddMouseButtonEvent(int Button, int State, int Clicks);
 
+	////////////////////////////////////////////////////////////
+	/// Applies the next recorded frame of input.
+	////////////////////////////////////////////////////////////
+	void PlaybackFrame();
+
 	////////////////////////////////////////////////////////////
 	// Member Data
 	////////////////////////////////////////////////////////////
 	static InputManager _Instance; // Static Instance of InputManager
 
+	////////////////////////////////////////////////////////////
+	/// Maps an SDL keycode to a slot in the key arrays.
+	/// SDL keycodes are either a character, or a scancode with
+	/// bit 30 set, so characters land in 0-511 and every other
+	/// key at its scancode + 512, no lookup. Characters past
+	/// 511 would alias onto another key, so they get
+	/// KEY_IGNORED, a slot that is never set.
+	////////////////////////////////////////////////////////////
+	static const int KEY_IGNORED = 1024;
+	static const int KEY_COUNT = KEY_IGNORED + 1;
+	static int KeyIndex(int Keycode) {
+		return (Keycode & ~(0x1FF | (1 << 30))) == 0 ? (Keycode & 0x1FF) | ((Keycode >> 21) & 0x200) : KEY_IGNORED;
+	}
+
 	bool _CapturedMouse; //Flag to see if Input has captured mouse.
 
-	std::map<int, KeyEvent> KeyboardEvents; // Container of Keyboard Events, accessed with keycodes.
-	std::map<int, bool> KeyPressed;			// Container of is key pressed booleans, accessed with keycodes.
+	std::bitset<KEY_COUNT> _KeysCurrent;	// Keys down now, accessed with KeyIndex.
+	std::bitset<KEY_COUNT> _KeysPrevious;	// Keys down at the end of the last update.
+	std::bitset<KEY_COUNT> _KeysPressed;	// Keys that went down this update.
+	std::bitset<KEY_COUNT> _KeysReleased;	// Keys that went up this update.
+
+	SPSCQueue<KeyEvent, 1024> _KeyQueue;	// Key events from the SDL event watch, waiting for Update.
+	std::vector<KeyEvent> _FrameKeyEvents;	// Key changes applied this update, in order.
+	uint64_t _LastUpdateTime;				// Performance counter time of the last update.
+	bool _KeyQueueFull;						// Set when the queue overflowed, so it only logs once.
 	std::map<int, MouseButtonEvent> MouseButtonEvents; // Container of Mouse Button Events, accessed with button codes.
 	std::map<int, WindowEvent> WindowEvents; // Container of Window Events, accessed with window event ID's.
 
 	MouseScrollEvent MouseScrollEvt;	// Container for mouse scrolling data.
 	MouseMoveEvent MouseMoveEvt;		// Container for mouse movement data.
 
+	InputRecorder* _Recorder;			// Writes input to a log while recording, otherwise null.
+	InputPlayback* _Playback;			// Feeds input from a log while playing back, otherwise null.
+	std::vector<RecordedEvent> _PlaybackEvents; // Events for the current playback frame.
+	float _PlaybackDelta;				// Delta for the current playback frame.
+	bool _PlaybackFinished;				// Set once the playback runs out of frames.
+
 };
 
 #endif
@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "InputRecorder.h"
+#include "LogManager.h"
+
+#include <cstring>
+#include <iterator>
+
+////////////////////////////////////////////////////////////
+// File Layout
+// header: 'I','N','R','C', uint32 version
+// frame:  float delta, uint16 event count, events
+// event:  uint8 type, 4 x int32 data
+// version 2 keeps the time into the frame a key changed in
+// the last keyboard value, as a fraction of 65535.
+////////////////////////////////////////////////////////////
+static const char RECORD_MAGIC[4] = { 'I', 'N', 'R', 'C' };
+static const uint32_t RECORD_VERSION = 2;
+
+////////////////////////////////////////////////////////////
+InputRecorder::InputRecorder() : _FrameCount(0) {}
+
+////////////////////////////////////////////////////////////
+InputRecorder::~InputRecorder()
+{
+	Close();
+}
+
+////////////////////////////////////////////////////////////
+bool InputRecorder::Open(const std::string & FilePath)
+{
+	Close();
+	_File.open(FilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!_File.is_open()) {
+		LogManager::Instance()->LogError("Could not open input recording: " + FilePath);
+		return false;
+	}
+	_File.write(RECORD_MAGIC, sizeof(RECORD_MAGIC));
+	_File.write((const char*)&RECORD_VERSION, sizeof(RECORD_VERSION));
+	_FrameEvents.clear();
+	_FrameCount = 0;
+	LogManager::Instance()->LogInfo("Recording input to " + FilePath);
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+void InputRecorder::Close()
+{
+	if (_File.is_open()) {
+		_File.close();
+		LogManager::Instance()->LogInfo("Input recording closed after " + std::to_string(_FrameCount) + " frames.");
+	}
+}
+
+////////////////////////////////////////////////////////////
+void InputRecorder::AddEvent(uint8_t Type, int32_t A, int32_t B, int32_t C, int32_t D)
+{
+	RecordedEvent rEvent;
+	rEvent.Type = Type;
+	rEvent.Data[0] = A;
+	rEvent.Data[1] = B;
+	rEvent.Data[2] = C;
+	rEvent.Data[3] = D;
+	_FrameEvents.push_back(rEvent);
+}
+
+////////////////////////////////////////////////////////////
+void InputRecorder::EndFrame(float Delta)
+{
+	if (!_File.is_open()) {
+		return;
+	}
+	uint16_t count = (uint16_t)_FrameEvents.size();
+	_File.write((const char*)&Delta, sizeof(Delta));
+	_File.write((const char*)&count, sizeof(count));
+	for (uint16_t i = 0; i < count; i++) {
+		_File.write((const char*)&_FrameEvents[i].Type, sizeof(uint8_t));
+		_File.write((const char*)_FrameEvents[i].Data, sizeof(_FrameEvents[i].Data));
+	}
+	_FrameEvents.clear();
+	_FrameCount++;
+}
+
+////////////////////////////////////////////////////////////
+InputPlayback::InputPlayback() : _ReadPosition(0), _Frame(0) {}
+
+////////////////////////////////////////////////////////////
+InputPlayback::~InputPlayback() {}
+
+////////////////////////////////////////////////////////////
+bool InputPlayback::Open(const std::string & FilePath)
+{
+	std::ifstream file(FilePath, std::ios::in | std::ios::binary);
+	if (!file.is_open()) {
+		LogManager::Instance()->LogError("Could not open input playback: " + FilePath);
+		return false;
+	}
+	_Data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	_ReadPosition = 0;
+	_Frame = 0;
+
+	char magic[4];
+	uint32_t version;
+	if (!Read(magic, sizeof(magic)) || memcmp(magic, RECORD_MAGIC, sizeof(magic)) != 0 ||
+		!Read(&version, sizeof(version)) || version > RECORD_VERSION) {
+		LogManager::Instance()->LogError("Not a valid input recording: " + FilePath);
+		_Data.clear();
+		_ReadPosition = 0;
+		return false;
+	}
+	//older recordings have no key timing, so they would replay with every key at the wrong time.
+	if (version != RECORD_VERSION) {
+		LogManager::Instance()->LogError("Input recording " + FilePath + " is version " + std::to_string(version) +
+			", re-record it with this build (version " + std::to_string(RECORD_VERSION) + ").");
+		_Data.clear();
+		_ReadPosition = 0;
+		return false;
+	}
+	LogManager::Instance()->LogInfo("Playing back input from " + FilePath);
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+bool InputPlayback::NextFrame(float & Delta, std::vector<RecordedEvent>& Events)
+{
+	Events.clear();
+	uint16_t count;
+	if (!Read(&Delta, sizeof(Delta)) || !Read(&count, sizeof(count))) {
+		_ReadPosition = _Data.size();
+		return false;
+	}
+	for (uint16_t i = 0; i < count; i++) {
+		RecordedEvent rEvent;
+		if (!Read(&rEvent.Type, sizeof(uint8_t)) || !Read(rEvent.Data, sizeof(rEvent.Data))) {
+			LogManager::Instance()->LogWarning("Input recording is truncated at frame " + std::to_string(_Frame));
+			_ReadPosition = _Data.size();
+			return false;
+		}
+		Events.push_back(rEvent);
+	}
+	_Frame++;
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+bool InputPlayback::Read(void * Destination, size_t Size)
+{
+	if (_ReadPosition + Size > _Data.size()) {
+		return false;
+	}
+	memcpy(Destination, &_Data[_ReadPosition], Size);
+	_ReadPosition += Size;
+	return true;
+}
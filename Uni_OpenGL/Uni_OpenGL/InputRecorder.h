@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////
+//
+// Input Recorder
+//
+////////////////////////////////////////////////////////////
+#ifndef INPUT_RECORDER_H
+#define INPUT_RECORDER_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////
+/// The InputManager event a RecordedEvent replays.
+////////////////////////////////////////////////////////////
+enum RecordedEventType : uint8_t {
+	REC_KEYBOARD = 0,
+	REC_MOUSE_BUTTON,
+	REC_MOUSE_MOVE,
+	REC_MOUSE_SCROLL
+};
+
+////////////////////////////////////////////////////////////
+/// RecordedEvent Struct
+/// --Type-- Which InputManager event this is, see RecordedEventType.
+/// --Data-- The values passed to the matching InputManager Add function.
+////////////////////////////////////////////////////////////
+struct RecordedEvent {
+	uint8_t Type;
+	int32_t Data[4];
+};
+
+////////////////////////////////////////////////////////////
+/// Writes input to a binary log.
+/// --Each frame is its delta followed by the input events
+/// --received that frame. Only changes are stored so idle
+/// --frames are a few bytes.
+////////////////////////////////////////////////////////////
+class InputRecorder
+{
+public:
+	InputRecorder();
+	~InputRecorder();
+
+	////////////////////////////////////////////////////////////
+	/// Opens the log for writing and writes the header.
+	/// --FilePath-- The file to record to.
+	////////////////////////////////////////////////////////////
+	bool Open(const std::string& FilePath);
+
+	////////////////////////////////////////////////////////////
+	/// Closes the log.
+	////////////////////////////////////////////////////////////
+	void Close();
+
+	bool IsOpen() { return _File.is_open(); }
+
+	////////////////////////////////////////////////////////////
+	/// Adds an event to the current frame.
+	////////////////////////////////////////////////////////////
+	void AddEvent(uint8_t Type, int32_t A, int32_t B, int32_t C = 0, int32_t D = 0);
+
+	////////////////////////////////////////////////////////////
+	/// Writes the current frame to the log.
+	/// --Delta-- The frame delta the game was updated with.
+	////////////////////////////////////////////////////////////
+	void EndFrame(float Delta);
+
+private:
+	std::ofstream _File;
+	std::vector<RecordedEvent> _FrameEvents;
+	uint32_t _FrameCount;
+};
+
+////////////////////////////////////////////////////////////
+/// Reads back a log written by InputRecorder.
+/// --The whole file is read up front so disk access does
+/// --not show up in benchmark timings.
+////////////////////////////////////////////////////////////
+class InputPlayback
+{
+public:
+	InputPlayback();
+	~InputPlayback();
+
+	////////////////////////////////////////////////////////////
+	/// Loads a log.
+	/// --FilePath-- The file to play back.
+	////////////////////////////////////////////////////////////
+	bool Open(const std::string& FilePath);
+
+	////////////////////////////////////////////////////////////
+	/// Reads the next frame.
+	/// --Delta-- Filled with the recorded frame delta.
+	/// --Events-- Filled with the recorded events.
+	/// Returns false once there are no frames left.
+	////////////////////////////////////////////////////////////
+	bool NextFrame(float& Delta, std::vector<RecordedEvent>& Events);
+
+	bool IsFinished() { return _ReadPosition >= _Data.size(); }
+	uint32_t GetFrame() { return _Frame; }
+
+private:
+	std::vector<char> _Data;
+	size_t _ReadPosition;
+	uint32_t _Frame;
+
+	bool Read(void* Destination, size_t Size);
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "InstanceBatch.h"
+#include "Model.h"
+#include "ShaderManager.h"
+
+InstanceBatch::InstanceBatch(Model* model, const std::string& shader, const std::string& depthShader) :
+	_Model(model),
+	_Shader(shader),
+	_DepthShader(depthShader)
+{
+	_InstanceBuffer.Create(VBO);
+	unsigned int program = ShaderManager::Instance()->GetShader(_Shader)->GetID();
+	unsigned int depthProgram = ShaderManager::Instance()->GetShader(_DepthShader)->GetID();
+	for (auto& mesh : _Model->GetMeshes()) {
+		mesh.AttachInstanceBuffer(_InstanceBuffer, program, depthProgram);
+	}
+}
+
+InstanceBatch::~InstanceBatch()
+{
+	_InstanceBuffer.Destroy();
+}
+
+void InstanceBatch::DrawDepth()
+{
+	if (_Instances.empty()) {
+		return;
+	}
+	for (auto& mesh : _Model->GetMeshes()) {
+		mesh.DrawDepthInstanced((int)_Instances.size());
+	}
+}
+
+void InstanceBatch::Upload()
+{
+	if (_Instances.empty()) {
+		return;
+	}
+	//re-specifying the whole buffer lets the driver hand back fresh storage
+	//instead of waiting on last frames draws.
+	_InstanceBuffer.Fill((int)(sizeof(glm::mat4) * _Instances.size()), &_Instances[0], STREAM);
+}
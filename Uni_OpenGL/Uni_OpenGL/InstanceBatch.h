@@ -0,0 +1,52 @@
+#pragma once
+
+#include <GLM\glm.hpp>
+#include <string>
+#include <vector>
+
+#include "Buffer.h"
+
+class Model;
+
+////////////////////////////////////////////////////////////
+/// Draws many copies of one model with a draw per mesh.
+/// --The world matrix of every instance is streamed into a
+/// --buffer each frame and read as a vertex attribute by an
+/// --instanced shader (aInstanceModel). The models vertex
+/// --arrays are shared with the non instanced path, so the
+/// --instanced shader has to use the same attribute
+/// --locations as the models own shader.
+////////////////////////////////////////////////////////////
+class InstanceBatch
+{
+public:
+	InstanceBatch(Model* model, const std::string& shader, const std::string& depthShader);
+	~InstanceBatch();
+
+	void Clear() { _Instances.clear(); }
+	void Add(const glm::mat4& world) { _Instances.push_back(world); }
+
+	////////////////////////////////////////////////////////////
+	/// Streams this frames matrices to the gpu, must be called
+	/// --after the last Add and before the batch is drawn.
+	////////////////////////////////////////////////////////////
+	void Upload();
+
+	////////////////////////////////////////////////////////////
+	/// Draws the uploaded instances positions only, with the
+	/// --depth shader already bound.
+	////////////////////////////////////////////////////////////
+	void DrawDepth();
+
+	Model* GetModel() { return _Model; }
+	const std::string& GetShader() { return _Shader; }
+	int GetCount() { return (int)_Instances.size(); }
+
+private:
+	Model* _Model;
+	std::string _Shader;
+	std::string _DepthShader;
+
+	Buffer _InstanceBuffer;
+	std::vector<glm::mat4> _Instances;
+};
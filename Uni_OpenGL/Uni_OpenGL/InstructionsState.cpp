@@ -67,17 +67,17 @@ void InstructionsState::Render()
 
 	glm::mat4 model = glm::mat4(1.0f);
 	model = glm::rotate(model, _SkyboxSpinAngle, glm::vec3(0, 1, 0));
-	ShaderManager::Instance()->GetShader("skybox")->UpdateMatrices(model, _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
+	ShaderManager::Instance()->BindShader(SHADER_ID("skybox"))->UpdateMatrices(model, _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
 	_SceneSky->Render();
 
 	//~~~~~~~ALL 2D RENDERING~~~~~~//
 	ScreenManager::Instance()->Set2D();
 
 	model = glm::mat4(1.0f);
-	ShaderManager::Instance()->GetShader("texture")->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
+	ShaderManager::Instance()->BindShader(SHADER_ID("texture"))->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
 	for (auto b : _MenuButtons) {
 		b->Render();
-		ShaderManager::Instance()->GetShader("texture")->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
+		ShaderManager::Instance()->BindShader(SHADER_ID("texture"))->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
 		glm::vec2 pos = b->GetPosition();
 		_TextRenderer->RenderText(b->GetButtonText(), glm::vec2(pos.x + 6, pos.y + 10), 1);
 	}
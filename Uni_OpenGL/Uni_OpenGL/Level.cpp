@@ -2,7 +2,10 @@
 #include "MathUtil.h"
 #include "Model.h"
 #include "BModel.h"
+#include "InstanceBatch.h"
+#include "RenderQueue.h"
 #include "PRNG.h"
+#include "Profiler.h"
 
 #include "ShaderManager.h"
 
@@ -31,6 +34,9 @@ Level::~Level()
 	for (auto t : _TriggerGates) {
 		delete t;
 	}
+	for (auto b : _FoliageBatches) {
+		delete b;
+	}
 }
 
 void Level::CreateLevel()
@@ -127,8 +133,18 @@ void Level::CreateLevel()
 		glm::vec3 pos = glm::vec3(tempPos.x * _LevelTerrain->GetVertexSpacing(), _LevelTerrain->GetHeight((int)tempPos.x, (int)tempPos.y) + 0.1f, tempPos.y * _LevelTerrain->GetVertexSpacing());
 		pos -= glm::vec3(_LevelTerrain->GetSize() * 0.5f, 0, _LevelTerrain->GetSize() * 0.5f);
 		//use the new position and get a random model for the foliage.
-		BModel* model = new BModel(pos, glm::vec3(0, 1, 0), 50.0f, _FoliageModelList[(int)_ModelChooser.GetNumberF()], "betterLight");
+		//foliage is rooted to the ground so it is static, and kept in the prop group
+		//so it never pairs with the terrain, the trigger gates or other foliage.
+		int modelIndex = (int)_ModelChooser.GetNumberF();
+		BModel* model = new BModel(pos, glm::vec3(0, 1, 0), FOLIAGE_MASS, _FoliageModelList[modelIndex], "betterLight");
+		model->SetCollisionFilter(COL_PROP, COL_MASK_PROP);
 		_FoliageBModelList.push_back(model);
+		_FoliageModelIndex.push_back(modelIndex);
+	}
+
+	//every copy of a foliage model is drawn together.
+	for (auto m : _FoliageModelList) {
+		_FoliageBatches.push_back(new InstanceBatch(m, "betterLightInstanced", "shadowInstanced"));
 	}
 }
 
@@ -144,10 +160,15 @@ void Level::Initialize(btDynamicsWorld* world, std::set<btCollisionShape*>* coll
 		//initialize each trigger volume.
 		t->Initialize(world, collisionShapes);
 		t->SetDirection(t->GetTrackDirection());
+		//the gate has been rotated so refresh its aabb once, then let it sleep.
+		world->updateSingleAabb(t->GetRigidBody());
+		t->Sleep();
 	}
 	for (auto f : _FoliageBModelList) {
 		//initialize each piece of foliage.
 		f->Initialize(world, collisionShapes);
+		//all foliage starts asleep until something hits it.
+		f->Sleep();
 	}
 }
 
@@ -193,23 +214,77 @@ int Level::GetNearestTrackPoint(glm::vec3 from)
 
 void Level::Render(std::string shader)
 {
+	PROFILE_SCOPE("Level::Render");
 	//render the level
 	_LevelTerrain->Render(shader);
 	//this can be uncommented to show the track spline.
 	//_LevelTrackSmoother->AddToBuffer();
 	//_LevelTrackSmoother->Render();
 	for (auto f : _FoliageBModelList) {
-		if (shader == "") {
-			ShaderManager::Instance()->GetShader(f->GetShader())->SetMat4("model", f->GetModelMatrix());
-		}
-		else {
-			ShaderManager::Instance()->GetShader("shadow")->SetMat4("model", f->GetModelMatrix());
-		}
+		ShaderManager::Instance()->BindShader(f->GetShader())->SetMat4("model", f->GetModelMatrix());
 		f->Render(shader);
 	}
 }
 
+void Level::Submit(RenderQueue* queue, const Frustum& frustum, CullStats& stats)
+{
+	PROFILE_SCOPE("Level::Submit");
+	if (_FoliageBounds.Size() != (int)_FoliageBModelList.size()) {
+		UpdateFoliageBounds();
+	}
+	frustum.CullBoxes(_FoliageBounds, _FoliageVisible, stats);
+	FillFoliageBatches();
+	for (auto b : _FoliageBatches) {
+		queue->Submit(b);
+	}
+}
+
+void Level::RenderShadowCasters(const Frustum& frustum)
+{
+	PROFILE_SCOPE("Level::RenderShadowCasters");
+	CullStats stats;
+	if (_FoliageBounds.Size() != (int)_FoliageBModelList.size()) {
+		UpdateFoliageBounds();
+	}
+	frustum.CullBoxes(_FoliageBounds, _FoliageVisible, stats);
+	FillFoliageBatches();
+	ShaderManager::Instance()->BindShader(SHADER_ID("shadowInstanced"));
+	for (auto b : _FoliageBatches) {
+		b->DrawDepth();
+	}
+}
+
+void Level::UpdateFoliageBounds()
+{
+	//foliage doesnt rotate much so boxes fit tighter than spheres.
+	_FoliageBounds.Clear();
+	for (auto f : _FoliageBModelList) {
+		glm::vec3 center, extents;
+		f->GetWorldBox(center, extents);
+		_FoliageBounds.AddBox(center, extents);
+	}
+}
+
+void Level::FillFoliageBatches()
+{
+	for (auto b : _FoliageBatches) {
+		b->Clear();
+	}
+	for (int i = 0; i < (int)_FoliageBModelList.size(); i++) {
+		if (_FoliageVisible[i]) {
+			_FoliageBatches[_FoliageModelIndex[i]]->Add(_FoliageBModelList[i]->GetModelMatrix());
+		}
+	}
+	//each upload re-specifies the buffer, so a cascade can reuse it while the last one is still drawing.
+	for (auto b : _FoliageBatches) {
+		b->Upload();
+	}
+}
+
 void Level::Update(float delta)
 {
+	PROFILE_SCOPE("Level::Update");
 	_LapTimer->Update();
+	//the shadow cascades and the main pass all cull against these.
+	UpdateFoliageBounds();
 }
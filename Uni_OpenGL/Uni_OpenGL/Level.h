@@ -10,10 +10,13 @@
 #include "BTriggerVolume.h"
 #include "TrackGenerator.h"
 #include "CatmullRomSpline.h"
+#include "Frustum.h"
 
 class Texture;
 class Model;
 class BModel;
+class RenderQueue;
+class InstanceBatch;
 
 class Level
 {
@@ -33,15 +36,24 @@ public:
 	float GetCurrentLapTime() { return _LapTimer->GetElapsedTime(); }
 	float GetBestLapTime();
 	BTriggerVolume* GetNextTriggerGate() { return _TriggerGates.front(); }
+	const std::deque<BTriggerVolume*>& GetTriggerGates() const { return _TriggerGates; }
 
 	int GetNearestTrackPoint(glm::vec3 from);
 
 	void Render(std::string shader = "");
+	//queues the foliage inside the frustum as one instanced draw per model.
+	//the terrain is drawn by the owning state.
+	void Submit(RenderQueue* queue, const Frustum& frustum, CullStats& stats);
+	//draws the foliage inside a shadow cascade into the bound shadow map.
+	void RenderShadowCasters(const Frustum& frustum);
 	void Update(float delta);
 
 	StopWatch* GetStopWatch() { return _LapTimer; }
 
 private:
+	//mass of 0 makes the foliage static.
+	const float FOLIAGE_MASS = 0.0f;
+
 	int _Seed;
 
 	StopWatch* _LapTimer;
@@ -57,6 +69,14 @@ private:
 
 	std::vector<Model*> _FoliageModelList;
 	std::vector<BModel*> _FoliageBModelList;
+	//which foliage model each foliage object uses, and an instance batch per model.
+	std::vector<int> _FoliageModelIndex;
+	std::vector<InstanceBatch*> _FoliageBatches;
+	BoundsList _FoliageBounds;
+	std::vector<unsigned char> _FoliageVisible;
+	void UpdateFoliageBounds();
+	//fills the instance batches with the foliage marked in _FoliageVisible and uploads them.
+	void FillFoliageBatches();
 
 };
 
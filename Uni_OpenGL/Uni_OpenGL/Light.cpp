@@ -1,5 +1,8 @@
 #include "Light.h"
-#include "ShaderManager.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 
 DirectionalLight::DirectionalLight()
@@ -39,14 +42,12 @@ void DirectionalLight::SetSpecular(glm::vec3 color)
 	_Specular = color;
 }
 
-void DirectionalLight::SendToShader(std::string shader)
+void DirectionalLight::Fill(DirLightBlock& block) const
 {
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("dirLight.direction", _Direction);
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("dirLight.ambient", _Ambient);
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("dirLight.diffuse", _Diffuse);
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("dirLight.specular", _Specular);
-
-	ShaderManager::Instance()->GetShader(shader)->SetInt("hasDirLight", 1);
+	block.Direction = _Direction;
+	block.Ambient = _Ambient;
+	block.Diffuse = _Diffuse;
+	block.Specular = _Specular;
 }
 
 PointLight::PointLight()
@@ -103,17 +104,32 @@ void PointLight::SetQuadratic(float value)
 	_Quadratic = value;
 }
 
-void PointLight::SendToShader(int pointNum, std::string shader)
-{
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("pointLights[" + std::to_string(pointNum) + "].position", _Position);
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("pointLights[" + std::to_string(pointNum) + "].ambient", _Ambient);
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("pointLights[" + std::to_string(pointNum) + "].diffuse", _Diffuse);
-	ShaderManager::Instance()->GetShader(shader)->SetVec3("pointLights[" + std::to_string(pointNum) + "].specular", _Specular);
-
-	ShaderManager::Instance()->GetShader(shader)->SetFloat("pointLights[" + std::to_string(pointNum) + "].constant", _Constant);
-	ShaderManager::Instance()->GetShader(shader)->SetFloat("pointLights[" + std::to_string(pointNum) + "].linear", _Linear);
-	ShaderManager::Instance()->GetShader(shader)->SetFloat("pointLights[" + std::to_string(pointNum) + "].quadratic", _Quadratic);
-
-	ShaderManager::Instance()->GetShader(shader)->SetInt("hasPointLight", 1);
-	ShaderManager::Instance()->GetShader(shader)->SetInt("numPointLight", pointNum + 1);
+void PointLight::Fill(PointLightBlock& block) const
+{
+	block.Position = _Position;
+	block.Ambient = _Ambient;
+	block.Diffuse = _Diffuse;
+	block.Specular = _Specular;
+	block.Constant = _Constant;
+	block.Linear = _Linear;
+	block.Quadratic = _Quadratic;
+}
+
+float PointLight::GetRange() const
+{
+	//solve constant + linear * d + quadratic * d^2 = brightest / (1 / 256) for d.
+	glm::vec3 total = _Ambient + _Diffuse + _Specular;
+	float brightest = std::max(total.x, std::max(total.y, total.z));
+	float c = _Constant - brightest * 256.0f;
+	if (c >= 0.0f) {
+		return 0.0f;
+	}
+	if (_Quadratic > 0.0f) {
+		return (-_Linear + std::sqrt(_Linear * _Linear - 4.0f * _Quadratic * c)) / (2.0f * _Quadratic);
+	}
+	if (_Linear > 0.0f) {
+		return std::max(-c / _Linear, 0.0f);
+	}
+	//never fades, cover everything.
+	return FLT_MAX;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "FrameUniforms.h"
+
 #include <GLM\glm.hpp>
 #include <string>
 
@@ -15,7 +17,10 @@ public:
 	void SetDiffuse(glm::vec3 color);
 	void SetSpecular(glm::vec3 color);
 
-	void SendToShader(std::string shader);
+	glm::vec3 GetDirection() { return _Direction; }
+
+	//writes the light into the per frame uniform block.
+	void Fill(DirLightBlock& block) const;
 
 private:
 	glm::vec3	_Ambient;
@@ -40,7 +45,10 @@ public:
 	void SetLinear(float value);
 	void SetQuadratic(float value);
 
-	void SendToShader(int pointNum, std::string shader);
+	void Fill(PointLightBlock& block) const;
+
+	//distance where the light falls below one 8 bit step, anything further is left unlit.
+	float GetRange() const;
 
 private:
 	glm::vec3	_Ambient;
@@ -27,13 +27,21 @@ LoadState::~LoadState()
 
 bool LoadState::Initialize()
 {
+	//programs built on an earlier run load from here instead of compiling.
+	ShaderManager::Instance()->UseProgramCache("Data/shaders.cache");
     ShaderManager::Instance()->AddShader("basic", "basic");
     ShaderManager::Instance()->AddShader("debug", "debug");
     ShaderManager::Instance()->AddShader("skybox", "skybox");
-    ShaderManager::Instance()->AddShader("betterLight", "betterLight");
+    //lit shaders are compiled per light setup and toon option, on first use.
+    ShaderManager::Instance()->AddPermutations("betterLight", "betterLight", "betterLight");
+    ShaderManager::Instance()->AddPermutations("betterLightInstanced", "betterLightInstanced", "betterLight");
 	ShaderManager::Instance()->AddShader("texture", "texture");
-    ShaderManager::Instance()->AddShader("terrain", "terrain");
-	ShaderManager::Instance()->AddShader("shadow", "shadow");
+    ShaderManager::Instance()->AddPermutations("terrain", "terrain", "terrain");
+	ShaderManager::Instance()->AddShader("shadow", "shadow", "depth");
+	ShaderManager::Instance()->AddShader("shadowInstanced", "shadowInstanced", "depth");
+	ShaderManager::Instance()->AddShader("depth", "depth");
+	ShaderManager::Instance()->AddShader("depthInstanced", "depthInstanced", "depth");
+	ShaderManager::Instance()->FinishLoading();
 
 	if (!StateManager::Instance()->AddState("[STATE]Menu", new MenuState())) {
 		return false;
@@ -100,10 +108,7 @@ void LoadState::Update(float delta)
 {
 	std::map<std::string, int>* options = ResourceManager::Instance()->GetOptions();
 	if (options->find("ToonShading") != options->end()) {
-		if (options->at("ToonShading") == 1) {
-			ShaderManager::Instance()->GetShader("terrain")->SetBool("toonShadingOn", true);
-			ShaderManager::Instance()->GetShader("betterLight")->SetBool("toonShadingOn", true);
-		}
+		ShaderManager::Instance()->SetFeature(FEATURE_TOON_SHADING, options->at("ToonShading") == 1);
 	}
 
 	_HasFinishedLoading = true;
@@ -1,5 +1,6 @@
 #include "Mesh.h"
 #include "ShaderManager.h"
+#include "RenderState.h"
 
 
 
@@ -11,6 +12,28 @@ Mesh::Mesh(std::vector<ComplexVertex> vertices, std::vector<unsigned int> indice
 
     _Shader = shader;
 	_Shininess = 8;
+	_UniformShader = nullptr;
+	_UniformShaderVersion = 0;
+
+    //work out the sampler each texture goes to, the N in material.texture_diffuseN.
+    unsigned int diffuseNr = 1;
+    unsigned int specularNr = 1;
+    unsigned int normalNr = 1;
+    unsigned int heightNr = 1;
+    for (unsigned int i = 0; i < _Textures.size(); i++) {
+        std::string number;
+        std::string name = _Textures[i]._Type;
+        if (name == "texture_diffuse")
+            number = std::to_string(diffuseNr++);
+        else if (name == "texture_specular")
+            number = std::to_string(specularNr++);
+        else if (name == "texture_normal")
+            number = std::to_string(normalNr++);
+        else if (name == "texture_height")
+            number = std::to_string(heightNr++);
+        _SamplerNames.push_back("material." + name + number);
+    }
+    UpdateMaterialID();
 
     _VertexArray.Create(VAO);
     _VertexBuffer.Create(VBO);
@@ -28,53 +51,112 @@ Mesh::Mesh(std::vector<ComplexVertex> vertices, std::vector<unsigned int> indice
     _ElementBuffer.Fill(sizeof(unsigned int) * _Indices.size(), &_Indices[0], STATIC);
 
     _VertexArray.Unbind();
+
+    //the depth pass only needs positions, so it reads a tightly packed copy
+    //instead of striding over the full 56 byte vertex.
+    std::vector<glm::vec3> positions;
+    positions.reserve(_Vertices.size());
+    for (auto& v : _Vertices) {
+        positions.push_back(v._Position);
+    }
+    _DepthVertexArray.Create(VAO);
+    _PositionBuffer.Create(VBO);
+
+    _DepthVertexArray.Bind();
+    _PositionBuffer.Fill(sizeof(glm::vec3) * positions.size(), &positions[0], STATIC);
+    _PositionBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("shadow"))->GetID(), "aPos", 3, VT_FLOAT, sizeof(glm::vec3));
+    _ElementBuffer.Bind();
+    _DepthVertexArray.Unbind();
 }
 
-void Mesh::Render(std::string shader)
+void Mesh::Render()
 {
-	//was trying to implement shadows but ran out of time so this if block is not used.
-	if (shader != "") {
-		_VertexArray.Bind();
-		_VertexBuffer.Bind();
-		_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aPos", 3, VT_FLOAT, sizeof(ComplexVertex));
-		_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aNormal", 3, VT_FLOAT, sizeof(ComplexVertex), 3 * sizeof(float));
-		_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aTexCoords", 2, VT_FLOAT, sizeof(ComplexVertex), 6 * sizeof(float));
-		_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aTangent", 3, VT_FLOAT, sizeof(ComplexVertex), 8 * sizeof(float));
-		_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aBiTangent", 3, VT_FLOAT, sizeof(ComplexVertex), 11 * sizeof(float));
-
-	}
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
-    unsigned int normalNr = 1;
-    unsigned int heightNr = 1;
-    for (unsigned int i = 0; i < _Textures.size(); i++)
-    {
-        glActiveTexture(GL_TEXTURE0 + i); // activate proper texture unit before binding
-                                          // retrieve texture number (the N in diffuse_textureN)
-        std::string number;
-        std::string name = _Textures[i]._Type;
-        if (name == "texture_diffuse")
-            number = std::to_string(diffuseNr++);
-        else if (name == "texture_specular")
-            number = std::to_string(specularNr++);
-        else if (name == "texture_normal")
-            number = std::to_string(normalNr++);
-        else if (name == "texture_height")
-            number = std::to_string(heightNr++);
+	//shadow casting goes through DrawDepth, so the mesh always renders with its own shader.
+    BindMaterial(ShaderManager::Instance()->BindShader(_Shader));
+    Draw();
+    _VertexArray.Unbind();
+}
 
-        ShaderManager::Instance()->GetShader(_Shader)->SetInt(("material." + name + number).c_str(), (int)i);
-		ShaderManager::Instance()->GetShader(_Shader)->SetFloat("material.shininess", _Shininess);
-        glBindTexture(GL_TEXTURE_2D, _Textures[i]._ID);
+void Mesh::BindMaterial(Shader* shader)
+{
+    if (_UniformShader != shader || _UniformShaderVersion != shader->GetVersion()) {
+        _SamplerUniforms.clear();
+        for (auto& name : _SamplerNames) {
+            _SamplerUniforms.push_back(shader->GetUniform(name));
+        }
+        _ShininessUniform = shader->GetUniform("material.shininess");
+        _UniformShader = shader;
+        _UniformShaderVersion = shader->GetVersion();
+    }
+    for (unsigned int i = 0; i < _Textures.size(); i++) {
+        shader->SetInt(_SamplerUniforms[i], (int)i);
+        RenderState::Instance()->BindTexture(i, _Textures[i]._ID);
     }
+    shader->SetFloat(_ShininessUniform, _Shininess);
+}
+
+void Mesh::Draw()
+{
+    _VertexArray.Bind();
+    RenderState::Instance()->DrawElements(GL_TRIANGLES, _Indices.size());
+}
 
+void Mesh::DrawInstanced(int count)
+{
     _VertexArray.Bind();
-    glDrawElements(GL_TRIANGLES, _Indices.size(), GL_UNSIGNED_INT, 0);
-    _VertexArray.Unbind();
+    RenderState::Instance()->DrawElementsInstanced(GL_TRIANGLES, _Indices.size(), count);
+}
+
+void Mesh::DrawDepth()
+{
+    _DepthVertexArray.Bind();
+    RenderState::Instance()->DrawElements(GL_TRIANGLES, _Indices.size());
+}
+
+void Mesh::DrawDepthInstanced(int count)
+{
+    _DepthVertexArray.Bind();
+    RenderState::Instance()->DrawElementsInstanced(GL_TRIANGLES, _Indices.size(), count);
+}
+
+void Mesh::AttachInstanceBuffer(Buffer& instanceBuffer, unsigned int shaderID, unsigned int depthShaderID)
+{
+    _VertexArray.Bind();
+    instanceBuffer.Bind();
+    instanceBuffer.AddInstancedMatrixPointer(shaderID, "aInstanceModel");
+
+    _DepthVertexArray.Bind();
+    instanceBuffer.Bind();
+    instanceBuffer.AddInstancedMatrixPointer(depthShaderID, "aInstanceModel");
+    _DepthVertexArray.Unbind();
+}
 
-    glActiveTexture(GL_TEXTURE0);
+bool Mesh::SameMaterial(const Mesh& other) const
+{
+    if (_MaterialID != other._MaterialID || _Shininess != other._Shininess || _Textures.size() != other._Textures.size()) {
+        return false;
+    }
+    for (unsigned int i = 0; i < _Textures.size(); i++) {
+        if (_Textures[i]._ID != other._Textures[i]._ID || _SamplerNames[i] != other._SamplerNames[i]) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void Mesh::SetShininess(float value)
 {
 	_Shininess = value;
+	UpdateMaterialID();
+}
+
+void Mesh::UpdateMaterialID()
+{
+	//fnv-1a over the texture names and shininess.
+	unsigned int hash = 2166136261u;
+	for (auto& t : _Textures) {
+		hash = (hash ^ t._ID) * 16777619u;
+	}
+	hash = (hash ^ (unsigned int)(_Shininess * 16.0f)) * 16777619u;
+	_MaterialID = hash;
 }
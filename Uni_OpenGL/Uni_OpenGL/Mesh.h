@@ -5,6 +5,8 @@
 #include <vector>
 
 #include "Buffer.h"
+#include "ShaderID.h"
+#include "Shaders\Shader.h"
 
 struct ComplexVertex {
     glm::vec3 _Position;
@@ -34,21 +36,54 @@ public:
 
 	friend class Model;
 
-    void Render(std::string shader = "");
+    void Render();
+
+	//binds the textures and material uniforms, the shader must already be in use.
+	void BindMaterial(Shader* shader);
+	//draws with whatever material is bound and leaves the vertex array bound.
+	void Draw();
+	void DrawInstanced(int count);
+
+	//position only draws for the shadow depth pass.
+	void DrawDepth();
+	void DrawDepthInstanced(int count);
+
+	//adds a per instance model matrix read from the buffer to the colour and depth vertex arrays.
+	void AttachInstanceBuffer(Buffer& instanceBuffer, unsigned int shaderID, unsigned int depthShaderID);
+
+	//used to group draws in the render queue, equal materials share an id.
+	unsigned int GetMaterialID() const { return _MaterialID; }
+	bool SameMaterial(const Mesh& other) const;
+
+	ShaderID GetShader() const { return _Shader; }
 
 protected:
 	void SetShininess(float value);
 
 private:
+	void UpdateMaterialID();
+
     Buffer _VertexArray;
     Buffer _VertexBuffer;
     Buffer _ElementBuffer;
 
+    Buffer _DepthVertexArray;
+    Buffer _PositionBuffer;
+
     std::vector<ComplexVertex> _Vertices;
     std::vector<unsigned int> _Indices;
     std::vector<MeshTexture> _Textures;
 
-    std::string _Shader;
+    ShaderID _Shader;
 	float _Shininess;
+
+	//sampler uniform name for each texture, built once instead of every draw.
+	std::vector<std::string> _SamplerNames;
+	//the same uniforms resolved for the last shader the material was bound with.
+	const Shader* _UniformShader;
+	unsigned int _UniformShaderVersion;	// A hot reloaded program hands out new handles.
+	std::vector<UniformHandle> _SamplerUniforms;
+	UniformHandle _ShininessUniform;
+	unsigned int _MaterialID;
 };
 
@@ -1,6 +1,7 @@
 #include "Model.h"
 #include "LogManager.h"
 #include "Texture.h"
+#include "RenderState.h"
 #include <SDL\SDL_image.h>
 #include <GLEW\glew.h>
 
@@ -8,17 +9,26 @@ Model::Model(std::string FileName, std::string shader)
 {
     _Shader = shader;
     LoadModel(FileName);
+    CalculateBounds();
 }
 
 Model::~Model()
 {
 }
 
-void Model::Render(std::string shader)
+//the shader name is kept for the Render signature every object shares, meshes draw with their own.
+void Model::Render(std::string)
 {
 	//go through each mesh and render it
     for (int i = 0; i < (int)_Meshes.size(); i++) {
-        _Meshes[i].Render(shader);
+        _Meshes[i].Render();
+    }
+}
+
+void Model::RenderDepth()
+{
+    for (auto& m : _Meshes) {
+        m.DrawDepth();
     }
 }
 
@@ -44,6 +54,34 @@ std::vector<unsigned int> Model::GetIndices()
     return indices;
 }
 
+void Model::CalculateBounds()
+{
+    _BoundsMin = glm::vec3(0.0f);
+    _BoundsMax = glm::vec3(0.0f);
+    _BoundsRadius = 0.0f;
+
+    bool first = true;
+    for (auto& m : _Meshes) {
+        for (auto& v : m._Vertices) {
+            if (first) {
+                _BoundsMin = v._Position;
+                _BoundsMax = v._Position;
+                first = false;
+            }
+            _BoundsMin = glm::min(_BoundsMin, v._Position);
+            _BoundsMax = glm::max(_BoundsMax, v._Position);
+        }
+    }
+
+    //sphere around the box center, tighter than the box corners for most models.
+    glm::vec3 center = GetBoundsCenter();
+    for (auto& m : _Meshes) {
+        for (auto& v : m._Vertices) {
+            _BoundsRadius = glm::max(_BoundsRadius, glm::length(v._Position - center));
+        }
+    }
+}
+
 void Model::LoadModel(std::string FileName)
 {
 	//uses Assimp library to load all models
@@ -210,7 +248,7 @@ unsigned int Model::TextureFromFile(std::string FileName)
         //create opengl texture
         glGenTextures(1, &_ID);
         //bind texture
-        glBindTexture(GL_TEXTURE_2D, _ID);
+        RenderState::Instance()->BindTexture(0, _ID);
         //set texture wrapping parameters
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
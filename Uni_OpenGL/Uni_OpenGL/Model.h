@@ -13,18 +13,32 @@ public:
     ~Model();
 
     void Render(std::string shader = "");
+    //positions only, for the shadow pass. the depth shader must be bound with its model matrix set.
+    void RenderDepth();
 
     std::vector<glm::vec3> GetVertices();
     std::vector<unsigned int> GetIndices();
 
+    std::vector<Mesh>& GetMeshes() { return _Meshes; }
+
+    //local space bounds worked out when the model is loaded.
+    glm::vec3 GetBoundsCenter() { return (_BoundsMin + _BoundsMax) * 0.5f; }
+    glm::vec3 GetBoundsExtents() { return (_BoundsMax - _BoundsMin) * 0.5f; }
+    float GetBoundsRadius() { return _BoundsRadius; }
+
 private:
     std::string _Shader;
     std::string _Directory;
     std::vector<Mesh> _Meshes;
     std::vector<MeshTexture> _Textures;
+
+    glm::vec3 _BoundsMin;
+    glm::vec3 _BoundsMax;
+    float _BoundsRadius;
     
     void LoadModel(std::string FileName);
     void ProcessNode(aiNode* node, const aiScene* scene);
+    void CalculateBounds();
     Mesh ProcessMesh(aiMesh* mesh, const aiScene* scene);
 
     std::vector<MeshTexture> LoadMaterialTextures(aiMaterial* material, aiTextureType type, std::string typeName);
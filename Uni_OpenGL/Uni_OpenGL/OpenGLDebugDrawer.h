@@ -2,11 +2,13 @@
 
 #include <BULLET\btBulletCollisionCommon.h>
 #include <BULLET\btBulletDynamicsCommon.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include "Buffer.h"
 #include "ShaderManager.h"
+#include "RenderState.h"
 
 class OpenGLDebugDrawer : public btIDebugDraw
 {
@@ -14,7 +16,7 @@ public:
     OpenGLDebugDrawer() {
         _Shader = "debug";
         _VertexArray.Create(VAO);
-        _VertexBuffer.Create(VBO);
+        _VertexBuffer.CreateRing(VBO, RING_SEGMENT_SIZE);
         _VertexArray.Bind();
 
         _VertexBuffer.Bind();
@@ -80,24 +82,33 @@ public:
     }
 
     void Render() {
-        _VertexBuffer.Fill(sizeof(float) * _DebugLines.size(), &_DebugLines[0], DYNAMIC);
-        _VertexArray.Bind();
-			glDrawArrays(GL_LINES, 0, _DebugLines.size() /6);
-        _VertexArray.Unbind();
-
-		_VertexBuffer.Fill(sizeof(float) * _DebugTriangles.size(), &_DebugTriangles[0], DYNAMIC);
-		_VertexArray.Bind();
-			glDrawArrays(GL_TRIANGLES, 0, _DebugTriangles.size() /6);
-		_VertexArray.Unbind();
-
+        DrawStreamed(_DebugLines, GL_LINES);
+        DrawStreamed(_DebugTriangles, GL_TRIANGLES);
 
         _DebugLines.clear();
-        _VertexBuffer.Reset();
+        _DebugTriangles.clear();
     }
 
 private:
+    //bytes per ring segment, bigger frames are drawn in more than one go.
+    const int RING_SEGMENT_SIZE = 1 << 20;
+    const int VERTEX_STRIDE = 6 * sizeof(float);
+
+    //writes straight into the ring, chunks hold whole lines and triangles.
+    void DrawStreamed(const std::vector<float>& vertices, GLenum mode) {
+        int total = (int)vertices.size() / 6;
+        int perChunk = (_VertexBuffer.GetSegmentSize() - VERTEX_STRIDE) / VERTEX_STRIDE / 6 * 6;
+        _VertexArray.Bind();
+        for (int first = 0; first < total; first += perChunk) {
+            int count = std::min(perChunk, total - first);
+            int offset = _VertexBuffer.Stream(count * VERTEX_STRIDE, &vertices[first * 6], VERTEX_STRIDE);
+            RenderState::Instance()->DrawArrays(mode, offset / VERTEX_STRIDE, count);
+        }
+        _VertexArray.Unbind();
+    }
+
     int _DebugMode;
-    std::string _Shader;
+    ShaderID _Shader;
 
     std::vector<float> _DebugLines;
 	std::vector<float> _DebugTriangles;
@@ -76,23 +76,23 @@ void OptionsState::Render()
 
 	glm::mat4 model = glm::mat4(1.0f);
 	model = glm::rotate(model, _SkyboxSpinAngle, glm::vec3(0, 1, 0));
-	ShaderManager::Instance()->GetShader("skybox")->UpdateMatrices(model, _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
+	ShaderManager::Instance()->BindShader(SHADER_ID("skybox"))->UpdateMatrices(model, _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
 	_SceneSky->Render();
 
 	//~~~~~~~ALL 2D RENDERING~~~~~~//
 	ScreenManager::Instance()->Set2D();
 
 	model = glm::mat4(1.0f);
-	ShaderManager::Instance()->GetShader("texture")->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
+	ShaderManager::Instance()->BindShader(SHADER_ID("texture"))->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
 	for (auto b : _MenuButtons) {
 		b->Render();
-		ShaderManager::Instance()->GetShader("texture")->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
+		ShaderManager::Instance()->BindShader(SHADER_ID("texture"))->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
 		glm::vec2 pos = b->GetPosition();
 		_TextRenderer->RenderText(b->GetButtonText(), glm::vec2(pos.x + 6, pos.y + 10), 1);
 	}
 	for (auto r : _RadioButtons) {
 		r->Render();
-		ShaderManager::Instance()->GetShader("texture")->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
+		ShaderManager::Instance()->BindShader(SHADER_ID("texture"))->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
 		glm::vec2 pos = r->GetPosition();
 		_TextRenderer->RenderText(r->GetButtonText(), glm::vec2(pos.x + 36, pos.y), 1, false, glm::vec3(0, 0, 0));
 	}
@@ -131,6 +131,6 @@ bool OptionsState::IsPaused()
 
 void OptionsState::TurnOnToonShading(bool turnOn)
 {
-	ShaderManager::Instance()->GetShader("terrain")->SetBool("toonShadingOn", turnOn);
-	ShaderManager::Instance()->GetShader("betterLight")->SetBool("toonShadingOn", turnOn);
+	//lit shaders switch to the toon permutation on their next lookup.
+	ShaderManager::Instance()->SetFeature(FEATURE_TOON_SHADING, turnOn);
 }
@@ -5,7 +5,10 @@
 #include "BGameObject.h"
 #include "Terrain.h"
 #include "Level.h"
+#include "Profiler.h"
+#include "StatsManager.h"
 #include <iterator>
+#include <chrono>
 
 PhysicsManager PhysicsManager::_Instance;
 
@@ -26,6 +29,13 @@ void PhysicsManager::Initialize()
 	_Solver = new btSequentialImpulseConstraintSolver();
 	_World = new btDiscreteDynamicsWorld(_Dispatcher, _BroadPhaseDetection, _Solver, _CollisionConfig);
 	_World->setGravity(btVector3(0, -9.8f, 0));
+	//only rebuild aabbs of awake bodies, static and sleeping objects keep theirs.
+	_World->setForceUpdateAllAabbs(false);
+	_World->setInternalTickCallback(InternalPreTickCallback, this, true);
+	_World->setInternalTickCallback(InternalTickCallback, this);
+
+	//every vehicle shares this, see BatchedVehicleRaycaster.
+	_VehicleRaycaster = new BatchedVehicleRaycaster(_World);
 
 	_DebugDrawer = new OpenGLDebugDrawer();
 	_DebugDrawer->setDebugMode(0);
@@ -50,6 +60,7 @@ void PhysicsManager::Shutdown()
 	}
 	_CollisionShapes.clear();
 
+	delete _VehicleRaycaster;
 	delete _World;
 	delete _Solver;
 	delete _BroadPhaseDetection;
@@ -82,9 +93,23 @@ void PhysicsManager::Input()
 
 void PhysicsManager::Update(float delta)
 {
+	PROFILE_SCOPE("PhysicsManager::Update");
 	//run 1 frame of physics whihc updates 60 times a frame
 	//at 60fps minimum, so thats 3600 physics updates per second.
+	_StepStats = PhysicsStepStats();
+	auto start = std::chrono::high_resolution_clock::now();
 	_World->stepSimulation(delta);
+	_StepStats.StepTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	_TimingTotals.Updates++;
+	_TimingTotals.SubSteps += _StepStats.SubSteps;
+	_TimingTotals.TotalTime += _StepStats.StepTime;
+	_TimingTotals.WorstTime = std::max(_TimingTotals.WorstTime, _StepStats.StepTime);
+
+	STATS_ADD(STAT_PHYSICS_SUBSTEPS, _StepStats.SubSteps);
+	STATS_ADD(STAT_COLLISION_PAIRS, _StepStats.BroadphasePairs);
+	STATS_ADD(STAT_CONTACT_MANIFOLDS, _StepStats.ContactManifolds);
+
 	CheckForCollisionEvents();
 }
 
@@ -108,6 +133,7 @@ void PhysicsManager::AddObjectToSimulation(Terrain * terrain)
 void PhysicsManager::AddLevelToSimulation(Level * level)
 {
 	level->Initialize(_World, &_CollisionShapes);
+	_VehicleRaycaster->SetTerrain(level->GetTerrain());
 }
 
 void PhysicsManager::RemoveObjectFromSimulation(BGameObject * object)
@@ -122,6 +148,7 @@ void PhysicsManager::RemoveObjectFromSimulation(Terrain * terrain)
 
 void PhysicsManager::RemoveLevelFromSimulation(Level * level)
 {
+	_VehicleRaycaster->SetTerrain(nullptr);
 	_World->removeRigidBody(level->GetTerrain()->GetRigidBody());
 }
 
@@ -218,6 +245,40 @@ void PhysicsManager::SeperationEvent(std::pair<const btRigidBody*, const btRigid
 	_CurrentlyCollidingPairs.erase(pair);
 }
 
+void PhysicsManager::InternalPreTickCallback(btDynamicsWorld * world, btScalar timeStep)
+{
+	//called by bullet before every internal step, before the vehicles cast their wheel rays.
+	PhysicsManager* manager = static_cast<PhysicsManager*>(world->getWorldUserInfo());
+	manager->_VehicleRaycaster->PrepareStep();
+	manager->_StepStats.WheelRayCandidates = manager->_VehicleRaycaster->GetCandidateCount();
+}
+
+void PhysicsManager::InternalTickCallback(btDynamicsWorld * world, btScalar timeStep)
+{
+	//called by bullet after every internal step
+	static_cast<PhysicsManager*>(world->getWorldUserInfo())->CountStep();
+}
+
+void PhysicsManager::CountStep()
+{
+	_StepStats.SubSteps++;
+	_StepStats.BroadphasePairs += _BroadPhaseDetection->getOverlappingPairCache()->getNumOverlappingPairs();
+	for (int i = 0; i < _Dispatcher->getNumManifolds(); i++) {
+		if (_Dispatcher->getManifoldByIndexInternal(i)->getNumContacts() > 0) {
+			_StepStats.ContactManifolds++;
+		}
+	}
+
+	int activeBodies = 0;
+	const btCollisionObjectArray& objects = _World->getCollisionObjectArray();
+	for (int i = 0; i < objects.size(); i++) {
+		if (!objects[i]->isStaticOrKinematicObject() && objects[i]->isActive()) {
+			activeBodies++;
+		}
+	}
+	_StepStats.ActiveBodies = activeBodies;
+}
+
 btBroadphaseInterface * PhysicsManager::GetBroadPhaseInterface()
 {
 	return _BroadPhaseDetection;
@@ -247,3 +308,8 @@ OpenGLDebugDrawer * PhysicsManager::GetDebugDrawer()
 {
 	return _DebugDrawer;
 }
+
+BatchedVehicleRaycaster * PhysicsManager::GetVehicleRaycaster()
+{
+	return _VehicleRaycaster;
+}
@@ -4,6 +4,7 @@
 #include <BULLET\btBulletDynamicsCommon.h>
 #include "OpenGLMotionState.h"
 #include "OpenGLDebugDrawer.h"
+#include "BatchedVehicleRaycaster.h"
 
 #include <set>
 
@@ -11,6 +12,24 @@ class BGameObject;
 class Terrain;
 class Level;
 
+//counters for the last call to PhysicsManager::Update, used to measure broadphase savings.
+struct PhysicsStepStats {
+	int SubSteps = 0;			//fixed internal steps bullet took
+	int ActiveBodies = 0;		//awake non static bodies on the last internal step
+	int BroadphasePairs = 0;	//overlapping pairs sent to the narrowphase, summed over internal steps
+	int ContactManifolds = 0;	//narrowphase pairs that ended up touching, summed over internal steps
+	int WheelRayCandidates = 0;	//bodies the wheel rays were tested against on the last internal step
+	float StepTime = 0.0f;		//milliseconds spent in stepSimulation
+};
+
+//running totals over every PhysicsManager::Update since launch, used by the replay benchmark.
+struct PhysicsTimingTotals {
+	int Updates = 0;
+	int SubSteps = 0;
+	float TotalTime = 0.0f;		//milliseconds
+	float WorstTime = 0.0f;		//milliseconds
+};
+
 class PhysicsManager
 {
 public:
@@ -39,6 +58,10 @@ public:
 	btConstraintSolver* GetConstraintSolver();
 	btDynamicsWorld* GetWorld();
 	OpenGLDebugDrawer* GetDebugDrawer();
+	BatchedVehicleRaycaster* GetVehicleRaycaster();
+
+	const PhysicsStepStats& GetStepStats() { return _StepStats; }
+	const PhysicsTimingTotals& GetTimingTotals() { return _TimingTotals; }
 
 	static PhysicsManager* Instance() {
 		return &_Instance;
@@ -53,6 +76,7 @@ private:
 	btConstraintSolver*             _Solver;
 	btDynamicsWorld*                _World;
 	OpenGLDebugDrawer*              _DebugDrawer;
+	BatchedVehicleRaycaster*        _VehicleRaycaster;
 
 	std::set<std::pair<const btRigidBody*, const btRigidBody*>> _PreviousCollisionPairs;
 
@@ -64,6 +88,13 @@ private:
 
 	std::set<btCollisionShape*> _CollisionShapes;
 
+	PhysicsStepStats _StepStats;
+	PhysicsTimingTotals _TimingTotals;
+
+	static void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep);
+	static void InternalTickCallback(btDynamicsWorld* world, btScalar timeStep);
+	void CountStep();
+
 	PhysicsManager();
 	~PhysicsManager();
 	PhysicsManager(const PhysicsManager&) {}
@@ -1,8 +1,11 @@
 #include "PlayState.h"
 
 #include "ScreenManager.h"
+#include "Profiler.h"
+#include "StatsManager.h"
 #include "StateManager.h"
 #include "InputManager.h"
+#include "ActionManager.h"
 #include "PhysicsManager.h"
 #include "ResourceManager.h"
 #include "Texture.h"
@@ -16,6 +19,9 @@
 #include "AddScoreState.h"
 
 #include "Tools.h"
+#include "SplineDriverController.h"
+
+#include <cstdio>
 
 
 
@@ -68,10 +74,55 @@ bool PlayState::Initialize()
         PhysicsManager::Instance()->AddObjectToSimulation(p);
     }
 	_Car->SetDirection(_Level->GetNextTriggerGate()->GetTrackDirection());
+
+	_VehicleSystem = new VehicleSystem();
+	_VehicleSystem->AddVehicle(_Car, new KeyboardVehicleController());
+
+	std::map<std::string, int>* options = ResourceManager::Instance()->GetOptions();
+	if (options->find("AIVehicles") != options->end()) {
+		SpawnAIVehicles(options->at("AIVehicles"));
+	}
 	_CarSpeedometer->SetTarget(_Car);
 
 	_TextRenderer = ResourceManager::Instance()->GetTextRenderer("Font_Calibri");
 
+	int shadowResolution = DEFAULT_SHADOW_RESOLUTION;
+	int shadowCascades = DEFAULT_SHADOW_CASCADES;
+	if (options->find("ShadowResolution") != options->end()) {
+		shadowResolution = options->at("ShadowResolution");
+	}
+	if (options->find("ShadowCascades") != options->end()) {
+		shadowCascades = options->at("ShadowCascades");
+	}
+	_Shadows = new CascadedShadowMap();
+	_Shadows->Create(shadowResolution, shadowCascades);
+
+	//lights only change once a frame so they are sent the first time each program is used.
+	_RenderQueue = new RenderQueue();
+	bool depthPrePass = true;
+	if (options->find("DepthPrePass") != options->end()) {
+		depthPrePass = options->at("DepthPrePass") != 0;
+	}
+	_RenderQueue->SetDepthPrePass(depthPrePass);
+	_RenderQueue->SetShaderSetup("betterLight", [this](Shader* shader) { SetupLitShader(shader); });
+	_RenderQueue->SetShaderSetup("betterLightInstanced", [this](Shader* shader) { SetupLitShader(shader); });
+	_RenderQueue->SetShaderSetup("terrain", [this](Shader* shader) { SetupLitShader(shader); });
+
+	if (options->find("ClusteredLights") != options->end()) {
+		_UseClusteredLights = options->at("ClusteredLights") != 0;
+	}
+	_ClusteredLights = new ClusteredLights();
+	_ClusteredLights->Create();
+	_TrackLamps.clear();
+	for (auto gate : _Level->GetTriggerGates()) {
+		_TrackLamps.push_back(PointLight(gate->GetPosition() + glm::vec3(0.0f, 4.0f, 0.0f), 1.0f, 0.22f, 0.20f,
+			glm::vec3(0.02f, 0.02f, 0.02f), glm::vec3(1.0f, 0.75f, 0.4f), glm::vec3(1.0f, 0.75f, 0.4f)));
+	}
+	_Headlight = PointLight(glm::vec3(0.0f), 1.0f, 0.22f, 0.20f, glm::vec3(0.0f), glm::vec3(0.9f, 0.9f, 0.8f), glm::vec3(0.9f, 0.9f, 0.8f));
+	//the menus share the skybox program without a camera block, so it keeps plain matrices.
+	_RenderQueue->SetShaderSetup("skybox", [this](Shader* shader) { shader->UpdateMatrices(glm::mat4(1.0f), _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection()); });
+	_FrameUniforms = new FrameUniforms();
+
 	_HighScoreList = ResourceManager::Instance()->GetHighScores();
 
 	ScreenManager::Instance()->GrabMouse();
@@ -84,7 +135,7 @@ void PlayState::Input()
 {
 	PhysicsManager::Instance()->Input();
 
-	if (InputManager::Instance()->IsKeyPressed(SDLK_ESCAPE)) {
+	if (ActionManager::Instance()->IsActionPressed(ACTION_PAUSE)) {
 		StateManager::Instance()->PushState("[STATE]Pause");
 		if (CompareHighScore(_Level->GetBestLapTime())) {
 			((AddScoreState*)StateManager::Instance()->GetState("[STATE]AddScore"))->PassLapTime(_Level->GetBestLapTime());
@@ -93,7 +144,7 @@ void PlayState::Input()
 		}
 	}
 
-	if (InputManager::Instance()->IsKeyPressed(SDLK_F8)) {
+	if (ActionManager::Instance()->IsActionPressed(ACTION_TOGGLE_WIREFRAME)) {
 		if (EnableWireMode) {
 			EnableWireMode = !EnableWireMode;
 			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -104,7 +155,19 @@ void PlayState::Input()
 		}
 	}
 
-	if (InputManager::Instance()->IsKeyPressed(SDLK_BACKSPACE)) {
+	if (ActionManager::Instance()->IsActionPressed(ACTION_TOGGLE_STATS)) {
+		_ShowStats = !_ShowStats;
+	}
+
+	if (ActionManager::Instance()->IsActionPressed(ACTION_TOGGLE_DEPTH_PREPASS)) {
+		_RenderQueue->SetDepthPrePass(!_RenderQueue->GetDepthPrePass());
+	}
+
+	if (ActionManager::Instance()->IsActionPressed(ACTION_TOGGLE_PROFILER)) {
+		_ShowProfiler = !_ShowProfiler;
+	}
+
+	if (ActionManager::Instance()->IsActionPressed(ACTION_RESET_VEHICLE)) {
 		int index = _Level->GetNearestTrackPoint(_Car->GetPosition());
 
 		glm::vec2 point = _Level->GetSmoothTrack()->GetSpline()[index];
@@ -133,6 +196,8 @@ void PlayState::Input()
 
 void PlayState::Update(float delta)
 {
+	PROFILE_SCOPE("PlayState::Update");
+	_VehicleSystem->Update(delta);
 	PhysicsManager::Instance()->Update(delta);
 
     for (auto p : _PhysicsObjects) {
@@ -151,47 +216,68 @@ void PlayState::Update(float delta)
 
 void PlayState::Render()
 {
+	PROFILE_SCOPE("PlayState::Render");
 	//~~~~~~~ALL 3D RENDERING~~~~~~//
 	ScreenManager::Instance()->Set3D(90, _Camera->GetZoom(), 0.1f, 1000.0f);
 		
 	glm::mat4 model = glm::mat4(1.0f);
-	
-    _DirectionalLight->SendToShader("betterLight");
-    _PointLight->SendToShader(0, "betterLight");
-    ShaderManager::Instance()->GetShader("betterLight")->SetVec3("viewPos", _Camera->GetPosition());
-    for (auto p : _PhysicsObjects) {
-        ShaderManager::Instance()->GetShader(p->GetShader())->UpdateMatrices(p->GetModelMatrix(), _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
-        p->Render();
-    }
 
-    model = glm::mat4(1.0f);
-	model = glm::translate(glm::vec3(-400, 0, -400));
-    ShaderManager::Instance()->GetShader("terrain")->UpdateMatrices(model, _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
-    _DirectionalLight->SendToShader("terrain");
-    _PointLight->SendToShader(0, "terrain");
-    ShaderManager::Instance()->GetShader("terrain")->SetVec3("viewPos", _Camera->GetPosition());
-	_Level->Render();
+	glm::mat4 view = _Camera->GetViewMatrix();
+	glm::mat4 projection = ScreenManager::Instance()->GetProjection();
+	_Frustum.Extract(projection * view);
+	_CullStats = CullStats();
+
+	//spheres for the vehicles since they roll and spin around.
+	_ObjectBounds.Clear();
+	for (auto p : _PhysicsObjects) {
+		glm::vec3 center;
+		float radius;
+		p->GetWorldSphere(center, radius);
+		_ObjectBounds.AddSphere(center, radius);
+	}
+	RenderShadows(view, projection);
+	//after the shadows so the cascade matrices are this frames.
+	UpdateFrameUniforms(view, projection);
+	{
+		PROFILE_SCOPE("Culling");
+		_Frustum.CullSpheres(_ObjectBounds, _ObjectVisible, _CullStats);
+	}
 
-    model = glm::mat4(1.0f);
-    ShaderManager::Instance()->GetShader("skybox")->UpdateMatrices(model, _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
-    _SceneSky->Render();
+	_RenderQueue->Begin(_Camera->GetPosition());
+	for (int i = 0; i < (int)_PhysicsObjects.size(); i++) {
+		if (_ObjectVisible[i]) {
+			_PhysicsObjects[i]->Submit(_RenderQueue);
+		}
+	}
+	_Level->Submit(_RenderQueue, _Frustum, _CullStats);
 
-    ShaderManager::Instance()->GetShader("debug")->UpdateMatrices(model, _Camera->GetViewMatrix(), ScreenManager::Instance()->GetProjection());
-	PhysicsManager::Instance()->Render();
+	Terrain* terrain = _Level->GetTerrain();
+	_RenderQueue->Submit([terrain]() { terrain->Render(); }, glm::translate(glm::vec3(-400, 0, -400)), "terrain", PASS_OPAQUE, [terrain]() { terrain->RenderDepth(); });
+	_RenderQueue->Submit([this]() { _SceneSky->Render(); }, model, "skybox", PASS_SKY);
+	_RenderQueue->Submit([]() { PhysicsManager::Instance()->Render(); }, model, "debug", PASS_DEBUG);
+	_RenderQueue->Flush();
 
     //~~~~~~~ALL 2D RENDERING~~~~~~//
+    PROFILE_GPU_SCOPE("HUD");
     ScreenManager::Instance()->Set2D();
 
 	model = glm::mat4(1.0f);
-	ShaderManager::Instance()->GetShader("texture")->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
+	ShaderManager::Instance()->BindShader(SHADER_ID("texture"))->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
 	_CarSpeedometer->Render();
 	model = glm::mat4(1.0f);
-	ShaderManager::Instance()->GetShader("texture")->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
+	ShaderManager::Instance()->BindShader(SHADER_ID("texture"))->UpdateMatrices(model, _Camera->GetOrthoView(), ScreenManager::Instance()->GetProjection());
 	//lap time needs formatting to be in minutes and seconds rather than just seconds and milliseconds.
 	glm::vec2 screenSize = ScreenManager::Instance()->GetSize();
 	_TextRenderer->RenderText("Current Lap Time", glm::vec2(screenSize.x / 20, screenSize.y - 50), 1);
 	_TextRenderer->RenderText(FloatToTime(_Level->GetCurrentLapTime()), glm::vec2(screenSize.x / 20, screenSize.y - 100), 1);
 
+	if (_ShowStats) {
+		RenderStatsText();
+	}
+	if (_ShowProfiler) {
+		Profiler::Instance()->RenderOverlay(_TextRenderer, glm::vec2(screenSize.x / 20, screenSize.y - 160), 0.4f);
+	}
+
 }
 
 bool PlayState::Shutdown()
@@ -200,7 +286,14 @@ bool PlayState::Shutdown()
     delete _SceneGrid;
 	delete _DirectionalLight;
 	delete _PointLight;;
-	delete _Car;
+	delete _VehicleSystem;
+	delete _RenderQueue;
+	delete _Shadows;
+	delete _ClusteredLights;
+	delete _FrameUniforms;
+	for (auto p : _PhysicsObjects) {
+		delete p;
+	}
 	delete _CarSpeedometer;
 	delete _Level;
 
@@ -235,6 +328,127 @@ void PlayState::SetSeed(int seed)
 	_Seed = seed;
 }
 
+void PlayState::RenderStatsText()
+{
+	//render counters are from the last full frame, this one is still being drawn.
+	StatsManager* stats = StatsManager::Instance();
+	glm::vec2 screenSize = ScreenManager::Instance()->GetSize();
+	_TextRenderer->RenderText("Visible: " + std::to_string(_CullStats.Visible) + "  Culled: " + std::to_string(_CullStats.Culled), glm::vec2(screenSize.x / 20, 80), 0.5f);
+	char gpuTimes[64];
+	snprintf(gpuTimes, sizeof(gpuTimes), "Pre-pass: %s %.2fms  Opaque: %.2fms", _RenderQueue->GetDepthPrePass() ? "on" : "off", _RenderQueue->GetPrePassTime(), _RenderQueue->GetOpaqueTime());
+	_TextRenderer->RenderText(gpuTimes, glm::vec2(screenSize.x / 20, 110), 0.5f);
+	if (_UseClusteredLights) {
+		_TextRenderer->RenderText("Lights: " + std::to_string(_ClusteredLights->GetLightCount()) + "  Cell entries: " + std::to_string(_ClusteredLights->GetIndexCount()), glm::vec2(screenSize.x / 20, 140), 0.5f);
+	}
+	_TextRenderer->RenderText("Draws: " + std::to_string(stats->GetLastFrame(STAT_DRAW_CALLS)) + "  Programs: " + std::to_string(stats->GetLastFrame(STAT_PROGRAM_SWITCHES)) + "  Textures: " + std::to_string(stats->GetLastFrame(STAT_TEXTURE_BINDS)), glm::vec2(screenSize.x / 20, 50), 0.5f);
+	stats->RenderOverlay(_TextRenderer, glm::vec2(screenSize.x * 0.75f, screenSize.y - 50), 0.4f);
+}
+
+void PlayState::SetupLitShader(Shader* shader)
+{
+	_Shadows->SendToShader(shader);
+	if (_UseClusteredLights) {
+		_ClusteredLights->SendToShader(shader);
+	}
+}
+
+void PlayState::UpdateFrameUniforms(const glm::mat4& view, const glm::mat4& projection)
+{
+	CameraBlock camera = {};
+	camera.View = view;
+	camera.Projection = projection;
+	camera.ViewPosition = _Camera->GetPosition();
+	_FrameUniforms->UpdateCamera(camera);
+
+	LightsBlock lights = {};
+	_DirectionalLight->Fill(lights.DirLight);
+	lights.HasDirLight = 1;
+	_PointLight->Fill(lights.PointLights[0]);
+	lights.HasPointLight = 1;
+	lights.PointLightCount = 1;
+	_Shadows->Fill(lights);
+	if (_UseClusteredLights) {
+		GatherLights(view, projection);
+		_ClusteredLights->Fill(lights);
+	}
+	_FrameUniforms->UpdateLights(lights);
+	//lit shaders are compiled for the lights in use rather than branching on them.
+	ShaderManager::Instance()->SetFeature(FEATURE_DIR_LIGHT, lights.HasDirLight != 0);
+	ShaderManager::Instance()->SetFeature(FEATURE_CLUSTERED_LIGHTS, _UseClusteredLights);
+	ShaderManager::Instance()->SetPointLightCount(!_UseClusteredLights && lights.HasPointLight != 0 ? lights.PointLightCount : 0);
+}
+
+void PlayState::GatherLights(const glm::mat4& view, const glm::mat4& projection)
+{
+	_ClusteredLights->Clear();
+	_ClusteredLights->Add(*_PointLight);
+	for (auto& lamp : _TrackLamps) {
+		_ClusteredLights->Add(lamp);
+	}
+	for (auto p : _PhysicsObjects) {
+		_Headlight.SetPosition(p->GetPosition() + p->GetRotationQuaternion() * HEADLIGHT_OFFSET);
+		_ClusteredLights->Add(_Headlight);
+	}
+	_ClusteredLights->Build(view, projection, ScreenManager::Instance()->GetSize());
+}
+
+void PlayState::RenderShadows(const glm::mat4& view, const glm::mat4& projection)
+{
+	PROFILE_GPU_SCOPE("Shadows");
+	if (_Shadows->GetCascadeCount() == 0) {
+		return;
+	}
+	_Shadows->Update(view, projection, _DirectionalLight->GetDirection());
+	for (int c = 0; c < _Shadows->GetCascadeCount(); c++) {
+		_Shadows->BeginCascade(c);
+		//each cascade only draws the casters that land in it.
+		const Frustum& cascade = _Shadows->GetCascadeFrustum(c);
+		CullStats stats;
+		cascade.CullSpheres(_ObjectBounds, _ShadowVisible, stats);
+		Shader* depth = ShaderManager::Instance()->BindShader(SHADER_ID("shadow"));
+		for (int i = 0; i < (int)_PhysicsObjects.size(); i++) {
+			if (_ShadowVisible[i]) {
+				_PhysicsObjects[i]->RenderDepth(depth);
+			}
+		}
+		_Level->RenderShadowCasters(cascade);
+	}
+	_Shadows->End();
+}
+
+void PlayState::SpawnAIVehicles(int count)
+{
+	std::vector<glm::vec2> track = _Level->GetSmoothTrack()->GetSpline();
+	if (track.size() < 2) {
+		return;
+	}
+	Model* carModel = ResourceManager::Instance()->GetModel("Buggy");
+
+	//line the ai cars up behind the player along the track.
+	int index = _Level->GetNearestTrackPoint(_Car->GetPosition());
+	int trackSize = (int)track.size();
+	for (int i = 0; i < count; i++) {
+		float distance = 0.0f;
+		while (distance < AI_SPAWN_SPACING) {
+			int previous = (index + trackSize - 1) % trackSize;
+			distance += glm::length(track[index] - track[previous]);
+			index = previous;
+		}
+		glm::vec2 point = track[index];
+		glm::vec2 next = track[(index + 1) % trackSize];
+
+		BVehicle* car = new BVehicle(glm::vec3(point.x, 3.0f, point.y), glm::vec3(0, 1, 0), 739.8092f, carModel, "betterLight");
+		car->Scale(glm::vec3(0.5));
+		_PhysicsObjects.push_back(car);
+		PhysicsManager::Instance()->AddObjectToSimulation(car);
+		car->SetDirection(glm::vec3(next.x - point.x, 0.0f, next.y - point.y));
+
+		//small fixed spread in pace so they dont all drive as one block, same every run.
+		float speedScale = 0.85f + 0.15f * (float)(i % 4) / 3.0f;
+		_VehicleSystem->AddVehicle(car, new SplineDriverController(_Level->GetSmoothTrack(), speedScale));
+	}
+}
+
 bool PlayState::CompareHighScore(float lapTime)
 {
 	if (lapTime == 0.0f) {
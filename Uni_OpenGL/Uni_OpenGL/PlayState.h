@@ -20,13 +20,18 @@
 #include <Bullet/btBulletDynamicsCommon.h>
 #include "BGameObject.h"
 #include "BVehicle.h"
+#include "VehicleSystem.h"
 
 #include "Level.h"
 
 #include "TrackGenerator.h"
 #include "CatmullRomSpline.h"
 
-#include "ShadowMapBuffer.h"
+#include "CascadedShadowMap.h"
+#include "RenderQueue.h"
+#include "Frustum.h"
+#include "FrameUniforms.h"
+#include "ClusteredLights.h"
 
 class PlayState : public State
 {
@@ -56,11 +61,31 @@ private:
 	PointLight*		_PointLight;
 
 	BVehicle* _Car;
+	VehicleSystem* _VehicleSystem;
 
 	bool EnableWireMode = false;
 
 	std::vector<BGameObject*> _PhysicsObjects;
 
+	//3d draws are queued and sorted by program and material before being drawn.
+	RenderQueue* _RenderQueue;
+	//binds the shadow map for a lit program, the lights themselves are in the Lights uniform block.
+	void SetupLitShader(Shader* shader);
+	//camera, lights and shadow matrices go to every program through one upload each.
+	FrameUniforms* _FrameUniforms;
+	void UpdateFrameUniforms(const glm::mat4& view, const glm::mat4& projection);
+
+	//objects outside the camera frustum are not queued.
+	Frustum _Frustum;
+	BoundsList _ObjectBounds;
+	std::vector<unsigned char> _ObjectVisible;
+	CullStats _CullStats;
+
+	bool _ShowStats = false;
+	//scope times from the profiler, F5.
+	bool _ShowProfiler = false;
+	void RenderStatsText();
+
 	Speedometer* _CarSpeedometer;
 	TextRenderer* _TextRenderer;
 
@@ -72,8 +97,26 @@ private:
 
 	bool CompareHighScore(float lapTime);
 
-	ShadowMapBuffer _ShadowBuffer;
-	Sprite* DepthSprite;
+	//ai cars for load testing, count comes from the AIVehicles option.
+	const float AI_SPAWN_SPACING = 10.0f;
+	void SpawnAIVehicles(int count);
+
+	//sun shadows, resolution and cascade count come from the ShadowResolution and ShadowCascades options.
+	const int DEFAULT_SHADOW_RESOLUTION = 2048;
+	const int DEFAULT_SHADOW_CASCADES = 3;
+	CascadedShadowMap* _Shadows;
+	std::vector<unsigned char> _ShadowVisible;
+	void RenderShadows(const glm::mat4& view, const glm::mat4& projection);
+
+	//point lights are binned per screen cell so lit shaders only loop over nearby ones.
+	//turned off by the ClusteredLights option, then only _PointLight goes in the lights block.
+	bool _UseClusteredLights = true;
+	ClusteredLights* _ClusteredLights;
+	//a lamp over every checkpoint and a light ahead of every car.
+	std::vector<PointLight> _TrackLamps;
+	PointLight _Headlight;
+	const glm::vec3 HEADLIGHT_OFFSET = glm::vec3(0.0f, 1.0f, 3.0f);
+	void GatherLights(const glm::mat4& view, const glm::mat4& projection);
 
 };
 
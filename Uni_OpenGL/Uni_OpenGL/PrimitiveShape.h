@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Buffer.h"
+#include "ShaderID.h"
 #include <GLM\glm.hpp>
 
 
@@ -15,7 +16,7 @@ public:
 
 protected:
 	int _DrawCount;
-	std::string _Shader;
+	ShaderID _Shader;
 
 	Buffer _VertexArray;
 	Buffer _VertexBuffer;
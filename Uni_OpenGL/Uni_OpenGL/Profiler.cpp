@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "Profiler.h"
+#include "GpuTimer.h"
+#include "TextRenderer.h"
+#include "LogManager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+////////////////////////////////////////////////////////////
+// Static Variables
+////////////////////////////////////////////////////////////
+Profiler Profiler::_Instance;
+
+////////////////////////////////////////////////////////////
+Profiler::Profiler() :
+	_GpuScope(-1),
+	_HistoryIndex(0),
+	_HistoryFrames(0),
+	_Epoch(Clock::now()),
+	_Tracing(false),
+	_FrameStart(0.0)
+{
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::BeginFrame()
+{
+	_FrameStart = Now();
+	BeginScope("Frame");
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::EndFrame()
+{
+	EndScope();
+	if (!_Stack.empty()) {
+		LogManager::Instance()->LogWarning("Profiler scopes left open at the end of the frame, closing them.");
+		while (!_Stack.empty()) {
+			EndScope();
+		}
+	}
+
+	for (int i = 0; i < (int)_Nodes.size(); i++) {
+		ScopeNode& node = _Nodes[i];
+		node.History[_HistoryIndex] = node.FrameTime;
+		//the newest query that has come back, not this frames.
+		float gpuTime = 0.0f;
+		if (node.Gpu && node.FrameCalls > 0 && node.Timer != nullptr) {
+			gpuTime = node.Timer->GetMilliseconds();
+			if (_Tracing) {
+				GpuSample sample;
+				sample.Node = i;
+				sample.Time = _FrameStart;
+				sample.Value = gpuTime;
+				_GpuSamples.push_back(sample);
+			}
+		}
+		node.GpuHistory[_HistoryIndex] = gpuTime;
+		node.FrameTime = 0.0f;
+		node.FrameCalls = 0;
+	}
+	_HistoryIndex = (_HistoryIndex + 1) % HISTORY_SIZE;
+	_HistoryFrames = std::min(_HistoryFrames + 1, HISTORY_SIZE);
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::BeginScope(const char* Name)
+{
+	int parent = _Stack.empty() ? -1 : _Stack.back();
+	int node = FindChild(parent, Name, false);
+	_Nodes[node].Start = Now();
+	_Stack.push_back(node);
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::EndScope()
+{
+	if (_Stack.empty()) {
+		return;
+	}
+	int index = _Stack.back();
+	_Stack.pop_back();
+
+	ScopeNode& node = _Nodes[index];
+	double duration = Now() - node.Start;
+	node.FrameTime += (float)(duration / 1000.0);
+	node.FrameCalls++;
+
+	if (_Tracing) {
+		if (_TraceEvents.size() < MAX_TRACE_EVENTS) {
+			TraceEvent event;
+			event.Node = index;
+			event.Start = node.Start;
+			event.Duration = duration;
+			_TraceEvents.push_back(event);
+		}
+		else if (_TraceEvents.size() == MAX_TRACE_EVENTS) {
+			LogManager::Instance()->LogWarning("Profiler trace is full, later scopes are not recorded.");
+			_TraceEvents.push_back(TraceEvent());
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::BeginGpuScope(const char* Name)
+{
+	int parent = _Stack.empty() ? -1 : _Stack.back();
+	int index = FindChild(parent, Name, true);
+	ScopeNode& node = _Nodes[index];
+	node.Start = Now();
+	_Stack.push_back(index);
+
+	//time elapsed queries cant nest, the outer one keeps measuring.
+	if (_GpuScope == -1) {
+		if (node.Timer == nullptr) {
+			node.Timer = new GpuTimer();
+		}
+		node.Timer->Begin();
+		_GpuScope = index;
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::EndGpuScope()
+{
+	if (!_Stack.empty() && _Stack.back() == _GpuScope) {
+		_Nodes[_GpuScope].Timer->End();
+		_GpuScope = -1;
+	}
+	EndScope();
+}
+
+////////////////////////////////////////////////////////////
+float Profiler::GetAverage(const char* Name, bool Gpu)
+{
+	if (_HistoryFrames == 0) {
+		return 0.0f;
+	}
+	for (auto& node : _Nodes) {
+		if (node.Gpu == Gpu && std::strcmp(node.Name, Name) == 0) {
+			const float* history = Gpu ? node.GpuHistory : node.History;
+			float total = 0.0f;
+			for (int i = 0; i < _HistoryFrames; i++) {
+				total += history[i];
+			}
+			return total / _HistoryFrames;
+		}
+	}
+	return 0.0f;
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::RenderOverlay(TextRenderer* Text, glm::vec2 Position, float Scale)
+{
+	for (int i = 0; i < (int)_Nodes.size(); i++) {
+		if (_Nodes[i].Parent == -1) {
+			RenderNode(Text, i, Position, Scale);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::RenderNode(TextRenderer* Text, int Node, glm::vec2& Position, float Scale)
+{
+	const ScopeNode& node = _Nodes[Node];
+	int frames = std::max(_HistoryFrames, 1);
+	float total = 0.0f;
+	float worst = 0.0f;
+	float gpuTotal = 0.0f;
+	for (int i = 0; i < _HistoryFrames; i++) {
+		total += node.History[i];
+		worst = std::max(worst, node.History[i]);
+		gpuTotal += node.GpuHistory[i];
+	}
+
+	char line[160];
+	int length = std::snprintf(line, sizeof(line), "%*s%s  %.2fms  max %.2fms", node.Depth * 4, "", node.Name, total / frames, worst);
+	if (node.Gpu && length > 0 && length < (int)sizeof(line)) {
+		std::snprintf(line + length, sizeof(line) - length, "  gpu %.2fms", gpuTotal / frames);
+	}
+	Text->RenderText(line, Position, Scale);
+	Position.y -= 60.0f * Scale;
+
+	for (int child : node.Children) {
+		RenderNode(Text, child, Position, Scale);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::StartTrace(std::string FilePath)
+{
+	_TraceFile = FilePath;
+	_TraceEvents.clear();
+	_GpuSamples.clear();
+	_Tracing = true;
+	LogManager::Instance()->LogInfo("Profiler recording trace to " + FilePath);
+}
+
+////////////////////////////////////////////////////////////
+bool Profiler::StopTrace()
+{
+	if (!_Tracing) {
+		return false;
+	}
+	_Tracing = false;
+
+	std::ofstream file(_TraceFile);
+	if (!file.is_open()) {
+		LogManager::Instance()->LogError("Profiler could not open trace file " + _TraceFile);
+		return false;
+	}
+
+	//complete events for the cpu scopes, one counter track per gpu scope.
+	char buffer[256];
+	bool first = true;
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	size_t eventCount = std::min(_TraceEvents.size(), MAX_TRACE_EVENTS);
+	for (size_t i = 0; i < eventCount; i++) {
+		const TraceEvent& event = _TraceEvents[i];
+		std::snprintf(buffer, sizeof(buffer), "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			first ? "" : ",\n", _Nodes[event.Node].Name, _Nodes[event.Node].Gpu ? "gpu" : "cpu", event.Start, event.Duration);
+		file << buffer;
+		first = false;
+	}
+	for (auto& sample : _GpuSamples) {
+		std::snprintf(buffer, sizeof(buffer), "%s{\"name\":\"GPU %s\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":{\"ms\":%.3f}}",
+			first ? "" : ",\n", _Nodes[sample.Node].Name, sample.Time, sample.Value);
+		file << buffer;
+		first = false;
+	}
+	file << "\n]}\n";
+
+	LogManager::Instance()->LogInfo("Profiler wrote " + std::to_string(eventCount) + " events to " + _TraceFile);
+	_TraceEvents.clear();
+	_TraceEvents.shrink_to_fit();
+	_GpuSamples.clear();
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+void Profiler::Shutdown()
+{
+	for (auto& node : _Nodes) {
+		delete node.Timer;
+		node.Timer = nullptr;
+	}
+	_GpuScope = -1;
+}
+
+////////////////////////////////////////////////////////////
+double Profiler::Now()
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - _Epoch).count();
+}
+
+////////////////////////////////////////////////////////////
+int Profiler::FindChild(int Parent, const char* Name, bool Gpu)
+{
+	//names are usually literals so the pointer compare nearly always hits first.
+	if (Parent != -1) {
+		for (int child : _Nodes[Parent].Children) {
+			const ScopeNode& node = _Nodes[child];
+			if (node.Gpu == Gpu && (node.Name == Name || std::strcmp(node.Name, Name) == 0)) {
+				return child;
+			}
+		}
+	}
+	else {
+		for (int i = 0; i < (int)_Nodes.size(); i++) {
+			const ScopeNode& node = _Nodes[i];
+			if (node.Parent == -1 && node.Gpu == Gpu && (node.Name == Name || std::strcmp(node.Name, Name) == 0)) {
+				return i;
+			}
+		}
+	}
+
+	ScopeNode node;
+	node.Name = Name;
+	node.Parent = Parent;
+	node.Depth = Parent == -1 ? 0 : _Nodes[Parent].Depth + 1;
+	node.Gpu = Gpu;
+	node.Timer = nullptr;
+	node.Start = 0.0;
+	node.FrameTime = 0.0f;
+	node.FrameCalls = 0;
+	std::fill(node.History, node.History + HISTORY_SIZE, 0.0f);
+	std::fill(node.GpuHistory, node.GpuHistory + HISTORY_SIZE, 0.0f);
+
+	int index = (int)_Nodes.size();
+	_Nodes.push_back(node);
+	if (Parent != -1) {
+		_Nodes[Parent].Children.push_back(index);
+	}
+	return index;
+}
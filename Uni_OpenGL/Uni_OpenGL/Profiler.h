@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////
+//
+// Profiler
+//
+////////////////////////////////////////////////////////////
+#ifndef PROFILER_H
+#define PROFILER_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <GLM\glm.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+
+class GpuTimer;
+class TextRenderer;
+
+////////////////////////////////////////////////////////////
+/// Engine Profiler
+/// --Hierarchical frame profiler. CPU scopes nest and are
+/// --keyed by their parent, so the same name under two
+/// --parents is two entries. GPU scopes also time their gpu
+/// --work with GL_TIME_ELAPSED queries; those queries cannot
+/// --nest, so a GPU scope inside another only gets CPU time.
+/// --Keeps a rolling window of frame times for the overlay
+/// --and can record every scope to a Chrome trace file
+/// --(chrome://tracing or ui.perfetto.dev).
+/// --Main thread only. Scope names must be string literals
+/// --or otherwise outlive the profiler.
+////////////////////////////////////////////////////////////
+class Profiler
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// Marks the frame boundaries, called once each by the
+	/// --engine loop. EndFrame moves this frames times into the
+	/// --rolling window.
+	////////////////////////////////////////////////////////////
+	void BeginFrame();
+	void EndFrame();
+
+	////////////////////////////////////////////////////////////
+	/// Opens and closes a scope, use the PROFILE_SCOPE macros
+	/// --rather than calling these directly.
+	////////////////////////////////////////////////////////////
+	void BeginScope(const char* Name);
+	void EndScope();
+	void BeginGpuScope(const char* Name);
+	void EndGpuScope();
+
+	////////////////////////////////////////////////////////////
+	/// Rolling average in milliseconds of the first scope with
+	/// --this name, 0 if it has not run.
+	/// --Gpu-- Read the gpu time rather than the cpu time.
+	////////////////////////////////////////////////////////////
+	float GetAverage(const char* Name, bool Gpu = false);
+
+	////////////////////////////////////////////////////////////
+	/// Draws the scope tree with average and worst times.
+	/// --Position-- Top left of the first line.
+	////////////////////////////////////////////////////////////
+	void RenderOverlay(TextRenderer* Text, glm::vec2 Position, float Scale);
+
+	////////////////////////////////////////////////////////////
+	/// Records every scope from now until StopTrace, which
+	/// --writes them out as Chrome trace event JSON.
+	////////////////////////////////////////////////////////////
+	void StartTrace(std::string FilePath);
+	bool StopTrace();
+
+	////////////////////////////////////////////////////////////
+	/// Releases the gpu queries, must run while the GL context
+	/// --still exists.
+	////////////////////////////////////////////////////////////
+	void Shutdown();
+
+	////////////////////////////////////////////////////////////
+	/// Provides access to the only instance of the profiler.
+	////////////////////////////////////////////////////////////
+	static Profiler* Instance() {
+		return &_Instance;
+	};
+
+private:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	static const int HISTORY_SIZE = 120;			// Frames in the rolling window.
+	static const size_t MAX_TRACE_EVENTS = 4000000;	// Recording stops past this, about 100MB.
+
+	struct ScopeNode {
+		const char* Name;
+		int Parent;
+		int Depth;
+		bool Gpu;
+		GpuTimer* Timer;
+		std::vector<int> Children;
+		double Start;					// Microseconds since launch of the open call.
+		float FrameTime;				// Milliseconds summed over this frame.
+		int FrameCalls;
+		float History[HISTORY_SIZE];	// Cpu milliseconds per frame.
+		float GpuHistory[HISTORY_SIZE];	// Gpu milliseconds per frame, a few frames late.
+	};
+
+	struct TraceEvent {
+		int Node;
+		double Start;		// Microseconds since launch.
+		double Duration;	// Microseconds.
+	};
+
+	struct GpuSample {
+		int Node;
+		double Time;		// Microseconds since launch, when the frame started.
+		float Value;		// Milliseconds.
+	};
+
+	////////////////////////////////////////////////////////////
+	// Member Data
+	////////////////////////////////////////////////////////////
+	static Profiler _Instance;		// Static Instance of Profiler
+
+	std::vector<ScopeNode> _Nodes;
+	std::vector<int> _Stack;		// Open scopes, innermost last.
+	int _GpuScope;					// Node whose query is running, -1 if none.
+	int _HistoryIndex;
+	int _HistoryFrames;
+	Clock::time_point _Epoch;
+
+	bool _Tracing;
+	std::string _TraceFile;
+	std::vector<TraceEvent> _TraceEvents;
+	std::vector<GpuSample> _GpuSamples;	// Gpu times written as counter tracks.
+	double _FrameStart;
+
+	double Now();
+	int FindChild(int Parent, const char* Name, bool Gpu);
+	void RenderNode(TextRenderer* Text, int Node, glm::vec2& Position, float Scale);
+
+	Profiler();
+	~Profiler() {}
+	Profiler(const Profiler&) {}
+};
+
+////////////////////////////////////////////////////////////
+/// Closes the scope when it goes out of scope.
+////////////////////////////////////////////////////////////
+class ProfileScope
+{
+public:
+	ProfileScope(const char* Name) { Profiler::Instance()->BeginScope(Name); }
+	~ProfileScope() { Profiler::Instance()->EndScope(); }
+};
+
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(const char* Name) { Profiler::Instance()->BeginGpuScope(Name); }
+	~GpuProfileScope() { Profiler::Instance()->EndGpuScope(); }
+};
+
+////////////////////////////////////////////////////////////
+/// Define PROFILER_DISABLED to compile every scope out.
+////////////////////////////////////////////////////////////
+#define PROFILE_JOIN_INNER(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_INNER(a, b)
+#ifndef PROFILER_DISABLED
+#define PROFILE_SCOPE(Name) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(Name)
+#define PROFILE_GPU_SCOPE(Name) GpuProfileScope PROFILE_JOIN(profileScope, __LINE__)(Name)
+#else
+#define PROFILE_SCOPE(Name)
+#define PROFILE_GPU_SCOPE(Name)
+#endif
+
+#endif
@@ -0,0 +1,191 @@
+#include "ProgramCache.h"
+#include "LogManager.h"
+
+#include <GLEW\glew.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static const char CACHE_MAGIC[4] = { 'U', 'G', 'P', 'C' };
+static const uint32_t CACHE_VERSION = 1;
+
+ProgramCache::ProgramCache() :
+	_DriverHash(0),
+	_Supported(false),
+	_Dirty(false)
+{
+}
+
+void ProgramCache::Load(const std::string& filePath)
+{
+	_FilePath = filePath;
+	_Entries.clear();
+
+	GLint formats = 0;
+	if (GLEW_ARB_get_program_binary) {
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	}
+	_Supported = formats > 0;
+	if (!_Supported) {
+		LogManager::Instance()->LogInfo("Program binaries are not supported by this driver, shaders compile from source.");
+		return;
+	}
+
+	uint64_t hash = 14695981039346656037ull;
+	const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (GLenum name : strings) {
+		const char* value = (const char*)glGetString(name);
+		if (value != nullptr) {
+			hash = Hash(value, std::strlen(value) + 1, hash);
+		}
+	}
+	_DriverHash = hash;
+
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		return;
+	}
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t count = 0;
+	file.read(magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	file.read((char*)&count, sizeof(count));
+	if (!file || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || version != CACHE_VERSION) {
+		LogManager::Instance()->LogWarning("Program cache " + filePath + " is not a cache file or is out of date, ignoring it.");
+		return;
+	}
+	//sizes are checked against what is left so a corrupt file cannot ask for gigabytes.
+	std::streamoff position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff fileSize = file.tellg();
+	file.seekg(position);
+	for (uint32_t i = 0; i < count; i++) {
+		uint64_t key = 0;
+		uint32_t size = 0;
+		Entry entry;
+		entry.Format = 0;
+		entry.Used = false;
+		file.read((char*)&key, sizeof(key));
+		file.read((char*)&entry.Format, sizeof(entry.Format));
+		file.read((char*)&size, sizeof(size));
+		if (!file) {
+			break;
+		}
+		if ((std::streamoff)size > fileSize - file.tellg()) {
+			LogManager::Instance()->LogWarning("Program cache " + filePath + " has an entry larger than the file, later entries are ignored.");
+			break;
+		}
+		entry.Binary.resize(size);
+		file.read(entry.Binary.data(), size);
+		if (!file) {
+			LogManager::Instance()->LogWarning("Program cache " + filePath + " is truncated, later entries are ignored.");
+			break;
+		}
+		_Entries[key] = std::move(entry);
+	}
+}
+
+void ProgramCache::Save()
+{
+	if (!_Supported) {
+		return;
+	}
+	uint32_t count = 0;
+	for (auto& e : _Entries) {
+		if (e.second.Used) {
+			count++;
+		}
+	}
+	//a warm start that used every entry has nothing to write.
+	if (!_Dirty && count == _Entries.size()) {
+		return;
+	}
+	std::ofstream file(_FilePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		LogManager::Instance()->LogWarning("Could not write program cache " + _FilePath);
+		return;
+	}
+	file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	file.write((const char*)&CACHE_VERSION, sizeof(CACHE_VERSION));
+	file.write((const char*)&count, sizeof(count));
+	for (auto& e : _Entries) {
+		if (!e.second.Used) {
+			continue;
+		}
+		uint32_t size = (uint32_t)e.second.Binary.size();
+		file.write((const char*)&e.first, sizeof(e.first));
+		file.write((const char*)&e.second.Format, sizeof(e.second.Format));
+		file.write((const char*)&size, sizeof(size));
+		file.write(e.second.Binary.data(), size);
+	}
+	for (auto e = _Entries.begin(); e != _Entries.end();) {
+		e = e->second.Used ? std::next(e) : _Entries.erase(e);
+	}
+	_Dirty = false;
+}
+
+uint64_t ProgramCache::MakeKey(const std::string& vertexCode, const std::string& fragmentCode) const
+{
+	//the sizes go in too so moving text between the stages changes the key.
+	uint64_t hash = _DriverHash;
+	uint64_t sizes[2] = { vertexCode.size(), fragmentCode.size() };
+	hash = Hash((const char*)sizes, sizeof(sizes), hash);
+	hash = Hash(vertexCode.data(), vertexCode.size(), hash);
+	hash = Hash(fragmentCode.data(), fragmentCode.size(), hash);
+	return hash;
+}
+
+bool ProgramCache::Restore(uint64_t key, unsigned int program)
+{
+	if (!_Supported) {
+		return false;
+	}
+	auto search = _Entries.find(key);
+	if (search == _Entries.end()) {
+		return false;
+	}
+	Entry& entry = search->second;
+	glProgramBinary(program, entry.Format, entry.Binary.data(), (GLsizei)entry.Binary.size());
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked != GL_TRUE) {
+		//the driver can reject a binary even when the strings match, it gets rebuilt and stored again.
+		_Entries.erase(search);
+		_Dirty = true;
+		return false;
+	}
+	entry.Used = true;
+	return true;
+}
+
+void ProgramCache::Store(uint64_t key, unsigned int program)
+{
+	if (!_Supported) {
+		return;
+	}
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+	Entry entry;
+	entry.Format = 0;
+	entry.Used = true;
+	entry.Binary.resize(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, nullptr, &format, entry.Binary.data());
+	entry.Format = format;
+	_Entries[key] = std::move(entry);
+	_Dirty = true;
+}
+
+uint64_t ProgramCache::Hash(const char* data, size_t size, uint64_t hash)
+{
+	//64 bit FNV-1a.
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
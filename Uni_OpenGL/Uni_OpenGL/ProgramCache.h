@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// Linked program binaries saved between runs so startup
+/// --can skip the driver compile. Entries are keyed by a hash
+/// --of the shader sources and the driver vendor, renderer and
+/// --version strings, so an edited shader or a driver update
+/// --misses and falls back to compiling from source.
+/// --Needs ARB_get_program_binary, without it nothing is
+/// --stored and every lookup misses.
+////////////////////////////////////////////////////////////
+class ProgramCache
+{
+public:
+	ProgramCache();
+
+	//reads the cache file, needs a current gl context for the driver strings.
+	void Load(const std::string& filePath);
+	//writes the entries used or stored this run, older entries are dropped.
+	void Save();
+
+	bool IsSupported() const { return _Supported; }
+
+	//key for a program built from these stages on this driver.
+	uint64_t MakeKey(const std::string& vertexCode, const std::string& fragmentCode) const;
+
+	//loads a binary into program, false if there is none or the driver rejects it.
+	bool Restore(uint64_t key, unsigned int program);
+	//reads the binary back from a linked program.
+	void Store(uint64_t key, unsigned int program);
+
+private:
+	struct Entry {
+		unsigned int Format;
+		std::vector<char> Binary;
+		bool Used;
+	};
+
+	static uint64_t Hash(const char* data, size_t size, uint64_t hash);
+
+	std::unordered_map<uint64_t, Entry> _Entries;
+	std::string _FilePath;
+	uint64_t _DriverHash;
+	bool _Supported;
+	bool _Dirty;
+};
@@ -23,11 +23,12 @@ void RadioButton::Update(float delta)
 
 void RadioButton::Render()
 {
-	ShaderManager::Instance()->GetShader(_Shader)->SetVec3("color", glm::vec3(1.0, 1.0, 1.0));
-	ShaderManager::Instance()->GetShader(_Shader)->SetBool("RenderingText", false);
+	Shader* shader = ShaderManager::Instance()->BindShader(_Shader);
+	shader->SetVec3("color", glm::vec3(1.0, 1.0, 1.0));
+	shader->SetBool("RenderingText", false);
 	glm::mat4 model(1.0f);
 	model = glm::translate(model, glm::vec3(_Position, 0));
-	ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+	shader->SetMat4("model", model);
 	if (_IsOn) {
 		_ButtonOnSprite->Render();
 	}
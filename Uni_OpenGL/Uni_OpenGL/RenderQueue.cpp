@@ -0,0 +1,289 @@
+#include "RenderQueue.h"
+#include "Model.h"
+#include "InstanceBatch.h"
+#include "ShaderManager.h"
+#include "RenderState.h"
+#include "LogManager.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+RenderQueue::RenderQueue() :
+	_DepthPrePass(false),
+	_CameraPosition(0.0f)
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::Begin(const glm::vec3& cameraPosition)
+{
+	//clear keeps the capacity so after the first frame this doesnt allocate.
+	_Commands.clear();
+	_Keys.clear();
+	_CameraPosition = cameraPosition;
+}
+
+void RenderQueue::Submit(Model* model, const glm::mat4& world, ShaderID shader, RenderPass pass)
+{
+	for (auto& mesh : model->GetMeshes()) {
+		Submit(&mesh, world, shader, pass);
+	}
+}
+
+void RenderQueue::Submit(Mesh* mesh, const glm::mat4& world, ShaderID shader, RenderPass pass)
+{
+	RenderCommand command;
+	command.DrawMesh = mesh;
+	command.InstanceCount = 0;
+	command.ShaderSlot = GetShaderSlot(shader);
+	command.World = world;
+
+	SortEntry entry;
+	entry.Key = MakeKey(pass, command.ShaderSlot, mesh->GetMaterialID(), world);
+	entry.Command = (unsigned int)_Commands.size();
+
+	_Commands.push_back(command);
+	_Keys.push_back(entry);
+}
+
+void RenderQueue::Submit(InstanceBatch* batch, RenderPass pass)
+{
+	if (batch->GetCount() == 0) {
+		return;
+	}
+	unsigned int shaderSlot = GetShaderSlot(batch->GetShader());
+	for (auto& mesh : batch->GetModel()->GetMeshes()) {
+		RenderCommand command;
+		command.DrawMesh = &mesh;
+		command.InstanceCount = batch->GetCount();
+		command.ShaderSlot = shaderSlot;
+		command.World = glm::mat4(1.0f);
+
+		//instances are spread out, so only the program and material matter for the order.
+		SortEntry entry;
+		entry.Key = MakeKey(pass, shaderSlot, mesh.GetMaterialID(), command.World);
+		entry.Key &= ~(uint64_t)0xFFFFFFFF;
+		entry.Command = (unsigned int)_Commands.size();
+
+		_Commands.push_back(command);
+		_Keys.push_back(entry);
+	}
+}
+
+void RenderQueue::Submit(std::function<void()> draw, const glm::mat4& world, ShaderID shader, RenderPass pass, std::function<void()> depthDraw)
+{
+	RenderCommand command;
+	command.DrawMesh = nullptr;
+	command.InstanceCount = 0;
+	command.Draw = draw;
+	command.DepthDraw = depthDraw;
+	command.ShaderSlot = GetShaderSlot(shader);
+	command.World = world;
+
+	SortEntry entry;
+	entry.Key = MakeKey(pass, command.ShaderSlot, 0, world);
+	entry.Command = (unsigned int)_Commands.size();
+
+	_Commands.push_back(command);
+	_Keys.push_back(entry);
+}
+
+void RenderQueue::SetShaderSetup(ShaderID shader, std::function<void(Shader*)> setup)
+{
+	_ShaderSlots[GetShaderSlot(shader)].Setup = setup;
+}
+
+void RenderQueue::Flush()
+{
+	PROFILE_SCOPE("RenderQueue::Flush");
+	std::sort(_Keys.begin(), _Keys.end(), [](const SortEntry& a, const SortEntry& b) { return a.Key < b.Key; });
+
+	for (auto& slot : _ShaderSlots) {
+		slot.SetThisFrame = false;
+		//permutations can hand back a different program when the features change.
+		if (slot.Program != nullptr) {
+			Shader* program = ShaderManager::Instance()->GetShader(slot.ID);
+			if (program != slot.Program) {
+				slot.Program = program;
+				slot.Version = ~0u;
+			}
+		}
+	}
+
+	if (_DepthPrePass) {
+		Profiler::Instance()->BeginGpuScope("Depth pre-pass");
+		DrawDepthPrePass();
+		Profiler::Instance()->EndGpuScope();
+		//depth is already final, so only the nearest fragment passes. writes stay on
+		//for opaque draws that had no depth version.
+		glDepthFunc(GL_LEQUAL);
+	}
+
+	unsigned int currentSlot = ~0u;
+	Shader* shader = nullptr;
+	Mesh* lastMaterial = nullptr;
+	bool opaque = true;
+	Profiler::Instance()->BeginGpuScope("Opaque");
+	for (auto& entry : _Keys) {
+		RenderCommand& command = _Commands[entry.Command];
+		ShaderSlot& slot = _ShaderSlots[command.ShaderSlot];
+		if (slot.Program == nullptr) {
+			continue;
+		}
+		if (opaque && (entry.Key >> 60) != PASS_OPAQUE) {
+			Profiler::Instance()->EndGpuScope();
+			glDepthFunc(GL_LESS);
+			opaque = false;
+		}
+
+		if (command.ShaderSlot != currentSlot) {
+			shader = slot.Program;
+			shader->Use();
+			if (slot.Version != shader->GetVersion()) {
+				slot.Model = shader->GetUniform("model");
+				slot.Version = shader->GetVersion();
+			}
+			currentSlot = command.ShaderSlot;
+			lastMaterial = nullptr;
+			//per frame uniforms outside the uniform blocks only need setting once per program.
+			if (!slot.SetThisFrame) {
+				if (slot.Setup) {
+					slot.Setup(shader);
+				}
+				slot.SetThisFrame = true;
+			}
+		}
+		//instanced draws read their matrices from the instance buffer and get identity here.
+		shader->SetMat4(slot.Model, command.World);
+
+		if (command.DrawMesh != nullptr) {
+			if (lastMaterial == nullptr || !command.DrawMesh->SameMaterial(*lastMaterial)) {
+				command.DrawMesh->BindMaterial(shader);
+				lastMaterial = command.DrawMesh;
+			}
+			if (command.InstanceCount > 0) {
+				command.DrawMesh->DrawInstanced(command.InstanceCount);
+			}
+			else {
+				command.DrawMesh->Draw();
+			}
+		}
+		else {
+			//custom draws can bind anything, so assume nothing carries over.
+			command.Draw();
+			currentSlot = ~0u;
+			lastMaterial = nullptr;
+		}
+	}
+	if (opaque) {
+		Profiler::Instance()->EndGpuScope();
+		glDepthFunc(GL_LESS);
+	}
+	RenderState::Instance()->BindVertexArray(0);
+}
+
+void RenderQueue::DrawDepthPrePass()
+{
+	//strictly front to back, state changes are cheap next to the fill this saves.
+	_DepthKeys.clear();
+	for (auto& entry : _Keys) {
+		if ((entry.Key >> 60) != PASS_OPAQUE) {
+			break;
+		}
+		SortEntry depthEntry;
+		depthEntry.Key = entry.Key & 0xFFFFFFFF;
+		depthEntry.Command = entry.Command;
+		_DepthKeys.push_back(depthEntry);
+	}
+	if (_DepthKeys.empty()) {
+		return;
+	}
+	std::sort(_DepthKeys.begin(), _DepthKeys.end(), [](const SortEntry& a, const SortEntry& b) { return a.Key < b.Key; });
+
+	Shader* depth = _ShaderSlots[GetShaderSlot(SHADER_ID("depth"))].Program;
+	Shader* depthInstanced = _ShaderSlots[GetShaderSlot(SHADER_ID("depthInstanced"))].Program;
+	if (depth == nullptr || depthInstanced == nullptr) {
+		return;
+	}
+	UniformHandle depthModel = depth->GetUniform("model");
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	for (auto& entry : _DepthKeys) {
+		RenderCommand& command = _Commands[entry.Command];
+		if (command.DrawMesh != nullptr && command.InstanceCount > 0) {
+			depthInstanced->Use();
+			command.DrawMesh->DrawDepthInstanced(command.InstanceCount);
+		}
+		else if (command.DrawMesh != nullptr) {
+			depth->Use();
+			depth->SetMat4(depthModel, command.World);
+			command.DrawMesh->DrawDepth();
+		}
+		else if (command.DepthDraw) {
+			depth->Use();
+			depth->SetMat4(depthModel, command.World);
+			command.DepthDraw();
+		}
+	}
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+float RenderQueue::GetPrePassTime()
+{
+	return _DepthPrePass ? Profiler::Instance()->GetAverage("Depth pre-pass", true) : 0.0f;
+}
+
+float RenderQueue::GetOpaqueTime()
+{
+	return Profiler::Instance()->GetAverage("Opaque", true);
+}
+
+unsigned int RenderQueue::GetShaderSlot(ShaderID shader)
+{
+	auto search = _ShaderSlotLookup.find(shader.Hash);
+	if (search != _ShaderSlotLookup.end()) {
+		return search->second;
+	}
+
+	ShaderSlot slot;
+	slot.ID = shader;
+	slot.SetThisFrame = false;
+	slot.Version = 0;
+	//the manager logs unknown shaders, the slot stays empty and its draws are skipped.
+	slot.Program = ShaderManager::Instance()->GetShader(shader);
+	if (slot.Program != nullptr) {
+		slot.Model = slot.Program->GetUniform("model");
+		slot.Version = slot.Program->GetVersion();
+	}
+	if (_ShaderSlots.size() >= (1 << SHADER_BITS)) {
+		LogManager::Instance()->LogWarning("Render queue has more shaders than the sort key can hold, sorting will be off.");
+	}
+
+	unsigned int index = (unsigned int)_ShaderSlots.size();
+	_ShaderSlots.push_back(slot);
+	_ShaderSlotLookup.emplace(shader.Hash, index);
+	return index;
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, unsigned int shader, unsigned int material, const glm::mat4& world)
+{
+	//positive floats sort the same as their bits, so squared distance can go straight in.
+	glm::vec3 offset = glm::vec3(world[3]) - _CameraPosition;
+	float distance = glm::dot(offset, offset);
+	uint32_t depth;
+	std::memcpy(&depth, &distance, sizeof(depth));
+	if (pass == PASS_TRANSPARENT) {
+		depth = ~depth;
+	}
+
+	uint64_t key = 0;
+	key |= (uint64_t)(pass & 0xF) << 60;
+	key |= (uint64_t)(shader & ((1 << SHADER_BITS) - 1)) << 52;
+	key |= (uint64_t)(material & ((1 << MATERIAL_BITS) - 1)) << 32;
+	key |= depth;
+	return key;
+}
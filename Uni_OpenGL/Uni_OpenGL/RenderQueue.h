@@ -0,0 +1,142 @@
+#pragma once
+
+#include "Shaders\Shader.h"
+#include "ShaderID.h"
+
+#include <GLM\glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class InstanceBatch;
+class Model;
+
+////////////////////////////////////////////////////////////
+/// Passes are drawn in this order, the pass is the top
+/// --bits of the sort key.
+////////////////////////////////////////////////////////////
+enum RenderPass {
+	PASS_OPAQUE = 0,
+	PASS_SKY,
+	PASS_TRANSPARENT,
+	PASS_DEBUG,
+	PASS_COUNT
+};
+
+////////////////////////////////////////////////////////////
+/// Collects the draws for a frame and sorts them so that
+/// --draws sharing a program and material end up next to
+/// --each other, then executes them only changing the state
+/// --that differs from the draw before.
+/// --Sort key layout, high to low bits:
+/// --  pass 4 | shader 8 | material 20 | depth 32
+/// --Opaque draws are front to back inside a material,
+/// --transparent draws back to front.
+/// --With the depth pre-pass on, opaque draws are first
+/// --drawn strictly front to back into the depth buffer
+/// --with a position only program, then shaded with
+/// --GL_LEQUAL so each visible pixel is lit once.
+////////////////////////////////////////////////////////////
+class RenderQueue
+{
+public:
+	RenderQueue();
+	~RenderQueue();
+
+	////////////////////////////////////////////////////////////
+	/// Clears last frames draws and stores the camera position
+	/// --used to work out depth. The view and projection come
+	/// --from the Camera uniform block.
+	////////////////////////////////////////////////////////////
+	void Begin(const glm::vec3& cameraPosition);
+
+	////////////////////////////////////////////////////////////
+	/// Queues every mesh of a model with one world matrix.
+	////////////////////////////////////////////////////////////
+	void Submit(Model* model, const glm::mat4& world, ShaderID shader, RenderPass pass = PASS_OPAQUE);
+	void Submit(Mesh* mesh, const glm::mat4& world, ShaderID shader, RenderPass pass = PASS_OPAQUE);
+
+	////////////////////////////////////////////////////////////
+	/// Queues one instanced draw per mesh of the batch model.
+	/// --The batch must already be uploaded for this frame.
+	////////////////////////////////////////////////////////////
+	void Submit(InstanceBatch* batch, RenderPass pass = PASS_OPAQUE);
+
+	////////////////////////////////////////////////////////////
+	/// Queues something that draws itself. The program is
+	/// --bound and its model matrix set before draw is called.
+	/// --depthDraw is optional and draws the same geometry for
+	/// --the depth pre-pass with the attributes at location 0,
+	/// --opaque draws without one are left out of the pre-pass.
+	////////////////////////////////////////////////////////////
+	void Submit(std::function<void()> draw, const glm::mat4& world, ShaderID shader, RenderPass pass, std::function<void()> depthDraw = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// Uniforms that only change once a frame, like lights.
+	/// --Called the first time the program is bound in a flush
+	/// --so programs nothing was drawn with are skipped.
+	////////////////////////////////////////////////////////////
+	void SetShaderSetup(ShaderID shader, std::function<void(Shader*)> setup);
+
+	////////////////////////////////////////////////////////////
+	/// Sorts and draws everything submitted since Begin.
+	////////////////////////////////////////////////////////////
+	void Flush();
+
+	int GetSubmissionCount() { return (int)_Commands.size(); }
+
+	void SetDepthPrePass(bool enabled) { _DepthPrePass = enabled; }
+	bool GetDepthPrePass() { return _DepthPrePass; }
+
+	////////////////////////////////////////////////////////////
+	/// Profiler rolling average gpu time of the pre-pass and
+	/// --the opaque pass in milliseconds.
+	////////////////////////////////////////////////////////////
+	float GetPrePassTime();
+	float GetOpaqueTime();
+
+private:
+	static const int SHADER_BITS = 8;
+	static const int MATERIAL_BITS = 20;
+
+	struct RenderCommand {
+		Mesh* DrawMesh;
+		int InstanceCount;
+		std::function<void()> Draw;
+		std::function<void()> DepthDraw;
+		unsigned int ShaderSlot;
+		glm::mat4 World;
+	};
+
+	struct SortEntry {
+		uint64_t Key;
+		unsigned int Command;
+	};
+
+	struct ShaderSlot {
+		ShaderID ID;
+		Shader* Program;
+		UniformHandle Model;
+		unsigned int Version;	// Program version Model was fetched from.
+		std::function<void(Shader*)> Setup;
+		bool SetThisFrame;
+	};
+
+	unsigned int GetShaderSlot(ShaderID shader);
+	uint64_t MakeKey(RenderPass pass, unsigned int shader, unsigned int material, const glm::mat4& world);
+	void DrawDepthPrePass();
+
+	std::vector<RenderCommand> _Commands;
+	std::vector<SortEntry> _Keys;
+	std::vector<SortEntry> _DepthKeys;
+
+	bool _DepthPrePass;
+
+	std::vector<ShaderSlot> _ShaderSlots;
+	std::unordered_map<uint32_t, unsigned int> _ShaderSlotLookup;	// ShaderID hash to slot.
+
+	glm::vec3 _CameraPosition;
+};
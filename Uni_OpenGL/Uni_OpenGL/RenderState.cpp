@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "RenderState.h"
+#include "StatsManager.h"
+
+////////////////////////////////////////////////////////////
+// Static Variables
+////////////////////////////////////////////////////////////
+RenderState RenderState::_Instance;
+
+////////////////////////////////////////////////////////////
+RenderState::RenderState()
+{
+	Invalidate();
+}
+
+////////////////////////////////////////////////////////////
+bool RenderState::UseProgram(unsigned int Program)
+{
+	if (_Program == Program) {
+		return false;
+	}
+	glUseProgram(Program);
+	_Program = Program;
+	STATS_ADD(STAT_PROGRAM_SWITCHES, 1);
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+void RenderState::BindTexture(int Unit, unsigned int Texture, GLenum Target)
+{
+	//units past the shadowed range are always bound.
+	if (Unit < MAX_TEXTURE_UNITS && _Textures[Unit] == Texture && _Targets[Unit] == Target) {
+		return;
+	}
+	if (_ActiveUnit != Unit) {
+		glActiveTexture(GL_TEXTURE0 + Unit);
+		_ActiveUnit = Unit;
+	}
+	glBindTexture(Target, Texture);
+	if (Unit < MAX_TEXTURE_UNITS) {
+		_Textures[Unit] = Texture;
+		_Targets[Unit] = Target;
+	}
+	STATS_ADD(STAT_TEXTURE_BINDS, 1);
+}
+
+////////////////////////////////////////////////////////////
+void RenderState::BindVertexArray(unsigned int VertexArray)
+{
+	if (_VertexArray == VertexArray) {
+		return;
+	}
+	glBindVertexArray(VertexArray);
+	_VertexArray = VertexArray;
+}
+
+////////////////////////////////////////////////////////////
+void RenderState::DrawElements(GLenum Mode, int Count)
+{
+	glDrawElements(Mode, Count, GL_UNSIGNED_INT, 0);
+	STATS_ADD(STAT_DRAW_CALLS, 1);
+}
+
+////////////////////////////////////////////////////////////
+void RenderState::DrawArrays(GLenum Mode, int First, int Count)
+{
+	glDrawArrays(Mode, First, Count);
+	STATS_ADD(STAT_DRAW_CALLS, 1);
+}
+
+////////////////////////////////////////////////////////////
+void RenderState::DrawElementsInstanced(GLenum Mode, int Count, int Instances)
+{
+	glDrawElementsInstanced(Mode, Count, GL_UNSIGNED_INT, 0, Instances);
+	STATS_ADD(STAT_DRAW_CALLS, 1);
+}
+
+////////////////////////////////////////////////////////////
+void RenderState::Invalidate()
+{
+	//zero is a valid binding so use a value gl never hands out.
+	_Program = ~0u;
+	_VertexArray = ~0u;
+	_ActiveUnit = -1;
+	for (int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+		_Textures[i] = ~0u;
+		_Targets[i] = 0;
+	}
+}
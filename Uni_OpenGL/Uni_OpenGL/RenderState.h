@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////
+//
+// Render State
+//
+////////////////////////////////////////////////////////////
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <GLEW\glew.h>
+
+////////////////////////////////////////////////////////////
+/// Engine RenderState
+/// --Shadows the bits of GL state that change the most
+/// --between draws (program, textures, vertex array) so a
+/// --bind that would not change anything is skipped, and
+/// --counts the binds and draws that do go through in the
+/// --StatsManager.
+/// --Code that calls GL directly should call Invalidate
+/// --afterwards so the shadow copy does not go stale.
+////////////////////////////////////////////////////////////
+class RenderState
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// Binds a program if it is not already bound.
+	/// --Returns true if the program changed.
+	////////////////////////////////////////////////////////////
+	bool UseProgram(unsigned int Program);
+
+	////////////////////////////////////////////////////////////
+	/// Binds a texture to a unit if it is not already there.
+	/// --Unit-- Zero based texture unit.
+	/// --Target-- GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP etc.
+	////////////////////////////////////////////////////////////
+	void BindTexture(int Unit, unsigned int Texture, GLenum Target = GL_TEXTURE_2D);
+
+	////////////////////////////////////////////////////////////
+	/// Binds a vertex array if it is not already bound.
+	////////////////////////////////////////////////////////////
+	void BindVertexArray(unsigned int VertexArray);
+
+	////////////////////////////////////////////////////////////
+	/// Counted wrappers around the GL draw calls.
+	////////////////////////////////////////////////////////////
+	void DrawElements(GLenum Mode, int Count);
+	void DrawArrays(GLenum Mode, int First, int Count);
+	void DrawElementsInstanced(GLenum Mode, int Count, int Instances);
+
+	////////////////////////////////////////////////////////////
+	/// Forgets the shadowed state so the next bind of each
+	/// --kind always reaches GL.
+	////////////////////////////////////////////////////////////
+	void Invalidate();
+
+	////////////////////////////////////////////////////////////
+	/// Provides access to the only instance of the render
+	/// state.
+	////////////////////////////////////////////////////////////
+	static RenderState* Instance() {
+		return &_Instance;
+	};
+
+private:
+	////////////////////////////////////////////////////////////
+	// Member Data
+	////////////////////////////////////////////////////////////
+	static RenderState _Instance;		// Static Instance of RenderState
+
+	static const int MAX_TEXTURE_UNITS = 16;
+
+	unsigned int _Program;						// Currently bound program.
+	unsigned int _VertexArray;					// Currently bound vertex array.
+	int _ActiveUnit;							// Currently active texture unit.
+	unsigned int _Textures[MAX_TEXTURE_UNITS];	// Texture bound to each unit.
+	GLenum _Targets[MAX_TEXTURE_UNITS];			// Target each texture was bound to.
+
+	RenderState();
+	~RenderState() {}
+	RenderState(const RenderState&) {}
+};
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////
+/// Lock free single producer single consumer ring buffer.
+/// --One thread may Push and one other thread may Pop at
+/// --the same time without locking. Capacity must be a
+/// --power of two.
+////////////////////////////////////////////////////////////
+template<typename T, size_t Capacity>
+class SPSCQueue
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+public:
+	SPSCQueue() : _Head(0), _Tail(0) {}
+
+	//producer side, returns false if the queue is full.
+	bool Push(const T& item) {
+		size_t tail = _Tail.load(std::memory_order_relaxed);
+		if (tail - _Head.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		_Buffer[tail & (Capacity - 1)] = item;
+		_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//consumer side, returns false if the queue is empty.
+	bool Pop(T& item) {
+		size_t head = _Head.load(std::memory_order_relaxed);
+		if (head == _Tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = _Buffer[head & (Capacity - 1)];
+		_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Empty() const {
+		return _Head.load(std::memory_order_acquire) == _Tail.load(std::memory_order_acquire);
+	}
+
+private:
+	//head and tail on their own cache lines so the two threads dont fight over one line.
+	alignas(64) std::atomic<size_t> _Head;	//next slot to read, written by the consumer
+	alignas(64) std::atomic<size_t> _Tail;	//next slot to write, written by the producer
+	alignas(64) T _Buffer[Capacity];
+};
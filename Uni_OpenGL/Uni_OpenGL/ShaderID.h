@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////
+//
+// ShaderID
+//
+////////////////////////////////////////////////////////////
+#ifndef SHADER_ID_H
+#define SHADER_ID_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////
+/// Engine ShaderID
+/// --Interned shader key, the 32 bit FNV-1a hash of the name
+/// --the shader was added with. Builds implicitly from a
+/// --string so existing string keys keep working, use the
+/// --SHADER_ID macro to hash a literal at compile time.
+////////////////////////////////////////////////////////////
+struct ShaderID
+{
+	uint32_t Hash;
+
+	constexpr ShaderID() : Hash(0) {}
+	constexpr ShaderID(const char* Name) : Hash(HashName(Name)) {}
+	ShaderID(const std::string& Name) : Hash(HashName(Name.c_str())) {}
+
+	////////////////////////////////////////////////////////////
+	/// Wraps a hash that has already been worked out.
+	////////////////////////////////////////////////////////////
+	static constexpr ShaderID FromHash(uint32_t Hash) {
+		return ShaderID(Hash, 0);
+	}
+
+	bool operator==(const ShaderID& Other) const { return Hash == Other.Hash; }
+	bool operator!=(const ShaderID& Other) const { return Hash != Other.Hash; }
+
+	////////////////////////////////////////////////////////////
+	/// FNV-1a, recursive so it is a constant expression.
+	////////////////////////////////////////////////////////////
+	static constexpr uint32_t HashName(const char* Name, uint32_t Hash = 2166136261u) {
+		return *Name == '\0' ? Hash : HashName(Name + 1, (Hash ^ (uint32_t)(unsigned char)*Name) * 16777619u);
+	}
+
+private:
+	constexpr ShaderID(uint32_t Hash, int) : Hash(Hash) {}
+};
+
+////////////////////////////////////////////////////////////
+/// Hashes a string literal at compile time.
+////////////////////////////////////////////////////////////
+#define SHADER_ID(Name) ShaderID::FromHash(std::integral_constant<uint32_t, ShaderID::HashName(Name)>::value)
+
+#endif
@@ -3,76 +3,402 @@
 ////////////////////////////////////////////////////////////
 #include "ShaderManager.h"
 #include "LogManager.h"
+#include "RenderState.h"
+#include "FrameUniforms.h"
+
+#include <GLEW\glew.h>
+
+#include <algorithm>
+#include <cstdio>
 
 ////////////////////////////////////////////////////////////
 // Static Variables
 ////////////////////////////////////////////////////////////
 ShaderManager ShaderManager::_Instance;
 
+static const int INITIAL_TABLE_SIZE = 64;	// Power of two, kept under half full.
+static const float POLL_INTERVAL = 0.25f;	// Seconds between checks for edited shader files.
+
 ////////////////////////////////////////////////////////////
 ShaderManager::ShaderManager() :
-	_CurrentShader("")
+	_Table(INITIAL_TABLE_SIZE, -1),
+	_CacheEnabled(false),
+	_HotReload(false),
+	_SincePoll(0.0f),
+	_Variant(0)
+{
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::UseProgramCache(const std::string& FilePath)
 {
+	_Cache.Load(FilePath);
+	_CacheEnabled = _Cache.IsSupported();
+
+	//let the driver use as many compiler threads as it likes.
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+	else if (GLEW_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+	}
 }
 
 ////////////////////////////////////////////////////////////
 ShaderManager::~ShaderManager()
 {
-	//loop through all shaders in map, and delete all shader
+	//loop through all shaders, and delete all shader
 	//pointers.
 	for (auto const& s : _Shaders) {
-		delete s.second;
+		delete s.Program;
+		delete s.Rebuild;
 	}
-	//clear the map once all shaders are deleted.
+	//clear the list once all shaders are deleted.
 	_Shaders.clear();
 }
 
 ////////////////////////////////////////////////////////////
-void ShaderManager::AddShader(std::string Key, std::string FileName)
+void ShaderManager::AddShader(const std::string& Key, const std::string& FileName)
+{
+	AddShader(Key, FileName, FileName);
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::AddShader(const std::string& Key, const std::string& VertexFile, const std::string& FragmentFile)
+{
+	AddShader(Key, VertexFile, FragmentFile, std::vector<std::string>());
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::AddShader(const std::string& Key, const std::string& VertexFile, const std::string& FragmentFile, const std::vector<std::string>& Defines)
 {
 	//check to see if shader key already exists, if not then add new shader.
-	auto search = _Shaders.find(Key);
-	if (search != _Shaders.end()) {
-		LogManager::Instance()->LogWarning("This Shader Name already exists! Choose a new one!...");
+	ShaderID id(Key);
+	if (!CanAdd(id, Key)) {
+		return;
 	}
-	else {
-		Shader* newShader = new Shader(FileName);
-		_Shaders.emplace(std::make_pair(Key, newShader));
+
+	ShaderEntry entry;
+	entry.Key = id;
+	entry.Name = Key;
+	entry.Program = new Shader(VertexFile, FragmentFile, Defines, _CacheEnabled ? &_Cache : nullptr);
+	entry.VertexFile = VertexFile;
+	entry.FragmentFile = FragmentFile;
+	entry.Defines = Defines;
+	InsertEntry(entry);
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::AddPermutations(const std::string& Key, const std::string& VertexFile, const std::string& FragmentFile)
+{
+	ShaderID id(Key);
+	if (!CanAdd(id, Key)) {
+		return;
 	}
+
+	//the family only records how to build, FindVariant adds a program per feature set.
+	ShaderEntry entry;
+	entry.Key = id;
+	entry.Name = Key;
+	entry.Program = nullptr;
+	entry.VertexFile = VertexFile;
+	entry.FragmentFile = FragmentFile;
+	entry.Permutations = true;
+	InsertEntry(entry);
 }
 
 ////////////////////////////////////////////////////////////
-void ShaderManager::UseShader(std::string Key)
+void ShaderManager::SetFeature(ShaderFeature Feature, bool Enabled)
 {
-	//check to see if shader key already exists, if not then throw error message.
-	auto search = _Shaders.find(Key);
-	if (search != _Shaders.end()) {
-		_CurrentShader = Key;
-		_Shaders.at(_CurrentShader)->Use();
+	if (Enabled) {
+		_Variant |= Feature;
 	}
 	else {
-		LogManager::Instance()->LogWarning("This Shader does not exist!...");
+		_Variant &= ~(uint32_t)Feature;
 	}
 }
 
 ////////////////////////////////////////////////////////////
-Shader* ShaderManager::GetShader(std::string Key)
+void ShaderManager::SetPointLightCount(int Count)
 {
-	if (_CurrentShader != Key) {
-		UseShader(Key);
+	//no more than the Lights block holds.
+	Count = std::max(0, std::min(Count, (int)LightsBlock::MAX_POINT_LIGHTS));
+	_Variant = (_Variant & 0xFF) | ((uint32_t)Count << 8);
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::FinishLoading()
+{
+	bool pending = true;
+	while (pending) {
+		pending = false;
+		Shader* oldest = nullptr;
+		for (auto& s : _Shaders) {
+			if (s.Program == nullptr || s.Program->IsFinished()) {
+				continue;
+			}
+			if (s.Program->IsReady()) {
+				s.Program->Finish();
+			}
+			else {
+				pending = true;
+				if (oldest == nullptr) {
+					oldest = s.Program;
+				}
+			}
+		}
+		//nothing else is done, so wait on the one submitted first.
+		if (oldest != nullptr) {
+			oldest->Finish();
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::Shutdown()
+{
+	if (_CacheEnabled) {
+		_Cache.Save();
+	}
+}
+
+////////////////////////////////////////////////////////////
+Shader* ShaderManager::BindShader(ShaderID Key)
+{
+	Shader* program = GetShader(Key);
+	if (program != nullptr) {
+		//render state skips the gl call when the program is already bound.
+		program->Use();
 	}
+	return program;
+}
+
+////////////////////////////////////////////////////////////
+Shader* ShaderManager::GetShader(ShaderID Key)
+{
 	//check to see if shader key already exists, if not then throw error message.
-	auto search = _Shaders.find(Key);
-	if (search != _Shaders.end()) {
-		return _Shaders.at(Key);
+	int index = FindEntry(Key);
+	if (index != -1) {
+		if (_Shaders[index].Permutations) {
+			index = FindVariant(index);
+		}
+		Shader* program = _Shaders[index].Program;
+		if (!program->IsFinished()) {
+			program->Finish();
+		}
+		return program;
+	}
+	char message[64];
+	std::snprintf(message, sizeof(message), "Shader with id %08x does not exist!...", Key.Hash);
+	LogManager::Instance()->LogWarning(message);
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////
+const std::string& ShaderManager::GetName(ShaderID Key)
+{
+	static const std::string unknown = "unknown";
+	int index = FindEntry(Key);
+	return index != -1 ? _Shaders[index].Name : unknown;
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::SetHotReload(bool Enabled)
+{
+	_HotReload = Enabled;
+	_Watcher.Clear();
+	if (_HotReload) {
+		for (auto& s : _Shaders) {
+			if (s.Program != nullptr) {
+				WatchFiles(s.Program);
+			}
+		}
+		_PollTimer.Start();
+		_SincePoll = 0.0f;
+		LogManager::Instance()->LogInfo("Shader hot reload on, watching the Shaders folder.");
+	}
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::Update()
+{
+	if (!_HotReload) {
+		return;
+	}
+
+	_SincePoll += _PollTimer.GetDelta();
+	if (_SincePoll >= POLL_INTERVAL) {
+		_SincePoll = 0.0f;
+		for (auto& file : _Watcher.Poll()) {
+			for (auto& s : _Shaders) {
+				if (s.Program == nullptr) {
+					continue;
+				}
+				const std::vector<std::string>& files = s.Program->GetFiles();
+				if (std::find(files.begin(), files.end(), file) != files.end()) {
+					StartRebuild(s);
+				}
+			}
+		}
+	}
+
+	//rebuilds are only waited on once the driver says they are done.
+	for (auto& s : _Shaders) {
+		if (s.Rebuild == nullptr || !s.Rebuild->IsReady()) {
+			continue;
+		}
+		s.Rebuild->Finish();
+		if (s.Rebuild->IsLinked()) {
+			s.Program->Swap(*s.Rebuild);
+			WatchFiles(s.Program);
+			LogManager::Instance()->LogInfo("Reloaded shader " + s.Name);
+		}
+		else {
+			LogManager::Instance()->LogError("Shader " + s.Name + " failed to rebuild, still using the last working version.");
+		}
+		//after a swap this holds the old program.
+		delete s.Rebuild;
+		s.Rebuild = nullptr;
+		//the deleted name can be handed out again, so the bound program cache cant be trusted.
+		RenderState::Instance()->Invalidate();
+	}
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::WatchFiles(const Shader* Program)
+{
+	for (auto& file : Program->GetFiles()) {
+		_Watcher.Watch(file);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::StartRebuild(ShaderEntry& Entry)
+{
+	//a newer edit replaces a rebuild that has not finished.
+	delete Entry.Rebuild;
+	//not cached, the next launch stores the edited program.
+	Entry.Rebuild = new Shader(Entry.VertexFile, Entry.FragmentFile, Entry.Defines, nullptr, Entry.Program);
+}
+
+////////////////////////////////////////////////////////////
+bool ShaderManager::CanAdd(ShaderID Key, const std::string& Name)
+{
+	int existing = FindEntry(Key);
+	if (existing == -1) {
+		return true;
+	}
+	if (_Shaders[existing].Name == Name) {
+		LogManager::Instance()->LogWarning("This Shader Name already exists! Choose a new one!...");
 	}
 	else {
-		LogManager::Instance()->LogWarning("This Shader does not exist!...");
+		LogManager::Instance()->LogError("Shader " + Name + " has the same id as " + _Shaders[existing].Name + ", rename one of them.");
 	}
-    return nullptr;
+	return false;
 }
 
-std::map<std::string, Shader*>* ShaderManager::GetShaderList()
+////////////////////////////////////////////////////////////
+int ShaderManager::InsertEntry(const ShaderEntry& Entry)
+{
+	if ((int)(_Shaders.size() + 1) * 2 > (int)_Table.size()) {
+		GrowTable();
+	}
+
+	int index = (int)_Shaders.size();
+	_Shaders.push_back(Entry);
+	if (_HotReload && Entry.Program != nullptr) {
+		WatchFiles(Entry.Program);
+	}
+
+	int mask = (int)_Table.size() - 1;
+	int slot = Entry.Key.Hash & mask;
+	while (_Table[slot] != -1) {
+		slot = (slot + 1) & mask;
+	}
+	_Table[slot] = index;
+	return index;
+}
+
+////////////////////////////////////////////////////////////
+int ShaderManager::FindVariant(int Family)
+{
+	//most lookups ask for the same set as the one before.
+	if (_Shaders[Family].LastIndex != -1 && _Shaders[Family].LastVariant == _Variant) {
+		return _Shaders[Family].LastIndex;
+	}
+
+	char suffix[16];
+	std::snprintf(suffix, sizeof(suffix), "#%04x", _Variant);
+	std::string name = _Shaders[Family].Name + suffix;
+	ShaderID id(name);
+	int index = FindEntry(id);
+	if (index != -1 && _Shaders[index].Name != name) {
+		LogManager::Instance()->LogError("Shader " + name + " has the same id as " + _Shaders[index].Name + ", rename one of them.");
+	}
+	if (index == -1) {
+		std::vector<std::string> defines = _Shaders[Family].Defines;
+		if (_Variant & FEATURE_DIR_LIGHT) {
+			defines.push_back("DIR_LIGHT");
+		}
+		if (_Variant & FEATURE_SPOT_LIGHT) {
+			defines.push_back("SPOT_LIGHT");
+		}
+		if (_Variant & FEATURE_TOON_SHADING) {
+			defines.push_back("TOON_SHADING");
+		}
+		if (_Variant & FEATURE_CLUSTERED_LIGHTS) {
+			defines.push_back("CLUSTERED_LIGHTS");
+		}
+		defines.push_back("POINT_LIGHTS " + std::to_string(_Variant >> 8));
+
+		//every variant shares the vertex arrays set up against the first one.
+		int layout = _Shaders[Family].Layout;
+		ShaderEntry entry;
+		entry.Key = id;
+		entry.Name = name;
+		entry.Program = new Shader(_Shaders[Family].VertexFile, _Shaders[Family].FragmentFile, defines,
+			_CacheEnabled ? &_Cache : nullptr, layout != -1 ? _Shaders[layout].Program : nullptr);
+		entry.VertexFile = _Shaders[Family].VertexFile;
+		entry.FragmentFile = _Shaders[Family].FragmentFile;
+		entry.Defines = defines;
+		//inserting can move the entries, so nothing above is held by reference.
+		index = InsertEntry(entry);
+		if (layout == -1) {
+			_Shaders[Family].Layout = index;
+		}
+		LogManager::Instance()->LogInfo("Building shader permutation " + name);
+	}
+
+	_Shaders[Family].LastVariant = _Variant;
+	_Shaders[Family].LastIndex = index;
+	return index;
+}
+
+////////////////////////////////////////////////////////////
+int ShaderManager::FindEntry(ShaderID Key) const
 {
-	return &_Shaders;
+	//linear probing, the table is never more than half full so this stops quickly.
+	int mask = (int)_Table.size() - 1;
+	int slot = Key.Hash & mask;
+	while (_Table[slot] != -1) {
+		if (_Shaders[_Table[slot]].Key == Key) {
+			return _Table[slot];
+		}
+		slot = (slot + 1) & mask;
+	}
+	return -1;
+}
+
+////////////////////////////////////////////////////////////
+void ShaderManager::GrowTable()
+{
+	_Table.assign(_Table.size() * 2, -1);
+	int mask = (int)_Table.size() - 1;
+	for (int i = 0; i < (int)_Shaders.size(); i++) {
+		int slot = _Shaders[i].Key.Hash & mask;
+		while (_Table[slot] != -1) {
+			slot = (slot + 1) & mask;
+		}
+		_Table[slot] = i;
+	}
 }
@@ -11,38 +11,142 @@
 ////////////////////////////////////////////////////////////
 // Headers
 ////////////////////////////////////////////////////////////
-#include <map>
+#include <string>
+#include <vector>
+#include "ShaderID.h"
+#include "ProgramCache.h"
+#include "FileWatcher.h"
+#include "Timer.h"
 #include "Shaders\Shader.h"
 
+////////////////////////////////////////////////////////////
+/// Compile time features for shaders added with
+/// --AddPermutations, each one is a #define in the source.
+////////////////////////////////////////////////////////////
+enum ShaderFeature {
+	FEATURE_DIR_LIGHT = 1 << 0,		// DIR_LIGHT
+	FEATURE_SPOT_LIGHT = 1 << 1,	// SPOT_LIGHT
+	FEATURE_TOON_SHADING = 1 << 2,	// TOON_SHADING
+	FEATURE_CLUSTERED_LIGHTS = 1 << 3	// CLUSTERED_LIGHTS, point lights come from ClusteredLights.
+};
+
 ////////////////////////////////////////////////////////////
 /// Engine ShaderManager
 /// --Handles adding new shaders to the engine and storing them.
-/// --Stores shaders in std::map using string key, key can be used
-/// --to add and retrieve shader.
+/// --Shaders are keyed by ShaderID, the hash of their name, and
+/// --found through a small open addressed table so a lookup is
+/// --a few array reads. Looking a shader up never binds it,
+/// --BindShader does that and RenderState skips the
+/// --glUseProgram when it is already bound.
+/// --Programs build in the background after AddShader and
+/// --are waited on by FinishLoading or their first lookup.
+/// --With hot reload on, shader files and their includes are
+/// --watched and edited programs rebuild in the background,
+/// --then swap in place once they link so Shader pointers
+/// --held elsewhere stay valid. A program that fails keeps
+/// --running the old one.
+/// --Shaders added with AddPermutations are built once per
+/// --feature set instead of branching on uniforms. Looking one
+/// --up returns the program for the features currently set,
+/// --compiling it the first time that set is asked for.
 ////////////////////////////////////////////////////////////
 class ShaderManager
 {
 public:
+	////////////////////////////////////////////////////////////
+	/// Loads program binaries saved by an earlier run, shaders
+	/// --added after this skip the compile when they match.
+	/// --FilePath-- The cache file, created if missing.
+	////////////////////////////////////////////////////////////
+	void UseProgramCache(const std::string& FilePath);
+
 	////////////////////////////////////////////////////////////
 	/// Adds a new shader to the manager.
 	/// --Key-- The key to store the shader to.
 	/// --FileName-- The file name of shader without path or extension.
 	////////////////////////////////////////////////////////////
-	void AddShader(std::string Key, std::string FileName);
+	void AddShader(const std::string& Key, const std::string& FileName);
+
+	////////////////////////////////////////////////////////////
+	/// Adds a new shader built from separately named stages.
+	/// --Key-- The key to store the shader to.
+	/// --VertexFile-- The vertex shader name without path or extension.
+	/// --FragmentFile-- The fragment shader name without path or extension.
+	////////////////////////////////////////////////////////////
+	void AddShader(const std::string& Key, const std::string& VertexFile, const std::string& FragmentFile);
 
 	////////////////////////////////////////////////////////////
-	/// Sets the specified shader to be one currently in use.
+	/// Adds a variant built with extra #defines.
+	/// --Defines-- "NAME" or "NAME VALUE" entries for both stages.
+	////////////////////////////////////////////////////////////
+	void AddShader(const std::string& Key, const std::string& VertexFile, const std::string& FragmentFile, const std::vector<std::string>& Defines);
+
+	////////////////////////////////////////////////////////////
+	/// Adds a shader built per feature set. Nothing compiles
+	/// --until a lookup asks for a set, each set built is kept
+	/// --so switching back to it is free.
+	/// --Key-- The key to store the shader to.
+	/// --VertexFile-- The vertex shader name without path or extension.
+	/// --FragmentFile-- The fragment shader name without path or extension.
+	////////////////////////////////////////////////////////////
+	void AddPermutations(const std::string& Key, const std::string& VertexFile, const std::string& FragmentFile);
+
+	////////////////////////////////////////////////////////////
+	/// Chooses the feature set permutation lookups return.
+	/// --Count-- Point lights the shaders loop over, the loop
+	/// --bound is a constant so it unrolls.
+	////////////////////////////////////////////////////////////
+	void SetFeature(ShaderFeature Feature, bool Enabled);
+	void SetPointLightCount(int Count);
+
+	////////////////////////////////////////////////////////////
+	/// The current feature set, features in the low byte and
+	/// --the point light count above them.
+	////////////////////////////////////////////////////////////
+	uint32_t GetVariant() const { return _Variant; }
+
+	////////////////////////////////////////////////////////////
+	/// Waits for every shader still building, finishing them
+	/// --in the order the driver completes them.
+	////////////////////////////////////////////////////////////
+	void FinishLoading();
+
+	////////////////////////////////////////////////////////////
+	/// Writes the program cache. Called on shutdown so
+	/// --permutations built during play are saved too.
+	////////////////////////////////////////////////////////////
+	void Shutdown();
+
+	////////////////////////////////////////////////////////////
+	/// Binds the specified shader and returns it, use before
+	/// --setting uniforms or drawing.
 	/// --Key-- The key to retrieve data.
 	////////////////////////////////////////////////////////////
-	void UseShader(std::string Key);
+	Shader* BindShader(ShaderID Key);
 
 	////////////////////////////////////////////////////////////
-	/// Gets the specified shader and returns it.
+	/// Gets the specified shader without binding it, null if
+	/// --there is no shader with that key.
 	/// --Key-- The key to retrieve data.
 	////////////////////////////////////////////////////////////
-	Shader* GetShader(std::string Key);
+	Shader* GetShader(ShaderID Key);
 
-	std::map<std::string, Shader*>* GetShaderList();
+	////////////////////////////////////////////////////////////
+	/// The name a shader was added with, for log messages.
+	////////////////////////////////////////////////////////////
+	const std::string& GetName(ShaderID Key);
+
+	////////////////////////////////////////////////////////////
+	/// Turns watching shader files for edits on or off.
+	////////////////////////////////////////////////////////////
+	void SetHotReload(bool Enabled);
+	bool GetHotReload() const { return _HotReload; }
+
+	////////////////////////////////////////////////////////////
+	/// Checks for edited files and swaps in finished rebuilds.
+	/// --Called once a frame, does nothing without hot reload.
+	////////////////////////////////////////////////////////////
+	void Update();
 
 	////////////////////////////////////////////////////////////
 	/// Provides access to the only instance of the shader
@@ -58,8 +162,39 @@ private:
 	////////////////////////////////////////////////////////////
 	static ShaderManager _Instance; // Static Instance of ShaderManager
 
-	std::string _CurrentShader;		// The currently used shader.
-	std::map<std::string, Shader*> _Shaders; // The Map of Shaders in the manager.
+	struct ShaderEntry {
+		ShaderID Key;
+		std::string Name;
+		Shader* Program;		// Null for a permutation family, its variants are entries of their own.
+		std::string VertexFile;
+		std::string FragmentFile;
+		std::vector<std::string> Defines;
+		Shader* Rebuild = nullptr;	// Replacement still building, null if none.
+		bool Permutations = false;
+		int Layout = -1;			// First variant built, the rest copy its attribute locations.
+		uint32_t LastVariant = 0;	// Feature set last looked up and the entry it found.
+		int LastIndex = -1;
+	};
+
+	std::vector<ShaderEntry> _Shaders;	// Every shader in the order it was added.
+	std::vector<int> _Table;			// Open addressed hash to _Shaders index, -1 when empty.
+	ProgramCache _Cache;
+	bool _CacheEnabled;
+	bool _HotReload;
+	FileWatcher _Watcher;
+	Timer _PollTimer;
+	float _SincePoll;			// Seconds since the files were last checked.
+	uint32_t _Variant;
+
+	bool CanAdd(ShaderID Key, const std::string& Name);
+	int InsertEntry(const ShaderEntry& Entry);
+	int FindVariant(int Family);
+
+	void WatchFiles(const Shader* Program);
+	void StartRebuild(ShaderEntry& Entry);
+
+	int FindEntry(ShaderID Key) const;
+	void GrowTable();
 
 	ShaderManager();
 	~ShaderManager();
@@ -2,90 +2,238 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include "Shader.h"
-#include <fstream>
-#include <sstream>
+#include <cstring>
+#include <utility>
 #include <GLEW\glew.h>
 #include "..\LogManager.h"
+#include "..\RenderState.h"
+#include "..\StatsManager.h"
+#include "..\FrameUniforms.h"
+#include "..\ProgramCache.h"
+#include "ShaderPreprocessor.h"
 
 ////////////////////////////////////////////////////////////
-Shader::Shader(const std::string FileName)
-{
-	std::string vertexCode;
-	std::string fragmentCode;
-	std::ifstream vShaderFile;
-	std::ifstream fShaderFile;
-	// ensure ifstream objects can throw exceptions:
-	vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-	try	{
-		// open files
-		vShaderFile.open("Shaders/" + FileName + ".vert");
-		fShaderFile.open("Shaders/" + FileName + ".frag");
-		std::stringstream vShaderStream, fShaderStream;
-		// read file's buffer contents into streams
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
-		// close file handlers
-		vShaderFile.close();
-		fShaderFile.close();
-		// convert stream into string
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
-	}
-	catch (std::ifstream::failure e) {
-		LogManager::Instance()->LogError("Shader::File Not Successfully Read!");
-	}
-	LogManager::Instance()->LogDebug("Both Shader Files Opened Successfully.");
+Shader::Shader(const std::string FileName, ProgramCache* Cache) :
+	Shader(FileName, FileName, std::vector<std::string>(), Cache)
+{
+}
+
+////////////////////////////////////////////////////////////
+Shader::Shader(const std::string VertexFile, const std::string FragmentFile, const std::vector<std::string>& Defines, ProgramCache* Cache, const Shader* Previous) :
+	ID(0),
+	_VertexShader(0),
+	_FragmentShader(0),
+	_Pending(true),
+	_Linked(false),
+	_Version(0),
+	_Cache(Cache),
+	_CacheKey(0)
+{
+	//includes are expanded and defines injected before the driver sees the source.
+	ShaderPreprocessor preprocessor;
+	bool read = preprocessor.Process(VertexFile + ".vert", Defines);
+	std::string vertexCode = preprocessor.GetSource();
+	_Files = preprocessor.GetFiles();
+	read = preprocessor.Process(FragmentFile + ".frag", Defines) && read;
+	std::string fragmentCode = preprocessor.GetSource();
+	_Files.insert(_Files.end(), preprocessor.GetFiles().begin(), preprocessor.GetFiles().end());
+	if (read) {
+		LogManager::Instance()->LogDebug("Both Shader Files Opened Successfully.");
+	}
+	else {
+		_Cache = nullptr;
+	}
+
+	//vertex arrays set up against the previous program expect its locations.
+	std::vector<std::pair<std::string, int>> locations;
+	if (Previous != nullptr) {
+		locations = GetAttributeLocations(Previous->ID);
+	}
+
+	ID = glCreateProgram();
+	if (_Cache != nullptr) {
+		//a binary keeps the locations it was linked with, so bound locations are part of the key.
+		std::string keySource = vertexCode;
+		for (auto& location : locations) {
+			keySource += "\n" + location.first + " " + std::to_string(location.second);
+		}
+		_CacheKey = _Cache->MakeKey(keySource, fragmentCode);
+		if (_Cache->Restore(_CacheKey, ID)) {
+			LogManager::Instance()->LogDebug("Shader Program Loaded From Cache.");
+			return;
+		}
+	}
 
 	const char* vShaderCode = vertexCode.c_str();
 	const char* fShaderCode = fragmentCode.c_str();
 
-	unsigned int vertex, fragment;
+	// status is not read until Finish, so the driver is free to compile in the background.
+	_VertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(_VertexShader, 1, &vShaderCode, NULL);
+	glCompileShader(_VertexShader);
 
-	// vertex Shader
-	vertex = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertex, 1, &vShaderCode, NULL);
-	glCompileShader(vertex);
-	
-	if (!CheckCompileErrors(vertex, "VERTEX")) {
-		LogManager::Instance()->LogDebug("Vertex Shader Compiled Successfully.");
+	_FragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(_FragmentShader, 1, &fShaderCode, NULL);
+	glCompileShader(_FragmentShader);
+
+	glAttachShader(ID, _VertexShader);
+	glAttachShader(ID, _FragmentShader);
+	for (auto& location : locations) {
+		glBindAttribLocation(ID, location.second, location.first.c_str());
+	}
+	if (_Cache != nullptr && _Cache->IsSupported()) {
+		glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	}
+	glLinkProgram(ID);
+}
 
-	// fragment Shader
-	fragment = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragment, 1, &fShaderCode, NULL);
-	glCompileShader(fragment);
+////////////////////////////////////////////////////////////
+Shader::~Shader()
+{
+	if (_VertexShader != 0) {
+		glDeleteShader(_VertexShader);
+	}
+	if (_FragmentShader != 0) {
+		glDeleteShader(_FragmentShader);
+	}
+	glDeleteProgram(ID);
+}
 
-	if(!CheckCompileErrors(fragment, "FRAGMENT")) {
-		LogManager::Instance()->LogDebug("Fragment Shader Compiled Successfully.");
+////////////////////////////////////////////////////////////
+bool Shader::IsReady() const
+{
+	if (!_Pending || _VertexShader == 0) {
+		return true;
+	}
+	if (GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile) {
+		GLint complete = GL_FALSE;
+		glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+		return complete == GL_TRUE;
 	}
+	return true;
+}
 
-	// shader Program
-	ID = glCreateProgram();
-	glAttachShader(ID, vertex);
-	glAttachShader(ID, fragment);
-	glLinkProgram(ID);
-	
-	if(!CheckCompileErrors(ID, "PROGRAM")) {
-		LogManager::Instance()->LogDebug("Shader Program Linked Successfully.");
+////////////////////////////////////////////////////////////
+void Shader::Finish()
+{
+	if (!_Pending) {
+		return;
 	}
+	_Pending = false;
 
-	// delete the shaders as they're linked into our program now and no longer necessery
-	glDeleteShader(vertex);
-	glDeleteShader(fragment);
+	if (_VertexShader != 0) {
+		if (!CheckCompileErrors(_VertexShader, "VERTEX")) {
+			LogManager::Instance()->LogDebug("Vertex Shader Compiled Successfully.");
+		}
+		if (!CheckCompileErrors(_FragmentShader, "FRAGMENT")) {
+			LogManager::Instance()->LogDebug("Fragment Shader Compiled Successfully.");
+		}
+		_Linked = !CheckCompileErrors(ID, "PROGRAM");
+		if (_Linked) {
+			LogManager::Instance()->LogDebug("Shader Program Linked Successfully.");
+			if (_Cache != nullptr) {
+				_Cache->Store(_CacheKey, ID);
+			}
+		}
 
+		// delete the shaders as they're linked into our program now and no longer necessery
+		glDetachShader(ID, _VertexShader);
+		glDetachShader(ID, _FragmentShader);
+		glDeleteShader(_VertexShader);
+		glDeleteShader(_FragmentShader);
+		_VertexShader = 0;
+		_FragmentShader = 0;
+	}
+	else {
+		//came from the cache, which only hands out binaries that linked.
+		_Linked = true;
+	}
+	ReflectUniforms();
 }
 
 ////////////////////////////////////////////////////////////
-Shader::~Shader()
+void Shader::Swap(Shader& Other)
 {
-	glDeleteProgram(ID);
+	Finish();
+	Other.Finish();
+	std::swap(ID, Other.ID);
+	std::swap(_Uniforms, Other._Uniforms);
+	std::swap(_UniformLookup, Other._UniformLookup);
+	std::swap(_Files, Other._Files);
+	std::swap(_Linked, Other._Linked);
+	_Version++;
+	Other._Version++;
+
+	//values set once at load, samplers and options, carry over to the new program.
+	bool bound = false;
+	for (auto& uniform : Other._UniformLookup) {
+		const UniformSlot& old = Other._Uniforms[uniform.second];
+		auto search = _UniformLookup.find(uniform.first);
+		if (!old.HasValue || search == _UniformLookup.end()) {
+			continue;
+		}
+		UniformSlot& slot = _Uniforms[search->second];
+		if (slot.Type != old.Type) {
+			continue;
+		}
+		if (!bound) {
+			RenderState::Instance()->UseProgram(ID);
+			bound = true;
+		}
+		std::memcpy(slot.Value, old.Value, sizeof(slot.Value));
+		slot.HasValue = true;
+		UploadValue(slot);
+	}
+}
+
+////////////////////////////////////////////////////////////
+std::vector<std::pair<std::string, int>> Shader::GetAttributeLocations(unsigned int Program)
+{
+	std::vector<std::pair<std::string, int>> locations;
+	int count = 0;
+	int maxLength = 0;
+	glGetProgramiv(Program, GL_ACTIVE_ATTRIBUTES, &count);
+	glGetProgramiv(Program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+	std::vector<char> nameBuffer(maxLength + 1);
+	for (int i = 0; i < count; i++) {
+		int length = 0;
+		int size = 0;
+		GLenum type;
+		glGetActiveAttrib(Program, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+		std::string name(nameBuffer.data(), length);
+		int location = glGetAttribLocation(Program, name.c_str());
+		if (location >= 0) {
+			locations.push_back(std::make_pair(name, location));
+		}
+	}
+	return locations;
+}
+
+////////////////////////////////////////////////////////////
+void Shader::UploadValue(const UniformSlot& Slot)
+{
+	const float* f = (const float*)Slot.Value;
+	const int* i = (const int*)Slot.Value;
+	switch (Slot.Type) {
+	case GL_FLOAT:			glUniform1fv(Slot.Location, 1, f); break;
+	case GL_FLOAT_VEC2:		glUniform2fv(Slot.Location, 1, f); break;
+	case GL_FLOAT_VEC3:		glUniform3fv(Slot.Location, 1, f); break;
+	case GL_FLOAT_VEC4:		glUniform4fv(Slot.Location, 1, f); break;
+	case GL_FLOAT_MAT2:		glUniformMatrix2fv(Slot.Location, 1, GL_FALSE, f); break;
+	case GL_FLOAT_MAT3:		glUniformMatrix3fv(Slot.Location, 1, GL_FALSE, f); break;
+	case GL_FLOAT_MAT4:		glUniformMatrix4fv(Slot.Location, 1, GL_FALSE, f); break;
+	//ints, bools and every sampler type go through glUniform1i.
+	default:				glUniform1iv(Slot.Location, 1, i); break;
+	}
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::Use()
 {
-	glUseProgram(ID);
+	if (_Pending) {
+		Finish();
+	}
+	RenderState::Instance()->UseProgram(ID);
 }
 
 void Shader::UpdateMatrices(const glm::mat4 & Model, const glm::mat4 & View)
@@ -104,73 +252,248 @@ void Shader::UpdateMatrices(const glm::mat4 & Model, const glm::mat4 & View, con
 ////////////////////////////////////////////////////////////
 void Shader::SetBool(const std::string & Name, bool Value) const
 {
-	glUniform1i(glGetUniformLocation(ID, Name.c_str()), (int)Value);
+	SetInt(GetUniform(Name), (int)Value);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetInt(const std::string & Name, int Value) const
 {
-	glUniform1i(glGetUniformLocation(ID, Name.c_str()), Value);
+	SetInt(GetUniform(Name), Value);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetFloat(const std::string & Name, float Value) const
 {
-	glUniform1f(glGetUniformLocation(ID, Name.c_str()), Value);
+	SetFloat(GetUniform(Name), Value);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetVec2(const std::string &Name, const glm::vec2 &Value) const
 {
-	glUniform2fv(glGetUniformLocation(ID, Name.c_str()), 1, &Value[0]);
+	SetVec2(GetUniform(Name), Value);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetVec2(const std::string &Name, float x, float y) const
 {
-	glUniform2f(glGetUniformLocation(ID, Name.c_str()), x, y);
+	SetVec2(GetUniform(Name), glm::vec2(x, y));
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetVec3(const std::string &Name, const glm::vec3 &Value) const
 {
-	glUniform3fv(glGetUniformLocation(ID, Name.c_str()), 1, &Value[0]);
+	SetVec3(GetUniform(Name), Value);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetVec3(const std::string &Name, float x, float y, float z) const
 {
-	glUniform3f(glGetUniformLocation(ID, Name.c_str()), x, y, z);
+	SetVec3(GetUniform(Name), glm::vec3(x, y, z));
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetVec4(const std::string &Name, const glm::vec4 &Value) const
 {
-	glUniform4fv(glGetUniformLocation(ID, Name.c_str()), 1, &Value[0]);
+	SetVec4(GetUniform(Name), Value);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetVec4(const std::string &Name, float x, float y, float z, float w)
 {
-	glUniform4f(glGetUniformLocation(ID, Name.c_str()), x, y, z, w);
+	SetVec4(GetUniform(Name), glm::vec4(x, y, z, w));
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetMat2(const std::string &Name, const glm::mat2 &Mat) const
 {
-	glUniformMatrix2fv(glGetUniformLocation(ID, Name.c_str()), 1, GL_FALSE, &Mat[0][0]);
+	SetMat2(GetUniform(Name), Mat);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetMat3(const std::string &Name, const glm::mat3 &Mat) const
 {
-	glUniformMatrix3fv(glGetUniformLocation(ID, Name.c_str()), 1, GL_FALSE, &Mat[0][0]);
+	SetMat3(GetUniform(Name), Mat);
 }
 
 ////////////////////////////////////////////////////////////
 void Shader::SetMat4(const std::string &Name, const glm::mat4 &Mat) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(ID, Name.c_str()), 1, GL_FALSE, &Mat[0][0]);
+	SetMat4(GetUniform(Name), Mat);
+}
+
+////////////////////////////////////////////////////////////
+UniformHandle Shader::GetUniform(const std::string & Name) const
+{
+	UniformHandle handle;
+	auto search = _UniformLookup.find(Name);
+	if (search != _UniformLookup.end()) {
+		handle.Index = search->second;
+	}
+	return handle;
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetBool(UniformHandle Handle, bool Value) const
+{
+	SetInt(Handle, (int)Value);
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetInt(UniformHandle Handle, int Value) const
+{
+	int location = BeginUpload(Handle, &Value, sizeof(Value));
+	if (location != -1) {
+		glUniform1i(location, Value);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetFloat(UniformHandle Handle, float Value) const
+{
+	int location = BeginUpload(Handle, &Value, sizeof(Value));
+	if (location != -1) {
+		glUniform1f(location, Value);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetVec2(UniformHandle Handle, const glm::vec2 &Value) const
+{
+	int location = BeginUpload(Handle, &Value[0], sizeof(Value));
+	if (location != -1) {
+		glUniform2fv(location, 1, &Value[0]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetVec3(UniformHandle Handle, const glm::vec3 &Value) const
+{
+	int location = BeginUpload(Handle, &Value[0], sizeof(Value));
+	if (location != -1) {
+		glUniform3fv(location, 1, &Value[0]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetVec4(UniformHandle Handle, const glm::vec4 &Value) const
+{
+	int location = BeginUpload(Handle, &Value[0], sizeof(Value));
+	if (location != -1) {
+		glUniform4fv(location, 1, &Value[0]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetMat2(UniformHandle Handle, const glm::mat2 &Mat) const
+{
+	int location = BeginUpload(Handle, &Mat[0][0], sizeof(Mat));
+	if (location != -1) {
+		glUniformMatrix2fv(location, 1, GL_FALSE, &Mat[0][0]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetMat3(UniformHandle Handle, const glm::mat3 &Mat) const
+{
+	int location = BeginUpload(Handle, &Mat[0][0], sizeof(Mat));
+	if (location != -1) {
+		glUniformMatrix3fv(location, 1, GL_FALSE, &Mat[0][0]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+void Shader::SetMat4(UniformHandle Handle, const glm::mat4 &Mat) const
+{
+	int location = BeginUpload(Handle, &Mat[0][0], sizeof(Mat));
+	if (location != -1) {
+		glUniformMatrix4fv(location, 1, GL_FALSE, &Mat[0][0]);
+	}
+}
+
+////////////////////////////////////////////////////////////
+int Shader::BeginUpload(UniformHandle Handle, const void* Data, int Size) const
+{
+	if (!Handle.IsValid()) {
+		return -1;
+	}
+	//uniform values belong to the program, so the copy stays right across binds.
+	UniformSlot& slot = _Uniforms[Handle.Index];
+	if (slot.HasValue && std::memcmp(slot.Value, Data, Size) == 0) {
+		STATS_ADD(STAT_UNIFORMS_SKIPPED, 1);
+		return -1;
+	}
+	std::memcpy(slot.Value, Data, Size);
+	slot.HasValue = true;
+	STATS_ADD(STAT_UNIFORM_UPLOADS, 1);
+	return slot.Location;
+}
+
+////////////////////////////////////////////////////////////
+void Shader::ReflectUniforms()
+{
+	_Uniforms.clear();
+	_UniformLookup.clear();
+
+	int count = 0;
+	int maxLength = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::vector<char> nameBuffer(maxLength + 1);
+
+	for (int i = 0; i < count; i++) {
+		int length = 0;
+		int size = 0;
+		GLenum type;
+		glGetActiveUniform(ID, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+		std::string name(nameBuffer.data(), length);
+
+		//arrays come back once as "name[0]" (some drivers leave the [0] off), every element gets its own entry.
+		std::vector<std::string> names;
+		if (size > 1) {
+			std::string base = name;
+			if (base.size() > 3 && base.compare(base.size() - 3, 3, "[0]") == 0) {
+				base.erase(base.size() - 3);
+			}
+			names.push_back(base);
+			for (int element = 0; element < size; element++) {
+				names.push_back(base + "[" + std::to_string(element) + "]");
+			}
+		}
+		else {
+			names.push_back(name);
+		}
+
+		for (auto& uniformName : names) {
+			//members of uniform blocks have no location.
+			int location = glGetUniformLocation(ID, uniformName.c_str());
+			if (location == -1) {
+				continue;
+			}
+			UniformSlot slot;
+			slot.Location = location;
+			slot.Type = type;
+			slot.HasValue = false;
+			_UniformLookup.emplace(uniformName, (int)_Uniforms.size());
+			_Uniforms.push_back(slot);
+		}
+	}
+
+	//per frame blocks go to fixed binding points so one buffer serves every program.
+	for (int block = 0; block < BLOCK_COUNT; block++) {
+		unsigned int index = glGetUniformBlockIndex(ID, UNIFORM_BLOCK_NAMES[block]);
+		if (index == GL_INVALID_INDEX) {
+			continue;
+		}
+		glUniformBlockBinding(ID, index, block);
+		int size = 0;
+		glGetActiveUniformBlockiv(ID, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+		//drivers may or may not pad the end of the block to a vec4, any other difference means the layouts disagree.
+		int expected = FrameUniforms::GetBlockSize((UniformBlock)block);
+		if (size < expected || size > (expected + 15) / 16 * 16) {
+			LogManager::Instance()->LogWarning("Uniform block " + std::string(UNIFORM_BLOCK_NAMES[block]) + " is " + std::to_string(size) +
+				" bytes in the shader but " + std::to_string(expected) + " in FrameUniforms.h");
+		}
+	}
 }
 
 ////////////////////////////////////////////////////////////
@@ -12,13 +12,39 @@
 // Headers
 ////////////////////////////////////////////////////////////
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstdint>
 #include <GLM\glm.hpp>
 
+class ProgramCache;
+
+////////////////////////////////////////////////////////////
+/// A uniform resolved once by name, only valid with the
+/// shader that handed it out.
+////////////////////////////////////////////////////////////
+struct UniformHandle {
+	int Index = -1;
+	bool IsValid() const { return Index >= 0; }
+};
+
 ////////////////////////////////////////////////////////////
 /// Engine Shader
 /// --Handles the creation of shader objects aswell as
 /// --reading vertex and fragment shaders into memory
 /// --and compiling them into a program.
+/// --Construction only starts the build, either loading a
+/// --cached binary or submitting the compile and link, so the
+/// --driver can work on several programs at once. Finish
+/// --waits for the result, checks it and reads the uniforms.
+/// --Stages go through ShaderPreprocessor, so they can
+/// --#include shared files and take #defines for variants.
+/// --Active uniforms are read back once after linking, so
+/// --setting one by name is a hash lookup rather than a
+/// --glGetUniformLocation. Each uniform keeps a copy of the
+/// --last value sent and an upload of the same value is
+/// --skipped.
 ////////////////////////////////////////////////////////////
 class Shader
 {
@@ -28,13 +54,57 @@ public:
 	/// --FileName-- Give name of file to open without file extension
 	/// or path.
 	////////////////////////////////////////////////////////////
-	Shader(const std::string FileName);
+	Shader(const std::string FileName, ProgramCache* Cache = nullptr);
+
+	////////////////////////////////////////////////////////////
+	/// Builds a program from differently named stages, so
+	/// variants can share a fragment shader.
+	/// --VertexFile-- Vertex shader name without path or extension.
+	/// --FragmentFile-- Fragment shader name without path or extension.
+	/// --Defines-- "NAME" or "NAME VALUE" entries defined in both stages.
+	/// --Cache-- Binary cache to load from and store to, may be null.
+	/// --Previous-- A program this one will replace or share vertex
+	/// --arrays with, its attribute locations are kept so existing
+	/// --vertex arrays still work.
+	////////////////////////////////////////////////////////////
+	Shader(const std::string VertexFile, const std::string FragmentFile, const std::vector<std::string>& Defines,
+		ProgramCache* Cache = nullptr, const Shader* Previous = nullptr);
 
 	////////////////////////////////////////////////////////////
 	/// Default Destructor.
 	////////////////////////////////////////////////////////////
 	~Shader();
 
+	////////////////////////////////////////////////////////////
+	/// True once the driver has finished building the program,
+	/// --never blocks. Always true without parallel compile.
+	////////////////////////////////////////////////////////////
+	bool IsReady() const;
+
+	////////////////////////////////////////////////////////////
+	/// Waits for the build if it is still running, reports
+	/// --errors, stores the binary and reads the uniforms. Does
+	/// --nothing once finished.
+	////////////////////////////////////////////////////////////
+	void Finish();
+	bool IsFinished() const { return !_Pending; }
+	bool IsLinked() const { return _Linked; }
+
+	////////////////////////////////////////////////////////////
+	/// Takes over the other shaders program so anything holding
+	/// --this pointer draws with it, used by hot reload. Values
+	/// --already set are sent again to matching uniforms, and the
+	/// --version goes up so cached UniformHandles can be fetched
+	/// --again.
+	////////////////////////////////////////////////////////////
+	void Swap(Shader& Other);
+	unsigned int GetVersion() const { return _Version; }
+
+	////////////////////////////////////////////////////////////
+	/// Every file both stages were built from, includes too.
+	////////////////////////////////////////////////////////////
+	const std::vector<std::string>& GetFiles() const { return _Files; }
+
 	////////////////////////////////////////////////////////////
 	/// Sets this Shader to be the current shader to use for 
 	/// Rendering on the GPU.
@@ -158,6 +228,28 @@ public:
 	////////////////////////////////////////////////////////////
 	void SetMat4(const std::string &Name, const glm::mat4 &Mat) const;
 
+	////////////////////////////////////////////////////////////
+	/// Resolves a uniform for the handle setters below, which
+	/// skip the name lookup. Arrays can be looked up by element
+	/// ("lights[2]"). Returns an invalid handle if the program
+	/// has no such active uniform, setting it then does nothing.
+	////////////////////////////////////////////////////////////
+	UniformHandle GetUniform(const std::string &Name) const;
+
+	////////////////////////////////////////////////////////////
+	/// Handle versions of the setters, the program must be
+	/// bound like with the named versions.
+	////////////////////////////////////////////////////////////
+	void SetBool(UniformHandle Handle, bool Value) const;
+	void SetInt(UniformHandle Handle, int Value) const;
+	void SetFloat(UniformHandle Handle, float Value) const;
+	void SetVec2(UniformHandle Handle, const glm::vec2 &Value) const;
+	void SetVec3(UniformHandle Handle, const glm::vec3 &Value) const;
+	void SetVec4(UniformHandle Handle, const glm::vec4 &Value) const;
+	void SetMat2(UniformHandle Handle, const glm::mat2 &Mat) const;
+	void SetMat3(UniformHandle Handle, const glm::mat3 &Mat) const;
+	void SetMat4(UniformHandle Handle, const glm::mat4 &Mat) const;
+
 	////////////////////////////////////////////////////////////
 	/// Returns Shader Program ID.
 	////////////////////////////////////////////////////////////
@@ -171,10 +263,49 @@ private:
 	////////////////////////////////////////////////////////////
 	bool CheckCompileErrors(unsigned int Shader, std::string Type);
 
+	////////////////////////////////////////////////////////////
+	/// Fills the uniform table from the linked program and
+	/// --binds its uniform blocks to their binding points.
+	////////////////////////////////////////////////////////////
+	void ReflectUniforms();
+
+	////////////////////////////////////////////////////////////
+	/// Returns the location to upload to, or -1 if the handle
+	/// --is invalid or the value matches the last one sent.
+	////////////////////////////////////////////////////////////
+	int BeginUpload(UniformHandle Handle, const void* Data, int Size) const;
+
+	////////////////////////////////////////////////////////////
+	/// Name and location of every active attribute in a program.
+	////////////////////////////////////////////////////////////
+	static std::vector<std::pair<std::string, int>> GetAttributeLocations(unsigned int Program);
+
+	struct UniformSlot {
+		int Location;
+		unsigned int Type;	// GL type, only used to send the value again after a reload.
+		bool HasValue;
+		unsigned char Value[sizeof(glm::mat4)];	// Last value sent, the largest type is a mat4.
+	};
+
+	////////////////////////////////////////////////////////////
+	/// Sends a slots stored value to the bound program.
+	////////////////////////////////////////////////////////////
+	static void UploadValue(const UniformSlot& Slot);
+
 	////////////////////////////////////////////////////////////
 	// Member Data
 	////////////////////////////////////////////////////////////
 	unsigned int ID;	// ID for the shader program in memory
+	unsigned int _VertexShader;		// Stages kept until Finish, 0 when loaded from the cache.
+	unsigned int _FragmentShader;
+	bool _Pending;
+	bool _Linked;
+	unsigned int _Version;		// Goes up each time the program is swapped.
+	std::vector<std::string> _Files;
+	ProgramCache* _Cache;
+	uint64_t _CacheKey;
+	mutable std::vector<UniformSlot> _Uniforms;				// Shadow copy of every active uniform.
+	std::unordered_map<std::string, int> _UniformLookup;	// Name to index in _Uniforms.
 };
 
 #endif
\ No newline at end of file
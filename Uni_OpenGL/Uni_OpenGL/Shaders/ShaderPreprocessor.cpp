@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "ShaderPreprocessor.h"
+#include <algorithm>
+#include <fstream>
+#include "..\LogManager.h"
+
+////////////////////////////////////////////////////////////
+// Static Variables
+////////////////////////////////////////////////////////////
+static const std::string SHADER_FOLDER = "Shaders/";
+static const int MAX_INCLUDE_DEPTH = 16;
+
+////////////////////////////////////////////////////////////
+bool ShaderPreprocessor::Process(const std::string& FileName, const std::vector<std::string>& Defines)
+{
+	_Source.clear();
+	_Files.clear();
+	_Defines = Defines;
+	return Expand(FileName, 0);
+}
+
+////////////////////////////////////////////////////////////
+bool ShaderPreprocessor::Expand(const std::string& FileName, int Depth)
+{
+	std::string path = SHADER_FOLDER + FileName;
+	if (std::find(_Files.begin(), _Files.end(), path) != _Files.end()) {
+		return true;
+	}
+	if (Depth > MAX_INCLUDE_DEPTH) {
+		LogManager::Instance()->LogError("Shader includes nested too deep at " + FileName);
+		return false;
+	}
+
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		LogManager::Instance()->LogError("Shader::File Not Successfully Read! " + path);
+		return false;
+	}
+	int fileIndex = (int)_Files.size();
+	_Files.push_back(path);
+	std::string fileNumber = std::to_string(fileIndex);
+	//glsl 330 numbers the line after a #line directive as one more than it says.
+	if (Depth > 0) {
+		_Source += "#line 0 " + fileNumber + "\n";
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		size_t start = line.find_first_not_of(" \t");
+		if (start == std::string::npos || line[start] != '#') {
+			_Source += line;
+			_Source += '\n';
+			continue;
+		}
+
+		size_t directive = line.find_first_not_of(" \t", start + 1);
+		if (directive != std::string::npos && line.compare(directive, 7, "include") == 0) {
+			size_t open = line.find('"', directive);
+			size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+			if (close == std::string::npos) {
+				LogManager::Instance()->LogError("Bad #include in " + path + " line " + std::to_string(lineNumber));
+				return false;
+			}
+			if (!Expand(line.substr(open + 1, close - open - 1), Depth + 1)) {
+				return false;
+			}
+			_Source += "#line " + std::to_string(lineNumber) + " " + fileNumber + "\n";
+			continue;
+		}
+
+		_Source += line;
+		_Source += '\n';
+		//defines go after #version, which has to be the first thing in the stage.
+		if (Depth == 0 && directive != std::string::npos && line.compare(directive, 7, "version") == 0) {
+			for (auto& define : _Defines) {
+				_Source += "#define " + define + "\n";
+			}
+			_Source += "#line " + std::to_string(lineNumber) + " " + fileNumber + "\n";
+		}
+	}
+	return true;
+}
@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////
+//
+// ShaderPreprocessor
+//
+////////////////////////////////////////////////////////////
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+/// Engine ShaderPreprocessor
+/// --Expands #include "file" lines before the source goes to
+/// --the driver and injects #defines straight after #version.
+/// --Include paths are relative to the Shaders folder and each
+/// --file is only pasted in once per stage, so shared files
+/// --need no guards. #line directives are written so compile
+/// --errors point at the file and line they came from, the
+/// --number after the line is the index into Files.
+////////////////////////////////////////////////////////////
+class ShaderPreprocessor
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// Reads and expands a stage.
+	/// --FileName-- The file inside the Shaders folder, with extension.
+	/// --Defines-- "NAME" or "NAME VALUE" entries to define.
+	/// --Returns-- false if the file or an include could not be read.
+	////////////////////////////////////////////////////////////
+	bool Process(const std::string& FileName, const std::vector<std::string>& Defines);
+
+	////////////////////////////////////////////////////////////
+	/// The expanded source from the last Process.
+	////////////////////////////////////////////////////////////
+	const std::string& GetSource() const { return _Source; }
+
+	////////////////////////////////////////////////////////////
+	/// Every file read by the last Process, the stage first.
+	/// --Paths include the Shaders folder so they can be watched.
+	////////////////////////////////////////////////////////////
+	const std::vector<std::string>& GetFiles() const { return _Files; }
+
+private:
+	bool Expand(const std::string& FileName, int Depth);
+
+	////////////////////////////////////////////////////////////
+	// Member Data
+	////////////////////////////////////////////////////////////
+	std::string _Source;
+	std::vector<std::string> _Files;
+	std::vector<std::string> _Defines;
+};
+
+#endif
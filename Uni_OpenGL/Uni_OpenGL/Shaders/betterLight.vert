@@ -1,16 +1,19 @@
 #version 330 core
 
-in vec3 aPos;
-in vec3 aNormal;
-in vec2 aTexCoords;
+//fixed locations so the instanced variant can share mesh vertex arrays.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "camera.glsl"
+
+//the depth pre-pass computes the same position.
+invariant gl_Position;
 
 void main()
 {
@@ -0,0 +1,27 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+//per instance model matrix, a mat4 takes locations 5 to 8.
+layout (location = 5) in mat4 aInstanceModel;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+#include "camera.glsl"
+
+//the depth pre-pass computes the same position.
+invariant gl_Position;
+
+void main()
+{
+	FragPos = vec3(aInstanceModel * vec4(aPos, 1.0));
+    
+	//the fragment shader rotates by the model uniform, which is identity for instanced draws.
+	Normal = mat3(aInstanceModel) * aNormal;
+    TexCoords = aTexCoords;
+	
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,6 @@
+//per frame camera block shared by every program, filled from FrameUniforms.h.
+layout (std140) uniform Camera {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+};
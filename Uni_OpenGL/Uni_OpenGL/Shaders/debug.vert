@@ -6,8 +6,7 @@ in vec3 aColor;
 out vec3 fColor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "camera.glsl"
 
 void main()
 {
@@ -0,0 +1,6 @@
+#version 330 core
+
+//no outputs, depth only. not writing gl_FragDepth keeps early z on.
+void main()
+{
+}
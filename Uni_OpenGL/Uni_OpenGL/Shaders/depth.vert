@@ -0,0 +1,15 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+#include "camera.glsl"
+
+//must match the lit shaders bit for bit or GL_LEQUAL in the colour pass will reject pixels.
+invariant gl_Position;
+
+void main()
+{
+	vec3 worldPos = vec3(model * vec4(aPos, 1.0));
+	gl_Position = projection * view * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+//per instance model matrix, a mat4 takes locations 5 to 8.
+layout (location = 5) in mat4 aInstanceModel;
+
+#include "camera.glsl"
+
+invariant gl_Position;
+
+void main()
+{
+	vec3 worldPos = vec3(aInstanceModel * vec4(aPos, 1.0));
+	gl_Position = projection * view * vec4(worldPos, 1.0);
+}
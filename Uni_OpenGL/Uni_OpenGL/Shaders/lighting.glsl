@@ -0,0 +1,118 @@
+#include "lights.glsl"
+#include "shadows.glsl"
+#include "camera.glsl"
+
+//what the lights shine on, each program fills it from its own material.
+struct Surface {
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+};
+
+//toon shading is a permutation, see ShaderManager::AddPermutations.
+const float levels = 5.0;
+
+vec3 CalculateDirectionalLight(DirLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir){
+    vec3 lightDir = normalize(-light.direction);
+    //diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+#ifdef TOON_SHADING
+    diff = floor(diff * levels) / levels;
+#endif
+    //specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+#ifdef TOON_SHADING
+    spec = floor(spec * levels) / levels;
+#endif
+    // combine results
+    vec3 ambient = light.ambient * surface.diffuse;
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
+    vec3 specular = light.specular * spec * surface.specular;
+    //only the sun casts shadows, ambient stays so shadowed areas arent black.
+    float shadow = CalculateShadow(fragPos, normal, lightDir);
+    return (ambient + (1.0 - shadow) * (diffuse + specular));
+}
+
+vec3 CalculatePointLight(PointLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir){
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    // combine results
+    vec3 ambient = light.ambient * surface.diffuse;
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
+    vec3 specular = light.specular * spec * surface.specular;
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalculateSpotLight(SpotLight light, Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir){
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), surface.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    vec3 ambient = light.ambient * surface.diffuse;
+    vec3 diffuse = light.diffuse * diff * surface.diffuse;
+    vec3 specular = light.specular * spec * surface.specular;
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+}
+
+#ifdef CLUSTERED_LIGHTS
+//filled by ClusteredLights each frame. each cell is an offset and count into clusterLights,
+//which holds indices into lightData, four texels per light laid out like PointLight.
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer clusterLights;
+uniform samplerBuffer lightData;
+
+PointLight FetchPointLight(int index){
+    vec4 a = texelFetch(lightData, index * 4);
+    vec4 b = texelFetch(lightData, index * 4 + 1);
+    vec4 c = texelFetch(lightData, index * 4 + 2);
+    vec4 d = texelFetch(lightData, index * 4 + 3);
+    PointLight light;
+    light.position = a.xyz;
+    light.constant = a.w;
+    light.ambient = b.xyz;
+    light.linear = b.w;
+    light.diffuse = c.xyz;
+    light.quadratic = c.w;
+    light.specular = d.xyz;
+    return light;
+}
+
+//only the lights binned into this fragments cell are evaluated.
+vec3 CalculateClusteredLights(Surface surface, vec3 normal, vec3 fragPos, vec3 viewDir){
+    float depth = max(-(view * vec4(fragPos, 1.0)).z, 0.0001);
+    int slice = clamp(int(floor(log(depth) * clusterScale.z + clusterScale.w)), 0, CLUSTER_Z - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy * clusterScale.xy), ivec2(0), ivec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+    uvec2 cell = texelFetch(clusterGrid, tile.x + tile.y * CLUSTER_X + slice * CLUSTER_X * CLUSTER_Y).xy;
+
+    vec3 total = vec3(0.0);
+    for(uint i = 0u; i < cell.y; i++){
+        int index = int(texelFetch(clusterLights, int(cell.x + i)).r);
+        total += CalculatePointLight(FetchPointLight(index), surface, normal, fragPos, viewDir);
+    }
+    return total;
+}
+#endif
@@ -0,0 +1,62 @@
+struct DirLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+//members are ordered so the floats fill the gaps std140 leaves after each vec3.
+struct PointLight {
+    vec3 position;
+    float constant;
+    vec3 ambient;
+    float linear;
+    vec3 diffuse;
+    float quadratic;
+    vec3 specular;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+
+    float cutOff;
+    float outerCutOff;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+//must match MAX_POINT_LIGHTS in FrameUniforms.h, the array is in the middle of the block so every
+//member after it moves with its size. Variants wanting fewer lights set POINT_LIGHTS instead.
+#define NR_POINT_LIGHTS 10
+
+#define MAX_CASCADES 4
+
+//cluster grid size, matches ClusteredLights.h.
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+
+//lights a permutation is built for, the has and num values below are only read on the cpu.
+#ifndef POINT_LIGHTS
+#define POINT_LIGHTS 0
+#endif
+
+//per frame light block, filled from FrameUniforms.h. cascadeCount of 0 means shadows are off.
+layout (std140) uniform Lights {
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    int hasDirLight;
+    int hasPointLight;
+    int numPointLight;
+    int cascadeCount;
+    mat4 lightSpaceMatrices[MAX_CASCADES];
+    vec4 cascadeSplits;
+    vec4 clusterScale;
+};
@@ -1,6 +1,6 @@
 #version 330 core
 
-in vec3 aPos;
+layout (location = 0) in vec3 aPos;
 
 uniform mat4 model;
 uniform mat4 depthMVP;
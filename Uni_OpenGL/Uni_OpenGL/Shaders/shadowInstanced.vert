@@ -0,0 +1,12 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+//per instance model matrix, a mat4 takes locations 5 to 8.
+layout (location = 5) in mat4 aInstanceModel;
+
+uniform mat4 depthMVP;
+
+void main()
+{
+	gl_Position = depthMVP * (aInstanceModel * vec4(aPos, 1.0));
+}
@@ -0,0 +1,36 @@
+#include "camera.glsl"
+#include "lights.glsl"
+
+//cascaded shadow map, the matrices and splits are in the Lights block.
+uniform sampler2DArrayShadow shadowMap;
+
+float CalculateShadow(vec3 fragPos, vec3 normal, vec3 lightDir){
+    if(cascadeCount == 0){
+        return 0.0;
+    }
+    //pick the first cascade whose far split is past this fragment.
+    float depth = abs((view * vec4(fragPos, 1.0)).z);
+    if(depth >= cascadeSplits[cascadeCount - 1]){
+        return 0.0;
+    }
+    int cascade = 0;
+    for(int i = 0; i < cascadeCount - 1; i++){
+        if(depth >= cascadeSplits[i]){
+            cascade = i + 1;
+        }
+    }
+    vec4 lightSpace = lightSpaceMatrices[cascade] * vec4(fragPos, 1.0);
+    vec3 coords = lightSpace.xyz / lightSpace.w * 0.5 + 0.5;
+    if(coords.z > 1.0){
+        return 0.0;
+    }
+    float bias = max(0.0015 * (1.0 - dot(normal, lightDir)), 0.0005);
+    //four hardware compared taps half a texel apart.
+    vec2 texel = 0.5 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    lit += texture(shadowMap, vec4(coords.xy + vec2(-texel.x, -texel.y), cascade, coords.z - bias));
+    lit += texture(shadowMap, vec4(coords.xy + vec2( texel.x, -texel.y), cascade, coords.z - bias));
+    lit += texture(shadowMap, vec4(coords.xy + vec2(-texel.x,  texel.y), cascade, coords.z - bias));
+    lit += texture(shadowMap, vec4(coords.xy + vec2( texel.x,  texel.y), cascade, coords.z - bias));
+    return 1.0 - lit * 0.25;
+}
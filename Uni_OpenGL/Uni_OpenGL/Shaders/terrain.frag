@@ -17,69 +17,18 @@ struct Material {
     float shininess;
 }; 
 
-struct DirLight {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight {
-    vec3 position;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-
-    float cutOff;
-    float outerCutOff;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-#define NR_POINT_LIGHTS 10
-
-uniform DirLight dirLight; 
-uniform PointLight pointLights[NR_POINT_LIGHTS]; 
-uniform SpotLight spotLight; 
+//light structs, the Camera and Lights blocks, shadows and the light functions.
+#include "lighting.glsl"
+
+#ifdef SPOT_LIGHT
+uniform SpotLight spotLight;
+#endif
 uniform Material material;
- 
-uniform vec3 viewPos;
-uniform int hasDirLight = 0;
-uniform int hasSpotLight = 0;
-uniform int hasPointLight = 0;
-uniform int numPointLight = 0;
+
 uniform mat4 model;
 
 uniform sampler2D blendMap;
 
-vec3 totalDiffuseColor;
-
-
-//for toon shading
-uniform bool toonShadingOn = false;
-const float levels = 5.0;
-
-//function prototypes
-vec3 CalculateDirectionalLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalculatePointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalculateSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-
 void main()
 {
     //-----------------------------------------------------
@@ -87,109 +36,53 @@ void main()
     //-----------------------------------------------------
     vec2 tiledCoords = TexCoords * 40.0f;
 
-	totalDiffuseColor = vec3(mix(texture(material.texture_diffuse2, tiledCoords),texture(material.texture_diffuse1, tiledCoords), TexData.y));
+	vec3 totalDiffuseColor = vec3(mix(texture(material.texture_diffuse2, tiledCoords),texture(material.texture_diffuse1, tiledCoords), TexData.y));
 
     //allows for correct lighting on rotated objects
     vec3 norm = normalize(Normal);// * transpose(inverse(mat3(model))));
     vec3 viewDir = normalize(viewPos - FragPos);
 
+    //the terrain has no specular map, highlights take the ground colour.
+    Surface surface;
+    surface.diffuse = totalDiffuseColor;
+    surface.specular = totalDiffuseColor;
+    surface.shininess = material.shininess;
+
     //------------------------------------------------------
     // Lighting is 3 phases. Direction, Point and Spot lights.
     // Corresponding calculate function used at each phase
     // All light colours are acumulated and then added to fragment
-    // at the end.
+    // at the end. Which phases run is fixed when the
+    // permutation is compiled, so there is no per fragment
+    // branching on the light setup.
     //------------------------------------------------------
 
 
-	vec3 totalLight;
+	vec3 totalLight = vec3(0.0,0.0,0.0);
     //---------------------------
     // Phase 1: Directional Light
     //---------------------------
-	if(hasDirLight > 0){
-		totalLight = CalculateDirectionalLight(dirLight, norm, viewDir);
-	}
+#ifdef DIR_LIGHT
+	totalLight += CalculateDirectionalLight(dirLight, surface, norm, FragPos, viewDir);
+#endif
     //---------------------------
     // Phase 2: Point Lights
     //---------------------------
-	if(hasPointLight > 0){
-		for(int i = 0; i < numPointLight; i++){
-			totalLight = totalLight + CalculatePointLight(pointLights[i], norm, FragPos, viewDir);
-		}
+#ifdef CLUSTERED_LIGHTS
+	totalLight += CalculateClusteredLights(surface, norm, FragPos, viewDir);
+#else
+	//constant bound, the compiler unrolls it and drops it entirely for zero.
+	for(int i = 0; i < POINT_LIGHTS; i++){
+		totalLight += CalculatePointLight(pointLights[i], surface, norm, FragPos, viewDir);
 	}
+#endif
     //---------------------------
     // Phase 3: Spot Lights
     //---------------------------
-	if(hasSpotLight > 0){
-		totalLight += CalculateSpotLight(spotLight, norm, FragPos, viewDir);
-	}
+#ifdef SPOT_LIGHT
+	totalLight += CalculateSpotLight(spotLight, surface, norm, FragPos, viewDir);
+#endif
 
     FragColor = vec4(totalLight,1.0);
 
 }
-
-vec3 CalculateDirectionalLight(DirLight light, vec3 normal, vec3 viewDir){
-    vec3 lightDir = normalize(-light.direction);
-    //diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-	if(toonShadingOn){
-		float level = floor(diff * levels);
-		diff = level / levels;
-	}
-    //specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-	if(toonShadingOn){
-		float level = floor(spec * levels);
-		spec = level / levels;
-	}
-    // combine results
-    vec3 ambient = light.ambient * totalDiffuseColor;
-    vec3 diffuse = light.diffuse * diff * totalDiffuseColor;
-    vec3 specular = light.specular * spec * totalDiffuseColor;
-    return (ambient + diffuse + specular);
-}
-
-vec3 CalculatePointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir){
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // combine results
-    vec3 ambient = light.ambient * totalDiffuseColor;
-    vec3 diffuse = light.diffuse * diff * totalDiffuseColor;
-    vec3 specular = light.specular * spec * totalDiffuseColor;
-    ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
-    return (ambient + diffuse + specular);
-}
-
-
-vec3 CalculateSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir){
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction)); 
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-    // combine results
-    vec3 ambient = light.ambient * totalDiffuseColor;
-    vec3 diffuse =  light.diffuse * diff * totalDiffuseColor;
-    vec3 specular =  light.specular * spec * totalDiffuseColor;
-    ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-    return (ambient + diffuse + specular);
-}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #version 330 core
 
-in vec3 aPos;
+//location 0 so the depth pre-pass can draw with the same vertex array.
+layout (location = 0) in vec3 aPos;
 in vec3 aNormal;
 in vec2 aTexCoords;
 in vec2 aTexData; 
@@ -12,8 +13,10 @@ out vec2 TexCoords;
 out vec2 TexData;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+#include "camera.glsl"
+
+//the depth pre-pass computes the same position.
+invariant gl_Position;
 
 void main()
 {
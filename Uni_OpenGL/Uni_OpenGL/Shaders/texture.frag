@@ -22,8 +22,10 @@ float LinearizeDepth(float depth)
 void main()
 {
 	if(RenderingText){
-		vec4 sampled = vec4(1.0, 1.0, 1.0, texture(textureImage, TexCoords).r);
-		FragColor = vec4(color, 1.0) * sampled;
+		//text is a signed distance field with the edge at 0.5, fwidth keeps the edge a pixel wide at any scale.
+		float dist = texture(textureImage, TexCoords).r;
+		float edge = max(fwidth(dist), 0.0001);
+		FragColor = vec4(color, smoothstep(0.5 - edge, 0.5 + edge, dist));
 	}	
 	else if (RenderingDepth){
 		float depthValue = texture(textureImage, TexCoords).r;
@@ -3,8 +3,14 @@
 
 #include <GLEW/glew.h>
 #include "LogManager.h"
+#include "RenderState.h"
 
-ShadowMapBuffer::ShadowMapBuffer()
+ShadowMapBuffer::ShadowMapBuffer() :
+	_ID(0),
+	_DepthMapID(0),
+	_Width(0),
+	_Height(0),
+	_Layers(0)
 {
 }
 
@@ -13,25 +19,34 @@ ShadowMapBuffer::~ShadowMapBuffer()
 {
 	glDeleteFramebuffers(1, &_ID);
 	glDeleteTextures(1, &_DepthMapID);
+	RenderState::Instance()->Invalidate();
 }
 
-void ShadowMapBuffer::Create(int width, int height)
+void ShadowMapBuffer::Create(int width, int height, int layers)
 {
 	_Width = width;
 	_Height = height;
+	_Layers = layers;
 	glGenFramebuffers(1, &_ID);
 	glBindFramebuffer(GL_FRAMEBUFFER, _ID);
 
 	glGenTextures(1, &_DepthMapID);
-	glBindTexture(GL_TEXTURE_2D, _DepthMapID);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT16, _Width, _Height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _DepthMapID, 0);
+	RenderState::Instance()->BindTexture(0, _DepthMapID, GL_TEXTURE_2D_ARRAY);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, _Width, _Height, _Layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	//linear filtering with compare mode gives 2x2 pcf for free on sampler2DArrayShadow.
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	//anything outside the map is lit.
+	float border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _DepthMapID, 0, 0);
 	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
 
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
 		LogManager::Instance()->LogError("Shadow FrameBuffer Broken...");
@@ -40,10 +55,10 @@ void ShadowMapBuffer::Create(int width, int height)
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-void ShadowMapBuffer::Bind()
+void ShadowMapBuffer::Bind(int layer)
 {
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _ID);
+	glBindFramebuffer(GL_FRAMEBUFFER, _ID);
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _DepthMapID, 0, layer);
 	glViewport(0, 0, _Width, _Height);
 }
 
@@ -6,8 +6,10 @@ public:
 	ShadowMapBuffer();
 	~ShadowMapBuffer();
 
-	void Create(int width, int height);
-	void Bind();
+	//depth texture array with one layer per shadow cascade, set up for hardware depth compare.
+	void Create(int width, int height, int layers = 1);
+	//renders into one layer of the array.
+	void Bind(int layer = 0);
 	void Clear();
 	void Unbind();
 
@@ -19,5 +21,6 @@ private:
 	unsigned int _DepthMapID;
 
 	int _Width, _Height;
+	int _Layers;
 };
 
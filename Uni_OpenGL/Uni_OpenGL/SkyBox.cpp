@@ -1,4 +1,5 @@
 #include "SkyBox.h"
+#include "RenderState.h"
 
 
 
@@ -74,11 +75,10 @@ void SkyBox::Render(std::string shader)
 {
     glDepthFunc(GL_LEQUAL);
 
-    ShaderManager::Instance()->GetShader(_Shader)->SetInt("skybox", 0);
+    ShaderManager::Instance()->BindShader(_Shader)->SetInt("skybox", 0);
     _VertexArray.Bind();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, _CubeMapTexture->GetID());
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    RenderState::Instance()->BindTexture(0, _CubeMapTexture->GetID(), GL_TEXTURE_CUBE_MAP);
+    RenderState::Instance()->DrawArrays(GL_TRIANGLES, 0, 36);
     _VertexArray.Unbind();
     
     glDepthFunc(GL_LESS);
@@ -10,9 +10,9 @@ Speedometer::Speedometer(glm::vec2 position, std::string shader)
 {
 	_Position = position;
 	_Shader = shader;
-	_Dial = new Sprite(glm::vec2(300, 300), 1, 1, ResourceManager::Instance()->GetTexture("SpeedoDial"), _Shader);
+	_Dial = new Sprite(glm::vec2(300, 300), 1, 1, ResourceManager::Instance()->GetTexture("SpeedoDial"), shader);
 	_Dial->SetSpriteSheetLocation();
-	_Needle = new Sprite(glm::vec2(150, 8), 1, 1, ResourceManager::Instance()->GetTexture("SpeedoNeedle"), _Shader);
+	_Needle = new Sprite(glm::vec2(150, 8), 1, 1, ResourceManager::Instance()->GetTexture("SpeedoNeedle"), shader);
 	_Needle->SetSpriteSheetLocation();
 }
 
@@ -31,16 +31,17 @@ void Speedometer::Update(float delta)
 
 void Speedometer::Render()
 {
-	ShaderManager::Instance()->GetShader(_Shader)->SetVec3("color", glm::vec3(1.0, 1.0, 1.0));
-	ShaderManager::Instance()->GetShader(_Shader)->SetBool("RenderingText", false);
-	ShaderManager::Instance()->GetShader(_Shader)->SetBool("RenderingDepth", false);
+	Shader* shader = ShaderManager::Instance()->BindShader(_Shader);
+	shader->SetVec3("color", glm::vec3(1.0, 1.0, 1.0));
+	shader->SetBool("RenderingText", false);
+	shader->SetBool("RenderingDepth", false);
 	glm::mat4 model(1.0f);
 	model = glm::translate(model, glm::vec3(_Position.x, _Position.y, 0));
-	ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+	shader->SetMat4("model", model);
 	_Dial->Render();
 	model = glm::translate(model, glm::vec3((_Dial->GetSize().x * 0.5f), (_Dial->GetSize().y * 0.5f) - (_Needle->GetSize().y * 0.5f), 0));
 	model = glm::rotate(model, -glm::radians(_NeedleAngle), glm::vec3(0,0,1));
-	ShaderManager::Instance()->GetShader(_Shader)->SetMat4("model", model);
+	shader->SetMat4("model", model);
 	_Needle->Render();
 }
 
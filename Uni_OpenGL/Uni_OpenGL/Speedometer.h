@@ -20,7 +20,7 @@ public:
 	glm::vec2 GetSize();
 
 private:
-	std::string _Shader;
+	ShaderID _Shader;
 
 	glm::vec2 _Position;
 	glm::vec2 _NeedlePos;
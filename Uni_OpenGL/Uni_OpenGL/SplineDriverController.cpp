@@ -0,0 +1,130 @@
+#include "SplineDriverController.h"
+#include "CatmullRomSpline.h"
+#include "BVehicle.h"
+
+#include <algorithm>
+#include <math.h>
+#include <float.h>
+
+SplineDriverController::SplineDriverController(CatmullRomSpline * spline, float speedScale)
+{
+	_Points = spline->GetSpline();
+
+	_SegmentLength.resize(_Points.size());
+	for (int i = 0; i < (int)_Points.size(); i++) {
+		_SegmentLength[i] = glm::length(_Points[Next(i)] - _Points[i]);
+	}
+
+	PlanSpeeds(speedScale);
+}
+
+void SplineDriverController::PlanSpeeds(float speedScale)
+{
+	int count = (int)_Points.size();
+	_TargetSpeed.assign(count, MAX_PLANNED_SPEED * speedScale);
+	if (count < 3) {
+		return;
+	}
+
+	//corner speed from curvature, curvature is turn angle over distance.
+	for (int i = 0; i < count; i++) {
+		glm::vec2 in = _Points[i] - _Points[Previous(i)];
+		glm::vec2 out = _Points[Next(i)] - _Points[i];
+		float inLength = glm::length(in);
+		float outLength = glm::length(out);
+		if (inLength <= 0.0f || outLength <= 0.0f) {
+			continue;
+		}
+		float cosAngle = glm::clamp(glm::dot(in, out) / (inLength * outLength), -1.0f, 1.0f);
+		float curvature = acosf(cosAngle) / (0.5f * (inLength + outLength));
+		if (curvature > 0.0001f) {
+			//v^2 = grip / curvature, then m/s to km/h.
+			float cornerSpeed = sqrtf(LATERAL_GRIP / curvature) * 3.6f * speedScale;
+			_TargetSpeed[i] = std::min(_TargetSpeed[i], cornerSpeed);
+		}
+	}
+
+	//walk backwards so the car starts braking before a corner, twice round covers the wrap at the start line.
+	for (int pass = 0; pass < 2 * count; pass++) {
+		int i = (count - 1) - (pass % count);
+		float nextSpeed = _TargetSpeed[Next(i)] / 3.6f;
+		float reachable = sqrtf(nextSpeed * nextSpeed + 2.0f * BRAKING_DECEL * _SegmentLength[i]) * 3.6f;
+		_TargetSpeed[i] = std::min(_TargetSpeed[i], reachable);
+	}
+}
+
+int SplineDriverController::FindNearestPoint(const glm::vec2 & position)
+{
+	int count = (int)_Points.size();
+
+	//first step, or after a reset, search the whole track once.
+	if (_TrackIndex < 0) {
+		float closest = FLT_MAX;
+		for (int i = 0; i < count; i++) {
+			float distance = glm::dot(_Points[i] - position, _Points[i] - position);
+			if (distance < closest) {
+				closest = distance;
+				_TrackIndex = i;
+			}
+		}
+		return _TrackIndex;
+	}
+
+	//otherwise only look a small window around where we were last step.
+	int best = _TrackIndex;
+	float closest = glm::dot(_Points[best] - position, _Points[best] - position);
+	int index = Previous(_TrackIndex);
+	for (int i = -1; i < SEARCH_WINDOW; i++) {
+		float distance = glm::dot(_Points[index] - position, _Points[index] - position);
+		if (distance < closest) {
+			closest = distance;
+			best = index;
+		}
+		index = Next(index);
+	}
+	_TrackIndex = best;
+	return _TrackIndex;
+}
+
+VehicleInput SplineDriverController::GetInput(BVehicle * vehicle, float)
+{
+	VehicleInput input;
+	if (_Points.size() < 3) {
+		return input;
+	}
+
+	glm::vec3 position = vehicle->GetPosition();
+	glm::vec2 position2D(position.x, position.z);
+	int index = FindNearestPoint(position2D);
+
+	//the chassis faces down its local z.
+	btVector3 forward = vehicle->GetRigidBody()->getWorldTransform().getBasis().getColumn(2);
+	glm::vec2 forward2D(forward.x(), forward.z());
+
+	//walk forward to the look ahead point, noting the slowest planned speed on the way.
+	float speed = vehicle->GetCurrentSpeedKmHour();
+	float lookAhead = MIN_LOOK_AHEAD + (speed / 3.6f) * LOOK_AHEAD_TIME;
+	float travelled = 0.0f;
+	float targetSpeed = _TargetSpeed[index];
+	int target = index;
+	for (int i = 0; i < MAX_LOOK_AHEAD_POINTS && travelled < lookAhead; i++) {
+		travelled += _SegmentLength[target];
+		target = Next(target);
+		targetSpeed = std::min(targetSpeed, _TargetSpeed[target]);
+	}
+
+	//pure pursuit style, steer by the angle to the target point, positive is left.
+	glm::vec2 toTarget = _Points[target] - position2D;
+	float cross = forward2D.x * toTarget.y - forward2D.y * toTarget.x;
+	float angle = atan2f(-cross, glm::dot(forward2D, toTarget));
+	input.Steer = glm::clamp(angle / MAX_STEER_ANGLE, -1.0f, 1.0f);
+
+	if (speed < targetSpeed - SPEED_TOLERANCE) {
+		input.Throttle = 1.0f;
+	}
+	else if (speed > targetSpeed + SPEED_TOLERANCE) {
+		input.Brake = glm::clamp((speed - targetSpeed) / 20.0f, 0.1f, 1.0f);
+	}
+	//inside the tolerance just coast.
+	return input;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "VehicleController.h"
+
+#include <vector>
+#include <GLM\glm.hpp>
+
+class CatmullRomSpline;
+
+////////////////////////////////////////////////////////////
+/// AI driver that follows a track spline.
+/// --Steers at a point a speed dependant distance ahead on
+/// --the spline and picks throttle or brake from a speed
+/// --plan built from the spline curvature. The work per
+/// --step is capped, the nearest point search and the look
+/// --ahead only ever walk a fixed number of points.
+////////////////////////////////////////////////////////////
+class SplineDriverController : public VehicleController
+{
+public:
+	////////////////////////////////////////////////////////////
+	/// --Spline-- The track to follow, copied on construction.
+	/// --SpeedScale-- Scales the planned speeds, lets AI cars
+	/// --  drive a little differently while staying repeatable.
+	////////////////////////////////////////////////////////////
+	SplineDriverController(CatmullRomSpline* spline, float speedScale = 1.0f);
+
+	virtual VehicleInput GetInput(BVehicle* vehicle, float delta) override;
+
+	int GetTrackIndex() { return _TrackIndex; }
+
+private:
+	//how many points forward the nearest point search may move per step.
+	const int SEARCH_WINDOW = 16;
+	//look ahead distance is this plus speed times LOOK_AHEAD_TIME, capped at MAX_LOOK_AHEAD_POINTS.
+	const float MIN_LOOK_AHEAD = 8.0f;
+	const float LOOK_AHEAD_TIME = 0.6f;
+	const int MAX_LOOK_AHEAD_POINTS = 64;
+	//sideways grip used to turn curvature into a corner speed, in m/s^2.
+	const float LATERAL_GRIP = 9.0f;
+	//how hard the car can slow down when planning for the next corner, in m/s^2.
+	const float BRAKING_DECEL = 6.0f;
+	const float MAX_PLANNED_SPEED = 170.0f;
+	const float MAX_STEER_ANGLE = 0.3f;
+	const float SPEED_TOLERANCE = 5.0f;
+
+	std::vector<glm::vec2> _Points;
+	std::vector<float> _SegmentLength;	//distance from point i to point i + 1
+	std::vector<float> _TargetSpeed;	//planned speed at point i in km/h
+
+	int _TrackIndex = -1;
+
+	void PlanSpeeds(float speedScale);
+	int FindNearestPoint(const glm::vec2& position);
+	int Next(int index) { return (index + 1) % (int)_Points.size(); }
+	int Previous(int index) { return (index + (int)_Points.size() - 1) % (int)_Points.size(); }
+};
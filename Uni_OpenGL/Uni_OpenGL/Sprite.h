@@ -6,6 +6,7 @@
 #include "PrimitiveShape.h"
 #include "ShaderManager.h"
 #include "Texture.h"
+#include "RenderState.h"
 
 class Sprite : public PrimitiveShape
 {
@@ -65,13 +66,12 @@ public:
 
 	void Render(std::string shader = "")
 	{
-		ShaderManager::Instance()->GetShader(_Shader)->SetInt("textureImage", 0);
+		ShaderManager::Instance()->BindShader(_Shader)->SetInt("textureImage", 0);
 		_VertexArray.Bind();
 		if (_SpriteTexture != nullptr) {
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, _SpriteTexture->GetID());
+			RenderState::Instance()->BindTexture(0, _SpriteTexture->GetID());
 		}
-		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		RenderState::Instance()->DrawElements(GL_TRIANGLES, 6);
 		_VertexArray.Unbind();
 	}
 
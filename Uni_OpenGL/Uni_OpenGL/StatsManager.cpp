@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include "StatsManager.h"
+#include "TextRenderer.h"
+#include "LogManager.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+////////////////////////////////////////////////////////////
+// Static Variables
+////////////////////////////////////////////////////////////
+StatsManager StatsManager::_Instance;
+thread_local StatsManager::StatBlock* StatsManager::_LocalBlock = nullptr;
+StatsManager::StatBlock StatsManager::_SharedBlock;
+
+//plain statics are zeroed before any constructor runs, so threads can register during static init.
+static const int MAX_STAT_THREADS = 32;
+static StatsManager::StatBlock StatBlocks[MAX_STAT_THREADS];
+static std::atomic<bool> StatBlockUsed[MAX_STAT_THREADS];
+static StatsManager::StatBlock RetiredBlock;		// Counts from threads that have exited.
+//held while a block is retired so EndFrame never sees its counts twice or not at all.
+static std::mutex RetireMutex;
+
+//gives the threads block back when it exits.
+struct StatBlockHolder {
+	StatsManager::StatBlock* Block = nullptr;
+	~StatBlockHolder() {
+		if (Block != nullptr) {
+			StatsManager::RetireThread(Block);
+		}
+	}
+};
+static thread_local StatBlockHolder LocalHolder;
+
+static const char* StatNames[STAT_COUNT] = {
+	"DrawCalls",
+	"ProgramSwitches",
+	"TextureBinds",
+	"UniformUploads",
+	"UniformsSkipped",
+	"BufferBytes",
+	"BufferStalls",
+	"PhysicsSubSteps",
+	"CollisionPairs",
+	"ContactManifolds",
+	"Allocations"
+};
+
+////////////////////////////////////////////////////////////
+StatsManager::StatsManager() :
+	_FrameCount(0)
+{
+	for (int i = 0; i < STAT_COUNT; i++) {
+		_Totals[i] = 0;
+		_LastFrame[i] = 0;
+	}
+}
+
+////////////////////////////////////////////////////////////
+void StatsManager::EndFrame()
+{
+	//free blocks are zeroed, so every block can be summed.
+	long long totals[STAT_COUNT] = {};
+	{
+		std::lock_guard<std::mutex> lock(RetireMutex);
+		for (int b = 0; b < MAX_STAT_THREADS; b++) {
+			for (int i = 0; i < STAT_COUNT; i++) {
+				totals[i] += StatBlocks[b].Values[i].load(std::memory_order_relaxed);
+			}
+		}
+		for (int i = 0; i < STAT_COUNT; i++) {
+			totals[i] += RetiredBlock.Values[i].load(std::memory_order_relaxed);
+			totals[i] += _SharedBlock.Values[i].load(std::memory_order_relaxed);
+		}
+	}
+	for (int i = 0; i < STAT_COUNT; i++) {
+		_LastFrame[i] = totals[i] - _Totals[i];
+		_Totals[i] = totals[i];
+	}
+	_FrameCount++;
+
+	if (_Csv.is_open()) {
+		_Csv << _FrameCount;
+		for (int i = 0; i < STAT_COUNT; i++) {
+			_Csv << ',' << _LastFrame[i];
+		}
+		_Csv << '\n';
+	}
+}
+
+////////////////////////////////////////////////////////////
+const char* StatsManager::GetName(StatCounter Counter)
+{
+	return StatNames[Counter];
+}
+
+////////////////////////////////////////////////////////////
+void StatsManager::RenderOverlay(TextRenderer* Text, glm::vec2 Position, float Scale)
+{
+	for (int i = 0; i < STAT_COUNT; i++) {
+		Text->RenderText(std::string(StatNames[i]) + ": " + std::to_string(_LastFrame[i]), Position, Scale);
+		Position.y -= 60.0f * Scale;
+	}
+}
+
+////////////////////////////////////////////////////////////
+bool StatsManager::StartCsv(std::string FilePath)
+{
+	_Csv.open(FilePath);
+	if (!_Csv.is_open()) {
+		LogManager::Instance()->LogError("Stats could not open csv file " + FilePath);
+		return false;
+	}
+	_Csv << "Frame";
+	for (int i = 0; i < STAT_COUNT; i++) {
+		_Csv << ',' << StatNames[i];
+	}
+	_Csv << '\n';
+	LogManager::Instance()->LogInfo("Writing per frame stats to " + FilePath);
+	return true;
+}
+
+////////////////////////////////////////////////////////////
+void StatsManager::StopCsv()
+{
+	if (_Csv.is_open()) {
+		_Csv.close();
+	}
+}
+
+////////////////////////////////////////////////////////////
+StatsManager::StatBlock* StatsManager::RegisterThread()
+{
+	_LocalBlock = &_SharedBlock;
+	for (int b = 0; b < MAX_STAT_THREADS; b++) {
+		bool used = false;
+		if (!StatBlockUsed[b].load(std::memory_order_relaxed) && StatBlockUsed[b].compare_exchange_strong(used, true, std::memory_order_acquire)) {
+			_LocalBlock = &StatBlocks[b];
+			LocalHolder.Block = _LocalBlock;
+			break;
+		}
+	}
+	return _LocalBlock;
+}
+
+////////////////////////////////////////////////////////////
+void StatsManager::RetireThread(StatBlock* Block)
+{
+	{
+		std::lock_guard<std::mutex> lock(RetireMutex);
+		for (int i = 0; i < STAT_COUNT; i++) {
+			RetiredBlock.Values[i].fetch_add(Block->Values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+			Block->Values[i].store(0, std::memory_order_relaxed);
+		}
+	}
+	StatBlockUsed[Block - StatBlocks].store(false, std::memory_order_release);
+	//anything this thread counts while it finishes exiting goes to the shared block.
+	_LocalBlock = &_SharedBlock;
+}
+
+////////////////////////////////////////////////////////////
+// Allocation counting, define STATS_DISABLED to keep the
+// default operator new.
+////////////////////////////////////////////////////////////
+#ifndef STATS_DISABLED
+void* operator new(std::size_t Size)
+{
+	StatsManager::Add(STAT_ALLOCATIONS);
+	void* memory = std::malloc(Size > 0 ? Size : 1);
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[](std::size_t Size)
+{
+	return operator new(Size);
+}
+
+void operator delete(void* Memory) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete[](void* Memory) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete(void* Memory, std::size_t) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete[](void* Memory, std::size_t) noexcept
+{
+	std::free(Memory);
+}
+#endif
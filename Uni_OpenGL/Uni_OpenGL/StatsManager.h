@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////
+//
+// Stats Manager
+//
+////////////////////////////////////////////////////////////
+#ifndef STATS_MANAGER_H
+#define STATS_MANAGER_H
+
+////////////////////////////////////////////////////////////
+// Headers
+////////////////////////////////////////////////////////////
+#include <GLM\glm.hpp>
+#include <atomic>
+#include <fstream>
+#include <string>
+
+class TextRenderer;
+
+////////////////////////////////////////////////////////////
+/// Counters any subsystem can add to. Names for the overlay
+/// --and the csv header are in StatsManager.cpp.
+////////////////////////////////////////////////////////////
+enum StatCounter {
+	STAT_DRAW_CALLS = 0,
+	STAT_PROGRAM_SWITCHES,
+	STAT_TEXTURE_BINDS,
+	STAT_UNIFORM_UPLOADS,
+	STAT_UNIFORMS_SKIPPED,
+	STAT_BUFFER_BYTES,
+	STAT_BUFFER_STALLS,
+	STAT_PHYSICS_SUBSTEPS,
+	STAT_COLLISION_PAIRS,
+	STAT_CONTACT_MANIFOLDS,
+	STAT_ALLOCATIONS,
+	STAT_COUNT
+};
+
+////////////////////////////////////////////////////////////
+/// Engine StatsManager
+/// --Per frame counters. Each thread adds into its own block
+/// --so adding is a plain increment with no lock or atomic
+/// --read-modify-write, and EndFrame sums the blocks once a
+/// --frame. Counters only grow, a frame's count is the
+/// --difference from the frame before.
+/// --The last complete frame and the totals since launch
+/// --can be queried, drawn as an overlay or written to a
+/// --csv file with one row per frame.
+////////////////////////////////////////////////////////////
+class StatsManager
+{
+public:
+	struct StatBlock {
+		std::atomic<long long> Values[STAT_COUNT];
+	};
+
+	////////////////////////////////////////////////////////////
+	/// Adds to a counter for the calling thread. Use the
+	/// --STATS_ADD macro so it can be compiled out.
+	////////////////////////////////////////////////////////////
+	static void Add(StatCounter Counter, long long Value = 1) {
+		StatBlock* block = _LocalBlock != nullptr ? _LocalBlock : RegisterThread();
+		std::atomic<long long>& value = block->Values[Counter];
+		if (block == &_SharedBlock) {
+			value.fetch_add(Value, std::memory_order_relaxed);
+			return;
+		}
+		//only this thread writes its block, the atomic just keeps EndFrames read clean.
+		value.store(value.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+	}
+
+	////////////////////////////////////////////////////////////
+	/// Sums every threads counters into the last frame values
+	/// --and writes the csv row. Called once per frame.
+	////////////////////////////////////////////////////////////
+	void EndFrame();
+
+	////////////////////////////////////////////////////////////
+	/// Query API, counts for the last complete frame, the total
+	/// --since launch and how many frames have ended.
+	////////////////////////////////////////////////////////////
+	long long GetLastFrame(StatCounter Counter) const { return _LastFrame[Counter]; }
+	long long GetTotal(StatCounter Counter) const { return _Totals[Counter]; }
+	int GetFrameCount() const { return _FrameCount; }
+	static const char* GetName(StatCounter Counter);
+
+	////////////////////////////////////////////////////////////
+	/// Draws every counter for the last frame, one per line.
+	/// --Position-- Top left of the first line.
+	////////////////////////////////////////////////////////////
+	void RenderOverlay(TextRenderer* Text, glm::vec2 Position, float Scale);
+
+	////////////////////////////////////////////////////////////
+	/// Writes a row per frame from now until StopCsv.
+	////////////////////////////////////////////////////////////
+	bool StartCsv(std::string FilePath);
+	void StopCsv();
+
+	////////////////////////////////////////////////////////////
+	/// Provides access to the only instance of the stats
+	/// manager.
+	////////////////////////////////////////////////////////////
+	static StatsManager* Instance() {
+		return &_Instance;
+	};
+
+private:
+	////////////////////////////////////////////////////////////
+	// Member Data
+	////////////////////////////////////////////////////////////
+	static StatsManager _Instance;						// Static Instance of StatsManager
+	static thread_local StatBlock* _LocalBlock;			// This threads block, null until its first Add.
+	static StatBlock _SharedBlock;						// For threads past the block limit or already exiting.
+
+	long long _Totals[STAT_COUNT];
+	long long _LastFrame[STAT_COUNT];
+	int _FrameCount;
+	std::ofstream _Csv;
+
+	////////////////////////////////////////////////////////////
+	/// Hands the calling thread a free block. Never allocates,
+	/// --so it is safe from inside operator new. When the thread
+	/// --exits its counts move into the retired totals and the
+	/// --block is freed for the next thread.
+	////////////////////////////////////////////////////////////
+	static StatBlock* RegisterThread();
+	static void RetireThread(StatBlock* Block);
+	friend struct StatBlockHolder;
+
+	StatsManager();
+	~StatsManager() {}
+	StatsManager(const StatsManager&) {}
+};
+
+////////////////////////////////////////////////////////////
+/// Define STATS_DISABLED to compile every counter out.
+////////////////////////////////////////////////////////////
+#ifndef STATS_DISABLED
+#define STATS_ADD(Counter, Value) StatsManager::Add(Counter, Value)
+#else
+#define STATS_ADD(Counter, Value)
+#endif
+
+#endif
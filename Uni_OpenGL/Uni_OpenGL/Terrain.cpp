@@ -1,9 +1,12 @@
 #include "Terrain.h"
 #include "ShaderManager.h"
+#include "RenderState.h"
 
 #include "PRNG.h"
 #include "CatmullRomSpline.h"
 
+#include <algorithm>
+
 Terrain::Terrain(int gridX, int gridZ, std::vector<Texture*> textures, Texture* blendmap)
 {
     X = gridX * SIZE;
@@ -32,25 +35,39 @@ void Terrain::Render(std::string shader)
 		_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aTexCoords", 2, VT_FLOAT, 10 * sizeof(float), 6 * sizeof(float));
 		_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(shader)->GetID(), "aTexData", 2, VT_FLOAT, 10 * sizeof(float), 8 * sizeof(float));
 	}
+    Shader* program = ShaderManager::Instance()->BindShader(_Shader);
+    if (_UniformProgram != program || _UniformVersion != program->GetVersion()) {
+        _BlendMapUniform = program->GetUniform("blendMap");
+        _ShininessUniform = program->GetUniform("material.shininess");
+        _TextureUniforms.clear();
+        for (unsigned int i = 0; i < _Textures.size(); i++) {
+            _TextureUniforms.push_back(program->GetUniform("material.texture_diffuse" + std::to_string(i + 1)));
+        }
+        _UniformProgram = program;
+        _UniformVersion = program->GetVersion();
+    }
     if (_BlendMap != nullptr) {
-        glActiveTexture(GL_TEXTURE0);
-        ShaderManager::Instance()->GetShader(_Shader)->SetInt("blendMap", 0);
-        glBindTexture(GL_TEXTURE_2D, _BlendMap->GetID());
+        program->SetInt(_BlendMapUniform, 0);
+        RenderState::Instance()->BindTexture(0, _BlendMap->GetID());
     }
     for (unsigned int i = 0; i < _Textures.size(); i++) {
         if (_Textures[i] != nullptr) {
-            glActiveTexture(GL_TEXTURE1 + i);
-            ShaderManager::Instance()->GetShader(_Shader)->SetInt(("material.texture_diffuse" + std::to_string(i + 1)).c_str(), (int)i + 1);
-            glBindTexture(GL_TEXTURE_2D, _Textures[i]->GetID());
+            program->SetInt(_TextureUniforms[i], (int)i + 1);
+            RenderState::Instance()->BindTexture(i + 1, _Textures[i]->GetID());
         }
     }
-    ShaderManager::Instance()->GetShader(_Shader)->SetFloat("material.shininess", 1.0f);
+    program->SetFloat(_ShininessUniform, 1.0f);
 
     _VertexArray.Bind();
-    glDrawElements(GL_TRIANGLES, _Indices.size(), GL_UNSIGNED_INT, 0);
+    RenderState::Instance()->DrawElements(GL_TRIANGLES, _Indices.size());
     _VertexArray.Unbind();
+}
 
-    glActiveTexture(GL_TEXTURE0);
+void Terrain::RenderDepth()
+{
+	_VertexArray.Bind();
+	RenderState::Instance()->DrawElements(GL_TRIANGLES, _Indices.size());
+	_VertexArray.Unbind();
 }
 
 float Terrain::GetHeight(int x, int z)
@@ -58,6 +75,41 @@ float Terrain::GetHeight(int x, int z)
     return _HeightList[x * VERTEX_COUNT + z];
 }
 
+bool Terrain::RayCast(const glm::vec3 & from, const glm::vec3 & to, float & fraction, glm::vec3 & normal)
+{
+	//move the ray into the terrains local space, the body is offset by half its size.
+	glm::vec3 offset(SIZE * 0.5f, 0.0f, SIZE * 0.5f);
+	glm::vec3 start = from + offset;
+	glm::vec3 dir = to - from;
+	float cellSize = SIZE / (float)(VERTEX_COUNT - 1);
+
+	//find the range of cells the ray covers, wheel rays only ever touch one or two.
+	int minX = (int)floorf(std::min(start.x, start.x + dir.x) / cellSize);
+	int maxX = (int)floorf(std::max(start.x, start.x + dir.x) / cellSize);
+	int minZ = (int)floorf(std::min(start.z, start.z + dir.z) / cellSize);
+	int maxZ = (int)floorf(std::max(start.z, start.z + dir.z) / cellSize);
+	minX = std::max(minX, 0);
+	minZ = std::max(minZ, 0);
+	maxX = std::min(maxX, VERTEX_COUNT - 2);
+	maxZ = std::min(maxZ, VERTEX_COUNT - 2);
+
+	bool hit = false;
+	fraction = 1.0f;
+	for (int x = minX; x <= maxX; x++) {
+		for (int z = minZ; z <= maxZ; z++) {
+			//same two triangles per cell as FormatVertexData.
+			int topLeft = (x * VERTEX_COUNT) + z;
+			int topRight = topLeft + 1;
+			int bottomLeft = ((x + 1) * VERTEX_COUNT) + z;
+			int bottomRight = bottomLeft + 1;
+
+			hit |= RayTriangle(start, dir, topLeft, bottomLeft, topRight, fraction, normal);
+			hit |= RayTriangle(start, dir, bottomRight, topRight, bottomLeft, fraction, normal);
+		}
+	}
+	return hit;
+}
+
 void Terrain::Initialize(btDynamicsWorld * world, std::set<btCollisionShape*>* collisionShapes)
 {
     _IndexArray = new btTriangleIndexVertexArray(
@@ -87,7 +139,9 @@ void Terrain::Initialize(btDynamicsWorld * world, std::set<btCollisionShape*>* c
     _TerrainBody = new btRigidBody(bodyInfo);
 
 	collisionShapes->emplace(_MeshShape);
-    world->addRigidBody(_TerrainBody);
+    world->addRigidBody(_TerrainBody, COL_STATIC, COL_MASK_STATIC);
+    //the terrain never moves so keep it asleep, this stops its aabb being rebuilt every step.
+    _TerrainBody->setActivationState(ISLAND_SLEEPING);
 }
 
 void Terrain::AddSplineToTerrain(CatmullRomSpline * spline)
@@ -270,6 +324,40 @@ void Terrain::CalculateNormals()
 	}
 }
 
+bool Terrain::RayTriangle(const glm::vec3 & start, const glm::vec3 & dir, int a, int b, int c, float & fraction, glm::vec3 & normal)
+{
+	//moller trumbore, only keeps the hit if its closer than the current fraction.
+	glm::vec3 pointA = _Vertices[a]._Position;
+	glm::vec3 edgeAB = _Vertices[b]._Position - pointA;
+	glm::vec3 edgeAC = _Vertices[c]._Position - pointA;
+
+	glm::vec3 p = glm::cross(dir, edgeAC);
+	float det = glm::dot(edgeAB, p);
+	if (fabsf(det) < 1e-6f) {
+		return false;
+	}
+	float invDet = 1.0f / det;
+
+	glm::vec3 s = start - pointA;
+	float u = glm::dot(s, p) * invDet;
+	if (u < 0.0f || u > 1.0f) {
+		return false;
+	}
+	glm::vec3 q = glm::cross(s, edgeAB);
+	float v = glm::dot(dir, q) * invDet;
+	if (v < 0.0f || u + v > 1.0f) {
+		return false;
+	}
+	float t = glm::dot(edgeAC, q) * invDet;
+	if (t < 0.0f || t >= fraction) {
+		return false;
+	}
+
+	fraction = t;
+	normal = glm::normalize(glm::cross(edgeAC, edgeAB));
+	return true;
+}
+
 glm::vec3 Terrain::SurfaceNormalFromIndices(int a, int b, int c)
 {
 	glm::vec3 pointA = _Vertices[a]._Position;
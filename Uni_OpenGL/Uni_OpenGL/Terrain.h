@@ -2,6 +2,7 @@
 
 #include "PrimitiveShape.h"
 #include "Texture.h"
+#include "Shaders\Shader.h"
 
 #include <set>
 #include <vector>
@@ -10,6 +11,7 @@
 #include <BULLET\btBulletCollisionCommon.h>
 #include <BULLET\btBulletDynamicsCommon.h>
 #include "OpenGLMotionState.h"
+#include "CollisionGroups.h"
 
 class CatmullRomSpline;
 
@@ -28,6 +30,8 @@ public:
 
     // Inherited via PrimitiveShape
     virtual void Render(std::string shader = "") override;
+	//positions only for the depth pre-pass, the bound program reads aPos from location 0.
+	void RenderDepth();
 
     float GetHeight(int x, int z);
 	float GetSize() { return SIZE; }
@@ -40,6 +44,9 @@ public:
 
 	btRigidBody* GetRigidBody() { return _TerrainBody; }
 
+	//world space ray against the heightfield, only tests the cells the ray passes over.
+	bool RayCast(const glm::vec3& from, const glm::vec3& to, float& fraction, glm::vec3& normal);
+
     glm::mat4 GetModelMatrix() {
         if (_MotionState) { return _MotionState->GetWorldMatrix(); }
         else { return glm::mat4(1.0f); }
@@ -63,7 +70,14 @@ private:
     std::vector<Texture*> _Textures;
     Texture*    _BlendMap;
     Buffer  _ElementBuffer;
-    std::string _Shader;
+    ShaderID _Shader;
+
+    //material uniforms looked up on the first render rather than built from strings every frame.
+    Shader* _UniformProgram = nullptr;	// Program the handles came from, permutations swap it.
+    unsigned int _UniformVersion = 0;	// Program version the handles came from.
+    UniformHandle _BlendMapUniform;
+    UniformHandle _ShininessUniform;
+    std::vector<UniformHandle> _TextureUniforms;
 
     btTriangleIndexVertexArray* _IndexArray;
     btBvhTriangleMeshShape* _MeshShape;
@@ -77,4 +91,5 @@ private:
     std::vector<unsigned int> _Indices;
 
 	glm::vec3 SurfaceNormalFromIndices(int a, int b, int c);
+	bool RayTriangle(const glm::vec3& start, const glm::vec3& dir, int a, int b, int c, float& fraction, glm::vec3& normal);
 };
\ No newline at end of file
@@ -1,121 +1,495 @@
 #include "TextRenderer.h"
 #include "ShaderManager.h"
+#include "RenderState.h"
+#include "LogManager.h"
+#include "DistanceField.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
 
+static const char ATLAS_MAGIC[4] = { 'U', 'G', 'F', 'A' };
+static const uint32_t ATLAS_VERSION = 2;
+static const uint32_t REPLACEMENT_CHARACTER = 0xFFFD;
 
-TextRenderer::TextRenderer(std::string fontPath)
+//64 bit FNV-1a, the same hash the program cache keys on.
+static uint64_t HashBytes(const char* data, size_t size, uint64_t hash)
 {
-	FT_Library _Freetype;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+//decodes the code point starting at index and moves past it.
+//a malformed sequence gives the replacement character and skips only its first byte.
+static uint32_t NextCodePoint(const std::string& text, size_t& index)
+{
+	unsigned char lead = (unsigned char)text[index++];
+	if (lead < 0x80) {
+		return lead;
+	}
+	int extra;
+	uint32_t code;
+	if ((lead & 0xE0) == 0xC0) {
+		extra = 1;
+		code = lead & 0x1F;
+	}
+	else if ((lead & 0xF0) == 0xE0) {
+		extra = 2;
+		code = lead & 0x0F;
+	}
+	else if ((lead & 0xF8) == 0xF0) {
+		extra = 3;
+		code = lead & 0x07;
+	}
+	else {
+		return REPLACEMENT_CHARACTER;
+	}
+	size_t start = index;
+	for (int i = 0; i < extra; i++) {
+		if (index >= text.size() || ((unsigned char)text[index] & 0xC0) != 0x80) {
+			index = start;
+			return REPLACEMENT_CHARACTER;
+		}
+		code = (code << 6) | ((unsigned char)text[index++] & 0x3F);
+	}
+	//overlong forms, surrogates and anything past the last plane are not valid.
+	static const uint32_t shortest[] = { 0, 0x80, 0x800, 0x10000 };
+	if (code < shortest[extra] || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+		index = start;
+		return REPLACEMENT_CHARACTER;
+	}
+	return code;
+}
+
+TextRenderer::TextRenderer(std::string fontPath) :
+	_LayoutCount(0),
+	_Atlas(0),
+	_AtlasHeight(0),
+	_CacheTop(0),
+	_Freetype(nullptr),
+	_Face(nullptr)
+{
+	std::fill(_Ascii, _Ascii + 128, Character{ glm::vec4(0.0f), glm::vec2(0.0f), glm::vec2(0.0f), 0 });
+	std::fill(_AsciiLoaded, _AsciiLoaded + 128, false);
+
+	std::ifstream font(fontPath, std::ios::binary);
+	if (!font.is_open()) {
+		LogManager::Instance()->LogError("Could not open font " + fontPath);
+		return;
+	}
+	_FontData.assign(std::istreambuf_iterator<char>(font), std::istreambuf_iterator<char>());
+	//the face stays open so glyphs outside ascii can be made when they are first drawn.
 	if (FT_Init_FreeType(&_Freetype)) {
-		return; //Error occured
+		LogManager::Instance()->LogError("Could not start FreeType for " + fontPath);
+		_Freetype = nullptr;
+		return;
 	}
-	FT_Face _Face;
-	if (FT_New_Face(_Freetype, fontPath.c_str(), 0, &_Face)) {
-		return; //Error occured
+	if (FT_New_Memory_Face(_Freetype, (const FT_Byte*)_FontData.data(), (FT_Long)_FontData.size(), 0, &_Face)) {
+		LogManager::Instance()->LogError("Could not load font " + fontPath);
+		_Face = nullptr;
+		return;
 	}
-	FT_Set_Pixel_Sizes(_Face, 0, 48);
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	FT_Set_Pixel_Sizes(_Face, 0, FONT_SIZE * SDF_OVERSAMPLE);
 
-	for (GLubyte c = 0; c < 128; c++)
-	{
-		// Load character glyph 
-		if (FT_Load_Char(_Face, c, FT_LOAD_RENDER))
-		{
-			continue; //failed to load a glyph
-		}
-		// Generate texture
-		GLuint texture;
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(
-			GL_TEXTURE_2D,
-			0,
-			GL_RED,
-			_Face->glyph->bitmap.width,
-			_Face->glyph->bitmap.rows,
-			0,
-			GL_RED,
-			GL_UNSIGNED_BYTE,
-			_Face->glyph->bitmap.buffer
-		);
-		// Set texture options
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		// Now store character for later use
-		Character character = {
-			texture,
-			glm::ivec2(_Face->glyph->bitmap.width, _Face->glyph->bitmap.rows),
-			glm::ivec2(_Face->glyph->bitmap_left, _Face->glyph->bitmap_top),
-			(GLuint)_Face->glyph->advance.x
-		};
-		_Characters.insert(std::pair<GLchar, Character>(c, character));
-	}
-	glBindTexture(GL_TEXTURE_2D, 0);
-	// Destroy FreeType once we're finished
-	FT_Done_Face(_Face);
-	FT_Done_FreeType(_Freetype);
+	//an edited font or different field settings miss the cache.
+	int settings[] = { (int)ATLAS_VERSION, FONT_SIZE, SDF_OVERSAMPLE, SDF_SPREAD, ATLAS_WIDTH, ATLAS_PADDING };
+	uint64_t key = HashBytes(_FontData.data(), _FontData.size(), 14695981039346656037ull);
+	key = HashBytes((const char*)settings, sizeof(settings), key);
+
+	size_t nameStart = fontPath.find_last_of("/\\");
+	std::string name = fontPath.substr(nameStart == std::string::npos ? 0 : nameStart + 1);
+	std::string cachePath = "Data/" + name.substr(0, name.find_last_of('.')) + ".atlas";
+
+	std::vector<unsigned char> pixels;
+	int asciiHeight = 0;
+	if (!LoadAtlas(cachePath, key, pixels, asciiHeight)) {
+		BuildAtlas(pixels, asciiHeight);
+		SaveAtlas(cachePath, key, pixels, asciiHeight);
+	}
+
+	//the cell page sits under the ascii glyphs so every string still draws from one texture.
+	_CacheTop = asciiHeight;
+	_AtlasHeight = asciiHeight + CACHE_ROWS * CELL_SIZE;
+	pixels.resize(ATLAS_WIDTH * _AtlasHeight, 0);
+	glm::vec4 texelSize(1.0f / ATLAS_WIDTH, 1.0f / _AtlasHeight, 1.0f / ATLAS_WIDTH, 1.0f / _AtlasHeight);
+	for (int c = 0; c < 128; c++) {
+		_Ascii[c].UVs *= texelSize;
+	}
+	for (int cell = CACHE_ROWS * CACHE_COLUMNS - 1; cell >= 0; cell--) {
+		_FreeCells.push_back(cell);
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glGenTextures(1, &_Atlas);
+	RenderState::Instance()->BindTexture(0, _Atlas);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, _AtlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+	// Set texture options
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	RenderState::Instance()->BindTexture(0, 0);
 
 	_VertexArray.Create(VAO);
-	_VertexBuffer.Create(VBO);
+	_VertexBuffer.CreateRing(VBO, RING_SEGMENT_SIZE);
 
 	_VertexArray.Bind();
-	_VertexBuffer.Fill(sizeof(GLfloat) * 6 * 4, NULL, DYNAMIC);
-	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("texture")->GetID(), "aPos", 3, VT_FLOAT, 5 * sizeof(float));
-	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("texture")->GetID(), "aTexCoords", 3, VT_FLOAT, 5 * sizeof(float), 3 * sizeof(float));
+	_VertexBuffer.Bind();
+	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("texture"))->GetID(), "aPos", 3, VT_FLOAT, VERTEX_STRIDE);
+	_VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("texture"))->GetID(), "aTexCoords", 2, VT_FLOAT, VERTEX_STRIDE, 3 * sizeof(float));
 
 }
 
 
 TextRenderer::~TextRenderer()
 {
+	if (_Atlas != 0) {
+		glDeleteTextures(1, &_Atlas);
+		RenderState::Instance()->Invalidate();
+	}
+	if (_Face != nullptr) {
+		FT_Done_Face(_Face);
+	}
+	if (_Freetype != nullptr) {
+		FT_Done_FreeType(_Freetype);
+	}
 }
 
 void TextRenderer::RenderText(std::string text, glm::vec2 pos, float scale, bool center, glm::vec3 color)
 {
-	ShaderManager::Instance()->GetShader("texture")->SetVec3("color", color);
-	ShaderManager::Instance()->GetShader("texture")->SetInt("textureImage", 0);
-	ShaderManager::Instance()->GetShader("texture")->SetBool("RenderingText", true);
+	if (_Atlas == 0) {
+		return;
+	}
+	const TextLayout& layout = GetLayout(text);
+	//a cached layout skips GetGlyph, so its glyphs are marked used here or they would age out while on screen.
+	for (uint32_t code : layout.Glyphs) {
+		auto search = _Glyphs.find(code);
+		if (search != _Glyphs.end()) {
+			_GlyphOrder.splice(_GlyphOrder.begin(), _GlyphOrder, search->second.Order);
+		}
+	}
+	int vertexCount = (int)layout.Vertices.size() / 5;
+	if (vertexCount == 0) {
+		return;
+	}
+
+	Shader* shader = ShaderManager::Instance()->BindShader(SHADER_ID("texture"));
+	shader->SetVec3("color", color);
+	shader->SetInt("textureImage", 0);
+	shader->SetBool("RenderingText", true);
+	RenderState::Instance()->BindTexture(0, _Atlas);
 	_VertexArray.Bind();
-	glActiveTexture(GL_TEXTURE0);
-	// Iterate through all characters
-
-	std::string::const_iterator c;
-	glm::vec2 offset = glm::vec2(0.0f, 0.0f);
-	if (center) { //if text is centered calculate the size of the string.
-		for (c = text.begin(); c != text.end(); c++) {
-			offset.x += _Characters[*c].Size.x * scale + _Characters[*c].Bearing.x * scale;
+
+	glm::vec2 origin = pos;
+	if (center) {
+		origin.x -= layout.Width * scale * 0.5f;
+	}
+	//the cached quads are scaled and moved as they are written, one draw per batch.
+	const int batchSize = (_VertexBuffer.GetSegmentSize() - VERTEX_STRIDE) / (6 * VERTEX_STRIDE) * 6;
+	for (int start = 0; start < vertexCount; start += batchSize)
+	{
+		int count = std::min(batchSize, vertexCount - start);
+		int ringOffset;
+		GLfloat* vertices = (GLfloat*)_VertexBuffer.MapRing(count * VERTEX_STRIDE, VERTEX_STRIDE, ringOffset);
+		const GLfloat* source = &layout.Vertices[start * 5];
+		for (int i = 0; i < count; i++, vertices += 5, source += 5)
+		{
+			vertices[0] = origin.x + source[0] * scale;
+			vertices[1] = origin.y + source[1] * scale;
+			vertices[2] = source[2];
+			vertices[3] = source[3];
+			vertices[4] = source[4];
 		}
+		_VertexBuffer.UnmapRing();
+		RenderState::Instance()->DrawArrays(GL_TRIANGLES, ringOffset / VERTEX_STRIDE, count);
 	}
-	for (c = text.begin(); c != text.end(); c++)
+	RenderState::Instance()->BindTexture(0, 0);
+}
+
+const TextRenderer::TextLayout& TextRenderer::GetLayout(const std::string& text)
+{
+	auto search = _Layouts.find(text);
+	if (search != _Layouts.end()) {
+		return search->second;
+	}
+
+	//built aside, making a glyph can evict one and empty the cache.
+	_LayoutCount++;
+	TextLayout layout;
+	layout.Width = 0.0f;
+	float x = 0.0f;
+	for (size_t i = 0; i < text.size();)
 	{
-		Character ch = _Characters[*c];
-
-		//get positions for each quad using position and offset if centered.
-		GLfloat xpos = (pos.x - offset.x * 0.5f) + ch.Bearing.x * scale;
-		GLfloat ypos = (pos.y - offset.y * 0.5f) - (ch.Size.y - ch.Bearing.y) * scale;
-
-		GLfloat w = ch.Size.x * scale;
-		GLfloat h = ch.Size.y * scale;
-		// Update VBO for each character
-		GLfloat vertices[6][5] = {
-		{ xpos,     ypos + h,0.0,   0.0, 0.0 },
-		{ xpos,     ypos,0.0,       0.0, 1.0 },
-		{ xpos + w, ypos,0.0,       1.0, 1.0 },
-
-		{ xpos,     ypos + h,0.0,   0.0, 0.0 },
-		{ xpos + w, ypos,0.0,       1.0, 1.0 },
-		{ xpos + w, ypos + h,0.0,   1.0, 0.0 }
-		};
-		// Render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-		// Update content of VBO memory
-		_VertexBuffer.Fill(sizeof(vertices), vertices, DYNAMIC);
-		// Render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		uint32_t code = NextCodePoint(text, i);
+		const Character* glyph = GetGlyph(code);
+		if (glyph == nullptr) {
+			continue;
+		}
+		if (code >= 128) {
+			layout.Glyphs.push_back(code);
+		}
+		const Character ch = *glyph;
+		//the width centering has always used.
+		layout.Width += ch.Size.x + ch.Bearing.x;
+
+		//glyphs with nothing to draw, like spaces, only move the cursor.
+		if (ch.Size.x > 0 && ch.Size.y > 0) {
+			//the quad takes in the border the field fades out over.
+			GLfloat xpos = x + ch.Bearing.x - SDF_SPREAD;
+			GLfloat ypos = -(ch.Size.y - ch.Bearing.y) - SDF_SPREAD;
+			GLfloat w = ch.Size.x + 2 * SDF_SPREAD;
+			GLfloat h = ch.Size.y + 2 * SDF_SPREAD;
+			GLfloat quad[6][5] = {
+			{ xpos,     ypos + h,0.0,   ch.UVs.x, ch.UVs.y },
+			{ xpos,     ypos,0.0,       ch.UVs.x, ch.UVs.w },
+			{ xpos + w, ypos,0.0,       ch.UVs.z, ch.UVs.w },
+
+			{ xpos,     ypos + h,0.0,   ch.UVs.x, ch.UVs.y },
+			{ xpos + w, ypos,0.0,       ch.UVs.z, ch.UVs.w },
+			{ xpos + w, ypos + h,0.0,   ch.UVs.z, ch.UVs.y }
+			};
+			layout.Vertices.insert(layout.Vertices.end(), &quad[0][0], &quad[0][0] + 6 * 5);
+		}
 		// Now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-		pos.x += (ch.Advance >> 6) * scale; // Bitshift by 6 to get value in pixels (2^6 = 64)
+		x += ch.Advance >> 6; // Bitshift by 6 to get value in pixels (2^6 = 64)
+	}
+
+	if (_Layouts.size() >= MAX_LAYOUTS) {
+		_Layouts.clear();
+	}
+	return _Layouts.emplace(text, std::move(layout)).first->second;
+}
+
+const Character* TextRenderer::GetGlyph(uint32_t code)
+{
+	if (code < 128) {
+		return _AsciiLoaded[code] ? &_Ascii[code] : nullptr;
+	}
+	auto search = _Glyphs.find(code);
+	if (search == _Glyphs.end()) {
+		return LoadGlyph(code);
+	}
+	CachedGlyph& entry = search->second;
+	entry.LastLayout = _LayoutCount;
+	_GlyphOrder.splice(_GlyphOrder.begin(), _GlyphOrder, entry.Order);
+	return &entry.Glyph;
+}
+
+const Character* TextRenderer::LoadGlyph(uint32_t code)
+{
+	//one glyph is quick enough to make on the spot.
+	CachedGlyph entry;
+	entry.Cell = -1;
+	entry.LastLayout = _LayoutCount;
+	GlyphBitmap glyph;
+	if (!RasterizeGlyph(code, glyph, entry.Glyph)) {
+		entry.Glyph = { glm::vec4(0.0f), glm::vec2(0.0f), glm::vec2(0.0f), 0 };
+	}
+	else if (entry.Glyph.Size.x > 0 && entry.Glyph.Size.y > 0) {
+		glyph.Field = buildDistanceField(glyph.Coverage.data(), glyph.Width, glyph.Height, glyph.Width,
+			SDF_OVERSAMPLE, SDF_SPREAD, glyph.FieldWidth, glyph.FieldHeight);
+		if (glyph.FieldWidth > CELL_SIZE || glyph.FieldHeight > CELL_SIZE) {
+			LogManager::Instance()->LogWarning("Glyph " + std::to_string(code) + " is too big for a glyph cache cell.");
+			entry.Glyph.Size = glm::vec2(0.0f);
+		}
+		else {
+			if (_FreeCells.empty() && !EvictGlyph()) {
+				return nullptr;
+			}
+			entry.Cell = _FreeCells.back();
+			_FreeCells.pop_back();
+
+			//the whole cell is written so nothing of the glyph it held is left.
+			std::vector<unsigned char> pixels(CELL_SIZE * CELL_SIZE, 0);
+			for (int y = 0; y < glyph.FieldHeight; y++) {
+				std::copy(glyph.Field.begin() + y * glyph.FieldWidth, glyph.Field.begin() + (y + 1) * glyph.FieldWidth, pixels.begin() + y * CELL_SIZE);
+			}
+			glm::ivec2 place((entry.Cell % CACHE_COLUMNS) * CELL_SIZE, _CacheTop + (entry.Cell / CACHE_COLUMNS) * CELL_SIZE);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			RenderState::Instance()->BindTexture(0, _Atlas);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, place.x, place.y, CELL_SIZE, CELL_SIZE, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+			entry.Glyph.UVs = glm::vec4((float)place.x / ATLAS_WIDTH, (float)place.y / _AtlasHeight,
+				(float)(place.x + glyph.FieldWidth) / ATLAS_WIDTH, (float)(place.y + glyph.FieldHeight) / _AtlasHeight);
+		}
+	}
+
+	_GlyphOrder.push_front(code);
+	entry.Order = _GlyphOrder.begin();
+	return &_Glyphs.emplace(code, entry).first->second.Glyph;
+}
+
+bool TextRenderer::EvictGlyph()
+{
+	//glyphs without a cell go too as they are passed, they are cheap to make again.
+	while (!_GlyphOrder.empty()) {
+		auto victim = _Glyphs.find(_GlyphOrder.back());
+		if (victim->second.LastLayout == _LayoutCount) {
+			return false;
+		}
+		int cell = victim->second.Cell;
+		_GlyphOrder.pop_back();
+		_Glyphs.erase(victim);
+		if (cell >= 0) {
+			_FreeCells.push_back(cell);
+			//cached layouts can still point at the old glyph.
+			_Layouts.clear();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TextRenderer::RasterizeGlyph(uint32_t code, GlyphBitmap& glyph, Character& character)
+{
+	// Load character glyph 
+	if (FT_Load_Char(_Face, code, FT_LOAD_RENDER))
+	{
+		return false; //failed to load a glyph
+	}
+	FT_Bitmap& bitmap = _Face->glyph->bitmap;
+	glyph.Width = bitmap.width;
+	glyph.Height = bitmap.rows;
+	//rows can be padded, copy them out tightly packed.
+	glyph.Coverage.resize(glyph.Width * glyph.Height);
+	for (int y = 0; y < glyph.Height; y++) {
+		std::copy(bitmap.buffer + y * bitmap.pitch, bitmap.buffer + y * bitmap.pitch + glyph.Width, glyph.Coverage.begin() + y * glyph.Width);
+	}
+	// Now store character for later use, in layout units rather than the rasterized size
+	float unit = 1.0f / SDF_OVERSAMPLE;
+	character = {
+		glm::vec4(0.0f),
+		glm::vec2((float)((glyph.Width + SDF_OVERSAMPLE - 1) / SDF_OVERSAMPLE), (float)((glyph.Height + SDF_OVERSAMPLE - 1) / SDF_OVERSAMPLE)),
+		glm::vec2(_Face->glyph->bitmap_left * unit, _Face->glyph->bitmap_top * unit),
+		(GLuint)(_Face->glyph->advance.x / SDF_OVERSAMPLE)
+	};
+	if (glyph.Width == 0 || glyph.Height == 0) {
+		character.Size = glm::vec2(0.0f);
+	}
+	return true;
+}
+
+void TextRenderer::BuildAtlas(std::vector<unsigned char>& pixels, int& atlasHeight)
+{
+	//freetype is not thread safe, so rasterize here and build the fields in parallel after.
+	std::vector<GlyphBitmap> glyphs(128);
+	for (int c = 0; c < 128; c++)
+	{
+		_AsciiLoaded[c] = RasterizeGlyph(c, glyphs[c], _Ascii[c]);
+	}
+
+	//each thread takes the next glyph until there are none left.
+	std::atomic<int> next(0);
+	auto buildFields = [&]() {
+		for (int c = next.fetch_add(1); c < 128; c = next.fetch_add(1)) {
+			GlyphBitmap& glyph = glyphs[c];
+			if (!glyph.Coverage.empty()) {
+				glyph.Field = buildDistanceField(glyph.Coverage.data(), glyph.Width, glyph.Height, glyph.Width,
+					SDF_OVERSAMPLE, SDF_SPREAD, glyph.FieldWidth, glyph.FieldHeight);
+			}
+		}
+	};
+	unsigned int hardware = std::thread::hardware_concurrency();
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1; i < hardware; i++) {
+		workers.push_back(std::thread(buildFields));
+	}
+	buildFields();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	//every field is packed into rows of one atlas texture, so a whole string draws with one bind.
+	std::vector<glm::ivec2> places(128);
+	glm::ivec2 cursor(ATLAS_PADDING);
+	int rowHeight = 0;
+	for (int c = 0; c < 128; c++)
+	{
+		const GlyphBitmap& glyph = glyphs[c];
+		if (cursor.x + glyph.FieldWidth + ATLAS_PADDING > ATLAS_WIDTH) {
+			cursor = glm::ivec2(ATLAS_PADDING, cursor.y + rowHeight + ATLAS_PADDING);
+			rowHeight = 0;
+		}
+		places[c] = cursor;
+		cursor.x += glyph.FieldWidth + ATLAS_PADDING;
+		rowHeight = std::max(rowHeight, glyph.FieldHeight);
+	}
+	atlasHeight = 1;
+	while (atlasHeight < cursor.y + rowHeight + ATLAS_PADDING) {
+		atlasHeight *= 2;
+	}
+
+	pixels.assign(ATLAS_WIDTH * atlasHeight, 0);
+	for (int c = 0; c < 128; c++)
+	{
+		const GlyphBitmap& glyph = glyphs[c];
+		glm::ivec2 place = places[c];
+		for (int y = 0; y < glyph.FieldHeight; y++) {
+			std::copy(glyph.Field.begin() + y * glyph.FieldWidth, glyph.Field.begin() + (y + 1) * glyph.FieldWidth, pixels.begin() + (place.y + y) * ATLAS_WIDTH + place.x);
+		}
+		_Ascii[c].UVs = glm::vec4(place.x, place.y, place.x + glyph.FieldWidth, place.y + glyph.FieldHeight);
+	}
+}
+
+bool TextRenderer::LoadAtlas(const std::string& cachePath, uint64_t key, std::vector<unsigned char>& pixels, int& atlasHeight)
+{
+	std::ifstream file(cachePath, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+	char magic[4];
+	uint64_t fileKey = 0;
+	int32_t height = 0;
+	file.read(magic, sizeof(magic));
+	file.read((char*)&fileKey, sizeof(fileKey));
+	file.read((char*)&height, sizeof(height));
+	//the version is part of the key.
+	if (!file || std::memcmp(magic, ATLAS_MAGIC, sizeof(magic)) != 0 || fileKey != key) {
+		return false;
+	}
+	//checked before allocating so a corrupt file cannot ask for gigabytes.
+	std::streamoff position = file.tellg();
+	file.seekg(0, std::ios::end);
+	std::streamoff remaining = file.tellg() - position;
+	file.seekg(position);
+	std::streamoff expected = (std::streamoff)(sizeof(_Ascii) + sizeof(_AsciiLoaded)) + (std::streamoff)ATLAS_WIDTH * height;
+	if (height <= 0 || height > MAX_ATLAS_HEIGHT || expected > remaining) {
+		LogManager::Instance()->LogWarning("Font atlas " + cachePath + " is corrupt, rebuilding it.");
+		return false;
+	}
+	Character ascii[128];
+	bool loaded[128];
+	file.read((char*)ascii, sizeof(ascii));
+	file.read((char*)loaded, sizeof(loaded));
+	pixels.resize(ATLAS_WIDTH * height);
+	file.read((char*)pixels.data(), pixels.size());
+	if (!file) {
+		LogManager::Instance()->LogWarning("Font atlas " + cachePath + " is truncated, rebuilding it.");
+		return false;
+	}
+	std::copy(ascii, ascii + 128, _Ascii);
+	std::copy(loaded, loaded + 128, _AsciiLoaded);
+	atlasHeight = height;
+	return true;
+}
+
+void TextRenderer::SaveAtlas(const std::string& cachePath, uint64_t key, const std::vector<unsigned char>& pixels, int atlasHeight)
+{
+	std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		LogManager::Instance()->LogWarning("Could not write font atlas " + cachePath);
+		return;
 	}
-	glBindTexture(GL_TEXTURE_2D, 0);
+	int32_t height = atlasHeight;
+	file.write(ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+	file.write((const char*)&key, sizeof(key));
+	file.write((const char*)&height, sizeof(height));
+	file.write((const char*)_Ascii, sizeof(_Ascii));
+	file.write((const char*)_AsciiLoaded, sizeof(_AsciiLoaded));
+	file.write((const char*)pixels.data(), pixels.size());
 }
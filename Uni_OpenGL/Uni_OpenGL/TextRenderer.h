@@ -6,30 +6,115 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-#include <map>
+#include <cstdint>
+#include <list>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "Buffer.h"
 
 struct Character {
-	GLuint TextureID;   // ID handle of the glyph texture
-	glm::ivec2 Size;    // Size of glyph
-	glm::ivec2 Bearing;  // Offset from baseline to left/top of glyph
+	glm::vec4 UVs;      // Atlas rectangle of the glyph and its distance border, min then max texture coordinates
+	glm::vec2 Size;     // Size of glyph
+	glm::vec2 Bearing;  // Offset from baseline to left/top of glyph
 	GLuint Advance;    // Horizontal offset to advance to next glyph
 };
 
+////////////////////////////////////////////////////////////
+/// Draws UTF-8 text from a signed distance field atlas.
+/// --Glyphs are rasterized large and turned into distance
+/// --fields, so one atlas stays sharp at any scale. ASCII is
+/// --built up front on every core and cached under Data,
+/// --rebuilt when the font file changes. Other characters are
+/// --made the first time they are drawn into a page of fixed
+/// --cells below it, replacing the least recently used glyph
+/// --once the cells are full.
+////////////////////////////////////////////////////////////
 class TextRenderer
 {
 public:
 	TextRenderer(std::string fontPath);
 	~TextRenderer();
 
+	//text is UTF-8, malformed bytes draw as the replacement character.
 	void RenderText(std::string text, glm::vec2 pos, float scale, bool center = false, glm::vec3 color = glm::vec3(1.0, 1.0, 1.0));
 
 private:
-	std::map<GLchar, Character> _Characters;
+	//quads for a string at scale 1 starting from the origin, moved into place as they are streamed.
+	struct TextLayout {
+		std::vector<GLfloat> Vertices;
+		float Width;	// Used to center the string.
+		std::vector<uint32_t> Glyphs;	// Code points it uses from the glyph cache.
+	};
+
+	struct GlyphBitmap {
+		std::vector<unsigned char> Coverage;
+		int Width = 0;
+		int Height = 0;
+		std::vector<unsigned char> Field;
+		int FieldWidth = 0;
+		int FieldHeight = 0;
+	};
+
+	struct CachedGlyph {
+		Character Glyph;
+		int Cell;			// -1 when there is nothing to draw.
+		uint32_t LastLayout;	// Layout that last used it, those are not evicted while being built.
+		std::list<uint32_t>::iterator Order;
+	};
+
+	//a string is written to the ring in one go, longer ones are split.
+	const int RING_SEGMENT_SIZE = 64 * 1024;
+	const int VERTEX_STRIDE = 5 * sizeof(GLfloat);
+	const int ATLAS_WIDTH = 512;
+	//texels left empty around each glyph so filtering does not bleed into its neighbours.
+	const int ATLAS_PADDING = 1;
+	//layout units, a scale of 1 draws glyphs this many pixels high.
+	const int FONT_SIZE = 48;
+	//glyphs are rasterized this many times larger than the field they make.
+	const int SDF_OVERSAMPLE = 4;
+	//distance kept either side of the edge, in atlas texels. Also the border around each glyph.
+	const int SDF_SPREAD = 6;
+	//ascii fits in a fraction of this, a cached atlas claiming more is corrupt.
+	const int MAX_ATLAS_HEIGHT = 4096;
+	//the glyph cache page, fields bigger than a cell are not drawn.
+	const int CELL_SIZE = 64;
+	const int CACHE_COLUMNS = 8;
+	const int CACHE_ROWS = 8;
+	//text that changes every frame would grow the cache forever, it is emptied at this size.
+	const size_t MAX_LAYOUTS = 256;
+
+	//ascii skips the hash lookup.
+	Character _Ascii[128];
+	bool _AsciiLoaded[128];
+	std::unordered_map<uint32_t, CachedGlyph> _Glyphs;
+	std::list<uint32_t> _GlyphOrder;	// Most recently used first.
+	std::vector<int> _FreeCells;
+	uint32_t _LayoutCount;
+
+	std::unordered_map<std::string, TextLayout> _Layouts;
+	GLuint _Atlas;
+	int _AtlasHeight;
+	int _CacheTop;		// First atlas row of the cell page.
+
+	std::vector<char> _FontData;	// The face reads from this for as long as it is open.
+	FT_Library _Freetype;
+	FT_Face _Face;
 
 	Buffer _VertexArray;
 	Buffer _VertexBuffer;
-};
 
+	const TextLayout& GetLayout(const std::string& text);
+	const Character* GetGlyph(uint32_t code);
+	//makes a glyph and puts it in a free cell, null if every cell is used by the layout being built.
+	const Character* LoadGlyph(uint32_t code);
+	bool EvictGlyph();
+
+	//rasterizes one glyph oversampled with its metrics in layout units, the atlas rectangle is left to the caller.
+	bool RasterizeGlyph(uint32_t code, GlyphBitmap& glyph, Character& character);
+	//builds and packs the ascii fields, rectangles are left in texels.
+	void BuildAtlas(std::vector<unsigned char>& pixels, int& atlasHeight);
+	bool LoadAtlas(const std::string& cachePath, uint64_t key, std::vector<unsigned char>& pixels, int& atlasHeight);
+	void SaveAtlas(const std::string& cachePath, uint64_t key, const std::vector<unsigned char>& pixels, int atlasHeight);
+};
@@ -2,6 +2,7 @@
 #include <SDL\SDL_image.h>
 #include <GLEW\glew.h>
 #include "LogManager.h"
+#include "RenderState.h"
 
 Texture::Texture()
 {
@@ -44,7 +45,7 @@ bool Texture::Load(std::string FileName, std::string textureName)
 			//create opengl texture
 			glGenTextures(1, &_ID);
 			//bind texture
-			glBindTexture(GL_TEXTURE_2D, _ID);
+			RenderState::Instance()->BindTexture(0, _ID);
 			//set texture wrapping parameters
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -74,5 +75,6 @@ bool Texture::Load(std::string FileName, std::string textureName)
 bool Texture::Unload()
 {
 	glDeleteTextures(1, &_ID);
+	RenderState::Instance()->Invalidate();
 	return true;
 }
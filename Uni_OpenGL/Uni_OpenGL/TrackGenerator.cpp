@@ -2,6 +2,7 @@
 #include "PRNG.h"
 
 #include "ShaderManager.h"
+#include "RenderState.h"
 
 #include <math.h>
 #include <GLM\gtc\constants.hpp>
@@ -197,18 +198,18 @@ void TrackGenerator::AddToBuffer()
     _VertexArray.Bind();
     _VertexBuffer.Fill(sizeof(float) * points.size(), &points[0], STATIC);
 
-    _VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("basic")->GetID(), "aPos", 3, VT_FLOAT, 6 * sizeof(float));
-    _VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader("basic")->GetID(), "aNormal", 3, VT_FLOAT, 6 * sizeof(float), 3 * sizeof(float));
+    _VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("basic"))->GetID(), "aPos", 3, VT_FLOAT, 6 * sizeof(float));
+    _VertexBuffer.AddAttribPointer(ShaderManager::Instance()->GetShader(SHADER_ID("basic"))->GetID(), "aNormal", 3, VT_FLOAT, 6 * sizeof(float), 3 * sizeof(float));
     _VertexArray.Unbind();
 
 }
 
 void TrackGenerator::Render(std::string shader)
 {
-    ShaderManager::Instance()->GetShader("basic")->SetVec3("aColor", glm::vec3(0.0, 0.0, 1.0));
+    ShaderManager::Instance()->BindShader(SHADER_ID("basic"))->SetVec3("aColor", glm::vec3(0.0, 0.0, 1.0));
     glLineWidth(10);
     _VertexArray.Bind();
-        glDrawArrays(GL_LINE_STRIP, 0, _Points.size());
+        RenderState::Instance()->DrawArrays(GL_LINE_STRIP, 0, _Points.size());
     _VertexArray.Unbind();
 }
 
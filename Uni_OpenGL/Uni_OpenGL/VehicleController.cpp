@@ -0,0 +1,13 @@
+#include "VehicleController.h"
+#include "ActionManager.h"
+
+VehicleInput KeyboardVehicleController::GetInput(BVehicle*, float)
+{
+	//action values are how much of the frame each key was down, so short taps give partial input.
+	ActionManager* actions = ActionManager::Instance();
+	VehicleInput input;
+	input.Steer = actions->GetActionValue(ACTION_STEER_LEFT) - actions->GetActionValue(ACTION_STEER_RIGHT);
+	input.Throttle = actions->GetActionValue(ACTION_ACCELERATE);
+	input.Brake = actions->GetActionValue(ACTION_BRAKE);
+	return input;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+class BVehicle;
+
+////////////////////////////////////////////////////////////
+/// Control input for one vehicle for one step.
+/// --Steer-- -1 to 1, positive steers left.
+/// --Throttle-- 0 to 1.
+/// --Brake-- 0 to 1, reverses once the vehicle has stopped.
+////////////////////////////////////////////////////////////
+struct VehicleInput {
+	float Steer = 0.0f;
+	float Throttle = 0.0f;
+	float Brake = 0.0f;
+};
+
+////////////////////////////////////////////////////////////
+/// Anything that can drive a vehicle, the keyboard, an AI
+/// --or a recorded replay.
+////////////////////////////////////////////////////////////
+class VehicleController
+{
+public:
+	virtual ~VehicleController() {}
+
+	virtual VehicleInput GetInput(BVehicle* vehicle, float delta) = 0;
+};
+
+////////////////////////////////////////////////////////////
+/// Drives a vehicle from the keys bound in the ActionManager.
+////////////////////////////////////////////////////////////
+class KeyboardVehicleController : public VehicleController
+{
+public:
+	virtual VehicleInput GetInput(BVehicle* vehicle, float delta) override;
+};
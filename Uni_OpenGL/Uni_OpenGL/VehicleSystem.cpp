@@ -0,0 +1,171 @@
+#include "VehicleSystem.h"
+#include "BVehicle.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+VehicleSystem::VehicleSystem()
+{
+}
+
+VehicleSystem::~VehicleSystem()
+{
+	Clear();
+}
+
+int VehicleSystem::AddVehicle(BVehicle * vehicle, VehicleController * controller, const VehicleTuning & tuning)
+{
+	_Vehicles.push_back(vehicle);
+	_Controllers.push_back(controller);
+
+	_SteerInput.push_back(0.0f);
+	_ThrottleInput.push_back(0.0f);
+	_BrakeInput.push_back(0.0f);
+
+	_SteeringIncrement.push_back(tuning.SteeringIncrement);
+	_MaxSteering.push_back(tuning.MaxSteering);
+	_AccelerationRate.push_back(tuning.AccelerationRate);
+	_MaxEngineForce.push_back(tuning.MaxEngineForce);
+	_MaxReverseEngineForce.push_back(tuning.MaxReverseEngineForce);
+	_MaxSpeed.push_back(tuning.MaxSpeed);
+	_MaxBrakeForce.push_back(tuning.MaxBrakeForce);
+
+	_Speed.push_back(0.0f);
+	_Steering.push_back(0.0f);
+	_EngineForce.push_back(0.0f);
+	_BrakeForce.push_back(0.0f);
+	_Reversing.push_back(0);
+
+	return (int)_Vehicles.size() - 1;
+}
+
+void VehicleSystem::RemoveVehicle(BVehicle * vehicle)
+{
+	for (int i = 0; i < (int)_Vehicles.size(); i++) {
+		if (_Vehicles[i] == vehicle) {
+			RemoveAt(i);
+			return;
+		}
+	}
+}
+
+void VehicleSystem::Clear()
+{
+	while (!_Vehicles.empty()) {
+		RemoveAt((int)_Vehicles.size() - 1);
+	}
+}
+
+void VehicleSystem::SetController(int index, VehicleController * controller)
+{
+	if (_Controllers[index] != controller) {
+		delete _Controllers[index];
+	}
+	_Controllers[index] = controller;
+}
+
+void VehicleSystem::Update(float delta)
+{
+	PROFILE_SCOPE("VehicleSystem::Update");
+	int count = (int)_Vehicles.size();
+
+	//gather, controllers and speeds into the arrays.
+	for (int i = 0; i < count; i++) {
+		VehicleInput input = _Controllers[i] ? _Controllers[i]->GetInput(_Vehicles[i], delta) : VehicleInput();
+		_SteerInput[i] = input.Steer;
+		_ThrottleInput[i] = input.Throttle;
+		_BrakeInput[i] = input.Brake;
+		_Speed[i] = _Vehicles[i]->GetCurrentSpeedKmHour();
+	}
+
+	//drive logic for every vehicle, only touches the arrays.
+	for (int i = 0; i < count; i++) {
+		if (_SteerInput[i] != 0.0f) {
+			_Steering[i] += _SteeringIncrement[i] * _SteerInput[i];
+			_Steering[i] = std::max(-_MaxSteering[i], std::min(_Steering[i], _MaxSteering[i]));
+		}
+		else {
+			_Steering[i] = 0.0f;
+		}
+
+		if (_ThrottleInput[i] > 0.0f && _BrakeInput[i] <= 0.0f) {
+			if (_Speed[i] < _MaxSpeed[i]) {
+				_EngineForce[i] += _AccelerationRate[i] * _ThrottleInput[i];
+			}
+			_EngineForce[i] = std::min(_EngineForce[i], _MaxEngineForce[i]);
+			_BrakeForce[i] = 0.0f;
+			_Reversing[i] = 0;
+		}
+		else if (_BrakeInput[i] <= 0.0f) {
+			//coasting, a little brake so the car rolls to a stop.
+			_EngineForce[i] = 0.0f;
+			_BrakeForce[i] = 1.0f;
+			_Reversing[i] = 0;
+		}
+		else {
+			//holding brake until stopped then reversing.
+			if (_Speed[i] <= 1.0f && !_Reversing[i]) {
+				_Reversing[i] = 1;
+			}
+			if (!_Reversing[i]) {
+				_BrakeForce[i] = _MaxBrakeForce[i] * _BrakeInput[i];
+				_EngineForce[i] = 0.0f;
+			}
+			else {
+				_BrakeForce[i] = 0.0f;
+				if (_Speed[i] < _MaxSpeed[i]) {
+					_EngineForce[i] -= _AccelerationRate[i] * _BrakeInput[i];
+				}
+				_EngineForce[i] = std::max(_EngineForce[i], -_MaxReverseEngineForce[i]);
+			}
+		}
+	}
+
+	//hand the result to bullet.
+	for (int i = 0; i < count; i++) {
+		_Vehicles[i]->ApplyControls(_Steering[i], _EngineForce[i], _BrakeForce[i]);
+	}
+}
+
+void VehicleSystem::RemoveAt(int index)
+{
+	delete _Controllers[index];
+
+	//swap with the last vehicle so the arrays stay packed.
+	int last = (int)_Vehicles.size() - 1;
+	_Vehicles[index] = _Vehicles[last];
+	_Controllers[index] = _Controllers[last];
+	_SteerInput[index] = _SteerInput[last];
+	_ThrottleInput[index] = _ThrottleInput[last];
+	_BrakeInput[index] = _BrakeInput[last];
+	_SteeringIncrement[index] = _SteeringIncrement[last];
+	_MaxSteering[index] = _MaxSteering[last];
+	_AccelerationRate[index] = _AccelerationRate[last];
+	_MaxEngineForce[index] = _MaxEngineForce[last];
+	_MaxReverseEngineForce[index] = _MaxReverseEngineForce[last];
+	_MaxSpeed[index] = _MaxSpeed[last];
+	_MaxBrakeForce[index] = _MaxBrakeForce[last];
+	_Speed[index] = _Speed[last];
+	_Steering[index] = _Steering[last];
+	_EngineForce[index] = _EngineForce[last];
+	_BrakeForce[index] = _BrakeForce[last];
+	_Reversing[index] = _Reversing[last];
+
+	_Vehicles.pop_back();
+	_Controllers.pop_back();
+	_SteerInput.pop_back();
+	_ThrottleInput.pop_back();
+	_BrakeInput.pop_back();
+	_SteeringIncrement.pop_back();
+	_MaxSteering.pop_back();
+	_AccelerationRate.pop_back();
+	_MaxEngineForce.pop_back();
+	_MaxReverseEngineForce.pop_back();
+	_MaxSpeed.pop_back();
+	_MaxBrakeForce.pop_back();
+	_Speed.pop_back();
+	_Steering.pop_back();
+	_EngineForce.pop_back();
+	_BrakeForce.pop_back();
+	_Reversing.pop_back();
+}
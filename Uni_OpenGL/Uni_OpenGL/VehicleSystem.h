@@ -0,0 +1,78 @@
+#pragma once
+
+#include "VehicleController.h"
+
+#include <vector>
+
+class BVehicle;
+
+//per vehicle handling, copied into the systems arrays when the vehicle is added.
+struct VehicleTuning {
+	float SteeringIncrement = 0.03f;
+	float MaxSteering = 0.3f;
+	float AccelerationRate = 200.0f;
+	float MaxEngineForce = 3000.0f;
+	float MaxReverseEngineForce = 1500.0f;
+	float MaxSpeed = 180.0f;
+	float MaxBrakeForce = 100.0f;
+};
+
+////////////////////////////////////////////////////////////
+/// Drives every vehicle in the level.
+/// --Inputs, tuning and drive state are kept in parallel
+/// --arrays, index i is the same vehicle in all of them,
+/// --so the drive logic is one tight loop over all vehicles.
+////////////////////////////////////////////////////////////
+class VehicleSystem
+{
+public:
+	VehicleSystem();
+	~VehicleSystem();
+
+	////////////////////////////////////////////////////////////
+	/// Adds a vehicle, the system takes ownership of the
+	/// --controller but not the vehicle.
+	////////////////////////////////////////////////////////////
+	int AddVehicle(BVehicle* vehicle, VehicleController* controller, const VehicleTuning& tuning = VehicleTuning());
+	void RemoveVehicle(BVehicle* vehicle);
+	void Clear();
+
+	void SetController(int index, VehicleController* controller);
+
+	////////////////////////////////////////////////////////////
+	/// Reads every controller, updates the drive state and
+	/// --hands the result to the bullet vehicles.
+	////////////////////////////////////////////////////////////
+	void Update(float delta);
+
+	int GetVehicleCount() { return (int)_Vehicles.size(); }
+	BVehicle* GetVehicle(int index) { return _Vehicles[index]; }
+	VehicleController* GetController(int index) { return _Controllers[index]; }
+
+private:
+	std::vector<BVehicle*> _Vehicles;
+	std::vector<VehicleController*> _Controllers;
+
+	//control inputs, written by the controllers.
+	std::vector<float> _SteerInput;
+	std::vector<float> _ThrottleInput;
+	std::vector<float> _BrakeInput;
+
+	//tuning.
+	std::vector<float> _SteeringIncrement;
+	std::vector<float> _MaxSteering;
+	std::vector<float> _AccelerationRate;
+	std::vector<float> _MaxEngineForce;
+	std::vector<float> _MaxReverseEngineForce;
+	std::vector<float> _MaxSpeed;
+	std::vector<float> _MaxBrakeForce;
+
+	//drive state.
+	std::vector<float> _Speed;
+	std::vector<float> _Steering;
+	std::vector<float> _EngineForce;
+	std::vector<float> _BrakeForce;
+	std::vector<unsigned char> _Reversing;
+
+	void RemoveAt(int index);
+};
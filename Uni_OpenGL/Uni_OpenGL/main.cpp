@@ -1,10 +1,48 @@
 #include <SDL\SDL.h>
 #include "Engine.h"
+#include "LogManager.h"
+
+#include <cstdlib>
+#include <string>
 
 int main(int argc, char** argv) {
 
     Engine* _Engine = new Engine();
 
+    //--record <file>, --replay <file>, --fixed <seconds>, --benchmark, --trace <file>, --stats <file>, --watch-shaders
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            _Engine->SetRecordFile(argv[++i]);
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            _Engine->SetReplayFile(argv[++i]);
+        }
+        else if (arg == "--fixed" && i + 1 < argc) {
+            const char* value = argv[++i];
+            char* end = nullptr;
+            float step = std::strtof(value, &end);
+            if (end == value || *end != '\0' || !(step > 0.0f)) {
+                LogManager::Instance()->LogError(std::string("--fixed needs a time step in seconds above zero, ignoring ") + value);
+            }
+            else {
+                _Engine->SetFixedTimeStep(step);
+            }
+        }
+        else if (arg == "--benchmark") {
+            _Engine->SetBenchmark(true);
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            _Engine->SetTraceFile(argv[++i]);
+        }
+        else if (arg == "--stats" && i + 1 < argc) {
+            _Engine->SetStatsFile(argv[++i]);
+        }
+        else if (arg == "--watch-shaders") {
+            _Engine->SetWatchShaders(true);
+        }
+    }
+
     if (!_Engine->Initialize(1920, 1080, "Finite State Machine!!!")) {
         return 0;
     }